@@ -25,8 +25,6 @@ typedef struct VSOutput
 } VSOutput;
 
 // Library context, you should always define *and initialize* (see later) this!
-SRPContext srpContext;
-
 // Message callback: this is called for every error or warning
 // Is not necessary
 void messageCallback(
@@ -41,7 +39,7 @@ void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 int main()
 {
 	// Initializing the context
-	srpNewContext(&srpContext);
+	SRPContext* ctx = srpNewContext();
 	srpSetMessageCallback((SRPMessageCallback) {
 		.func = messageCallback,
 		.userParameter = NULL
@@ -108,7 +106,7 @@ int main()
 		TIME_SECTION(renderTime, {
 			// Clear the framebuffer and draw the index buffer as triangles
 			srpFramebufferClear(fb);
-			srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+			srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
 		});
 
 		windowPollEvents(window);
@@ -127,6 +125,7 @@ int main()
 	// Destroy objects
 	srpFreeVertexBuffer(vb);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 	freeWindow(window);
 
 	return 0;
@@ -26,8 +26,6 @@ typedef struct Uniform
 	mat4 rotation;
 } Uniform;
 
-SRPContext srpContext;
-
 void messageCallback(
 	SRPMessageType type, SRPMessageSeverity severity, const char* sourceFunction,
 	const char* message, void* userParameter
@@ -37,7 +35,7 @@ void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
 int main()
 {
-	srpNewContext(&srpContext);
+	SRPContext* ctx = srpNewContext();
 	srpSetMessageCallback((SRPMessageCallback) {
 		.func = messageCallback,
 		.userParameter = NULL
@@ -97,7 +95,7 @@ int main()
 			// top of this file (`SRP_INCLUDE_...`)
 			uniform.rotation = mat4ConstructRotate(0, 0, uniform.frameCount / 1000.);
 			srpFramebufferClear(fb);
-			srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+			srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
 		});
 
 		windowPollEvents(window);
@@ -115,6 +113,7 @@ int main()
 
 	srpFreeVertexBuffer(vb);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 	freeWindow(window);
 
 	return 0;
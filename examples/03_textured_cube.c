@@ -26,8 +26,6 @@ typedef struct Uniform
 	SRPTexture* texture;
 } Uniform;
 
-SRPContext srpContext;
-
 void messageCallback(
 	SRPMessageType type, SRPMessageSeverity severity, const char* sourceFunction,
 	const char* message, void* userParameter
@@ -37,16 +35,16 @@ void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
 int main()
 {
-	srpNewContext(&srpContext);
+	SRPContext* ctx = srpNewContext();
 	srpSetMessageCallback((SRPMessageCallback) {
 		.func = messageCallback,
 		.userParameter = NULL
 	});
 
 	// Enable back-face culling and set counter-clockwise faces as front-facing
-	srpRasterFrontFace(SRP_WINDING_CCW);
-	srpRasterCullFace(SRP_FACE_BACK);
-	srpDepthTest(true);
+	srpRasterFrontFace(ctx, SRP_WINDING_CCW);
+	srpRasterCullFace(ctx, SRP_FACE_BACK);
+	srpDepthTest(ctx, true);
 
 	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 
@@ -143,7 +141,7 @@ int main()
 			);
 
 			srpFramebufferClear(fb);
-			srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
+			srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
 		});
 
 		windowPollEvents(window);
@@ -163,6 +161,7 @@ int main()
 	srpFreeVertexBuffer(vb);
 	srpFreeIndexBuffer(ib);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 	freeWindow(window);
 
 	return 0;
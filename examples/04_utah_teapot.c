@@ -41,8 +41,6 @@ typedef struct Uniform
 	vec3 viewPos;
 } Uniform;
 
-SRPContext srpContext;
-
 void messageCallback(
 	SRPMessageType type, SRPMessageSeverity severity, const char* sourceFunction,
 	const char* message, void* userParameter
@@ -52,16 +50,16 @@ void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
 int main()
 {
-	srpNewContext(&srpContext);
+	SRPContext* ctx = srpNewContext();
 	srpSetMessageCallback((SRPMessageCallback) {
 		.func = messageCallback,
 		.userParameter = NULL
 	});
 
-	srpRasterFrontFace(SRP_WINDING_CW);
-	srpRasterCullFace(SRP_FACE_BACK);
-	srpRasterPolygonMode(SRP_POLYGON_MODE_FILL);
-	srpDepthTest(true);
+	srpRasterFrontFace(ctx, SRP_WINDING_CW);
+	srpRasterCullFace(ctx, SRP_FACE_BACK);
+	srpRasterPolygonMode(ctx, SRP_POLYGON_MODE_FILL);
+	srpDepthTest(ctx, true);
 
 	OBJMesh mesh;
 	if (!loadOBJMesh("res/objects/utah_teapot.obj", &mesh))
@@ -140,7 +138,7 @@ int main()
 				RAD(-90), uniform.frameCount / 200., 0
 			);
 			srpFramebufferClear(fb);
-			srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
+			srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
 		});
 
 		windowPollEvents(window);
@@ -159,6 +157,7 @@ int main()
 	srpFreeVertexBuffer(vb);
 	srpFreeIndexBuffer(ib);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 	freeOBJMesh(&mesh);
 	freeWindow(window);
 
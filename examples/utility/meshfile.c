@@ -0,0 +1,243 @@
+#if defined(__unix__) || defined(__APPLE__)
+	#define _POSIX_C_SOURCE 200809L
+	#define MESH_FILE_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "meshfile.h"
+
+static_assert(sizeof(OBJVertex) == 8 * sizeof(float), "OBJVertex must be tightly packed");
+static_assert(sizeof(MeshCluster) == 32, "MeshCluster must be tightly packed");
+static_assert(sizeof(MeshFileHeader) == 88, "MeshFileHeader must be tightly packed");
+
+// Offsets of the sections are multiples of this
+#define MESH_FILE_ALIGNMENT 16
+
+// Merge identical vertices of a mesh, keeping the order of first use
+// Returns the unique vertices; `outIndices` gets `mesh->indexCount` indices into them
+static OBJVertex* deduplicateVertices(const OBJMesh* mesh, uint32_t* outIndices, size_t* outCount);
+// Grow `bounds` to contain `position`
+static void boundsAdd(MeshBounds* bounds, vec3 position);
+static inline uint64_t alignOffset(uint64_t offset);
+// Whether `count` elements of `size` bytes at `offset` fit in a file of `fileSize` bytes
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t size, size_t fileSize);
+
+bool writeMeshFile(const char* path, const OBJMesh* mesh)
+{
+	uint32_t* indices = malloc(sizeof(uint32_t) * (mesh->indexCount + 1));
+	size_t vertexCount;
+	OBJVertex* vertices = deduplicateVertices(mesh, indices, &vertexCount);
+
+	const size_t clusterIndices = MESH_CLUSTER_TRIANGLES * 3;
+	const size_t clusterCount = (mesh->indexCount + clusterIndices - 1) / clusterIndices;
+	MeshCluster* clusters = malloc(sizeof(MeshCluster) * (clusterCount + 1));
+	const MeshBounds empty = {
+		.min = VEC3(INFINITY, INFINITY, INFINITY),
+		.max = VEC3(-INFINITY, -INFINITY, -INFINITY)
+	};
+	MeshFileHeader header = {
+		.magic = MESH_FILE_MAGIC,
+		.version = MESH_FILE_VERSION,
+		.vertexSize = sizeof(OBJVertex),
+		.indexSize = (vertexCount <= 65536) ? 2 : 4,
+		.vertexCount = vertexCount,
+		.indexCount = mesh->indexCount,
+		.clusterCount = clusterCount,
+		.bounds = empty
+	};
+	header.clusterOffset = alignOffset(sizeof(MeshFileHeader));
+	header.vertexOffset = alignOffset(header.clusterOffset + sizeof(MeshCluster) * clusterCount);
+	header.indexOffset = alignOffset(header.vertexOffset + sizeof(OBJVertex) * vertexCount);
+
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		MeshCluster* cluster = &clusters[c];
+		cluster->firstIndex = c * clusterIndices;
+		cluster->indexCount = (c + 1 < clusterCount) ? clusterIndices : mesh->indexCount - c * clusterIndices;
+		cluster->bounds = empty;
+		for (size_t i = cluster->firstIndex; i < cluster->firstIndex + cluster->indexCount; i++)
+			boundsAdd(&cluster->bounds, vertices[indices[i]].position);
+		boundsAdd(&header.bounds, cluster->bounds.min);
+		boundsAdd(&header.bounds, cluster->bounds.max);
+	}
+
+	// Narrowed in place, front to back
+	if (header.indexSize == 2)
+	{
+		uint16_t* narrow = (uint16_t*) indices;
+		for (size_t i = 0; i < mesh->indexCount; i++)
+			narrow[i] = indices[i];
+	}
+
+	FILE* file = fopen(path, "wb");
+	bool ok = file != NULL;
+	if (ok)
+	{
+		// Seeking past the end pads the sections with zeros
+		ok &= fwrite(&header, sizeof(header), 1, file) == 1;
+		ok &= fseek(file, header.clusterOffset, SEEK_SET) == 0;
+		ok &= fwrite(clusters, sizeof(MeshCluster), clusterCount, file) == clusterCount;
+		ok &= fseek(file, header.vertexOffset, SEEK_SET) == 0;
+		ok &= fwrite(vertices, sizeof(OBJVertex), vertexCount, file) == vertexCount;
+		ok &= fseek(file, header.indexOffset, SEEK_SET) == 0;
+		ok &= fwrite(indices, header.indexSize, mesh->indexCount, file) == mesh->indexCount;
+		ok &= fclose(file) == 0;
+	}
+
+	free(indices);
+	free(vertices);
+	free(clusters);
+	return ok;
+}
+
+bool openMeshFile(const char* path, MeshFile* file)
+{
+	*file = (MeshFile) {0};
+
+#ifdef MESH_FILE_MMAP
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(MeshFileHeader))
+	{
+		close(fd);
+		return false;
+	}
+	// Pages are read on first access, and shared with the page cache
+	void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return false;
+	file->mapping = mapping;
+	file->size = st.st_size;
+#else
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+		return false;
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	file->mapping = (size >= (long) sizeof(MeshFileHeader)) ? malloc(size) : NULL;
+	file->size = size;
+	const bool read = file->mapping != NULL && fread(file->mapping, 1, size, f) == (size_t) size;
+	fclose(f);
+	if (!read)
+	{
+		free(file->mapping);
+		return false;
+	}
+#endif
+
+	const MeshFileHeader* header = file->header = file->mapping;
+	const bool valid = \
+		memcmp(header->magic, MESH_FILE_MAGIC, 4) == 0 &&
+		header->version == MESH_FILE_VERSION &&
+		header->vertexSize == sizeof(OBJVertex) &&
+		(header->indexSize == 2 || header->indexSize == 4) &&
+		sectionFits(header->clusterOffset, header->clusterCount, sizeof(MeshCluster), file->size) &&
+		sectionFits(header->vertexOffset, header->vertexCount, sizeof(OBJVertex), file->size) &&
+		sectionFits(header->indexOffset, header->indexCount, header->indexSize, file->size);
+	if (!valid)
+	{
+		fprintf(stderr, "%s is not a valid mesh file\n", path);
+		closeMeshFile(file);
+		return false;
+	}
+
+	const char* base = file->mapping;
+	file->clusters = (const MeshCluster*) (base + header->clusterOffset);
+	file->vertices = (const OBJVertex*) (base + header->vertexOffset);
+	file->indices = base + header->indexOffset;
+	return true;
+}
+
+void closeMeshFile(MeshFile* file)
+{
+	assert(file != NULL);
+#ifdef MESH_FILE_MMAP
+	if (file->mapping != NULL)
+		munmap(file->mapping, file->size);
+#else
+	free(file->mapping);
+#endif
+	*file = (MeshFile) {0};
+}
+
+void meshFileWrapBuffers(const MeshFile* file, SRPVertexBuffer* vb, SRPIndexBuffer* ib)
+{
+	const MeshFileHeader* header = file->header;
+	srpVertexBufferWrapData(vb, sizeof(OBJVertex), sizeof(OBJVertex) * header->vertexCount, file->vertices);
+	srpIndexBufferWrapData(
+		ib, (header->indexSize == 2) ? SRP_UINT16 : SRP_UINT32,
+		header->indexSize * header->indexCount, file->indices
+	);
+}
+
+static OBJVertex* deduplicateVertices(const OBJMesh* mesh, uint32_t* outIndices, size_t* outCount)
+{
+	// Open addressing, at most half full. Slots hold unique vertex index + 1
+	size_t capacity = 16;
+	while (capacity < mesh->indexCount * 2)
+		capacity *= 2;
+	uint32_t* slots = calloc(capacity, sizeof(uint32_t));
+	OBJVertex* unique = malloc(sizeof(OBJVertex) * (mesh->indexCount + 1));
+	size_t count = 0;
+
+	for (size_t i = 0; i < mesh->indexCount; i++)
+	{
+		const OBJVertex* v = &mesh->vertices[mesh->indices[i]];
+
+		// FNV-1a over the bytes, so that -0 and 0 are different vertices
+		// just as memcmp() sees them
+		uint64_t hash = 0xCBF29CE484222325;
+		const uint8_t* bytes = (const uint8_t*) v;
+		for (size_t b = 0; b < sizeof(OBJVertex); b++)
+			hash = (hash ^ bytes[b]) * 0x100000001B3;
+
+		size_t slot = hash & (capacity - 1);
+		while (slots[slot] != 0 && memcmp(&unique[slots[slot] - 1], v, sizeof(OBJVertex)) != 0)
+			slot = (slot + 1) & (capacity - 1);
+		if (slots[slot] == 0)
+		{
+			unique[count] = *v;
+			slots[slot] = ++count;
+		}
+		outIndices[i] = slots[slot] - 1;
+	}
+
+	free(slots);
+	*outCount = count;
+	return unique;
+}
+
+static void boundsAdd(MeshBounds* bounds, vec3 position)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		bounds->min.v[i] = fminf(bounds->min.v[i], position.v[i]);
+		bounds->max.v[i] = fmaxf(bounds->max.v[i], position.v[i]);
+	}
+}
+
+static inline uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t size, size_t fileSize)
+{
+	// Empty sections at the end of the file are not padded
+	if (count == 0)
+		return true;
+	return offset % MESH_FILE_ALIGNMENT == 0 && offset <= fileSize && \
+		count <= (fileSize - offset) / size;
+}
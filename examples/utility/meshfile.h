@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <srp/vec.h>
+#include <srp/buffer.h>
+#include "objparser.h"
+
+// A binary mesh file holds everything a draw needs, laid out so that the file
+// can be memory-mapped and handed to SRPVertexBuffer and SRPIndexBuffer as is,
+// without parsing or copying. Little-endian, every section 16-byte aligned:
+//   MeshFileHeader
+//   MeshCluster clusters[clusterCount]
+//   OBJVertex vertices[vertexCount]   (position, uv, normal: 8 floats)
+//   uint16_t or uint32_t indices[indexCount], triangle list
+// Vertices are unique, in the order the triangles first use them
+
+#define MESH_FILE_MAGIC "SRPM"
+#define MESH_FILE_VERSION 1
+// Triangles of a cluster, the unit of bounding boxes finer than the mesh's
+#define MESH_CLUSTER_TRIANGLES 256
+
+typedef struct MeshBounds {
+	vec3 min;
+	vec3 max;
+} MeshBounds;
+
+// A run of consecutive triangles, e.g. to cull parts of the mesh
+typedef struct MeshCluster {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	MeshBounds bounds;
+} MeshCluster;
+
+typedef struct MeshFileHeader {
+	char magic[4];           // MESH_FILE_MAGIC
+	uint32_t version;        // MESH_FILE_VERSION
+	uint32_t vertexSize;     // sizeof(OBJVertex)
+	uint32_t indexSize;      // 2 if there are at most 65536 vertices, else 4
+	uint64_t vertexCount;
+	uint64_t indexCount;
+	uint64_t clusterCount;
+	uint64_t clusterOffset;  // Offsets of the sections from the start of the file
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	MeshBounds bounds;       // Bounding box of all the vertices
+} MeshFileHeader;
+
+// A mapped mesh file. The pointers are into the mapping, so they are valid
+// until closeMeshFile()
+typedef struct MeshFile {
+	const MeshFileHeader* header;
+	const MeshCluster* clusters;
+	const OBJVertex* vertices;
+	const void* indices;
+	void* mapping;
+	size_t size;
+} MeshFile;
+
+// Convert a mesh, merging its identical vertices, and write it to a file
+bool writeMeshFile(const char* path, const OBJMesh* mesh);
+// Map a mesh file into memory and validate its header. The index values are
+// not checked, not to touch every page of the file
+bool openMeshFile(const char* path, MeshFile* file);
+void closeMeshFile(MeshFile* file);
+// Make the buffers use the mapped vertices and indices, without copying them.
+// The file must stay open while they are used
+void meshFileWrapBuffers(const MeshFile* file, SRPVertexBuffer* vb, SRPIndexBuffer* ib);
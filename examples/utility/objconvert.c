@@ -0,0 +1,42 @@
+// Convert a Wavefront OBJ file to a binary mesh file (see meshfile.h)
+// Usage: objconvert input.obj output.srpm
+
+#include <stdio.h>
+#include "objparser.h"
+#include "meshfile.h"
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s input.obj output.srpm\n", argv[0]);
+		return 1;
+	}
+
+	OBJMesh mesh;
+	if (!loadOBJMesh(argv[1], &mesh))
+	{
+		fprintf(stderr, "Failed to load %s\n", argv[1]);
+		return 1;
+	}
+	if (!writeMeshFile(argv[2], &mesh))
+	{
+		fprintf(stderr, "Failed to write %s\n", argv[2]);
+		freeOBJMesh(&mesh);
+		return 1;
+	}
+
+	MeshFile file;
+	if (openMeshFile(argv[2], &file))
+	{
+		printf(
+			"%zu corners -> %llu vertices, %llu indices, %llu clusters\n",
+			mesh.indexCount, (unsigned long long) file.header->vertexCount,
+			(unsigned long long) file.header->indexCount,
+			(unsigned long long) file.header->clusterCount
+		);
+		closeMeshFile(&file);
+	}
+	freeOBJMesh(&mesh);
+	return 0;
+}
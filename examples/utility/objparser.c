@@ -5,78 +5,96 @@
 #include <assert.h>
 #include "objparser.h"
 
+// Growable array of `size`-byte elements
+typedef struct Array {
+    void* data;
+    size_t count;
+    size_t capacity;
+    size_t size;
+} Array;
+
+// Append an element, growing the array geometrically
+static void* arrayPush(Array* array);
+// Read the whole file into a NUL-terminated buffer
+static char* readFile(const char* path, size_t* outSize);
+// Parse `count` floats, leaving missing ones zero
+static const char* parseFloats(const char* p, float* out, int count);
+// Parse one `v`, `v/t`, `v//n` or `v/t/n` face corner. Indices are resolved
+// against the amounts of elements read so far (negative ones are relative)
+// and are -1 if absent. Returns NULL if there is no corner at `p`
+static const char* parseCorner(
+    const char* p, const size_t counts[3], long out[3]
+);
+
 bool loadOBJMesh(const char* path, OBJMesh* mesh)
 {
-    FILE* file = fopen(path, "r");
-    if (!file) return false;
-
-    // Temporary storage for positions, uvs, normals
-    vec3* tempPositions = malloc(sizeof(vec3) * 65536);
-    vec2* tempUVs       = malloc(sizeof(vec2) * 65536);
-    vec3* tempNormals   = malloc(sizeof(vec3) * 65536);
-    size_t posCount = 0, uvCount = 0, normalCount = 0;
-
-    // Allocate mesh arrays (will realloc if needed)
-    mesh->vertices = malloc(sizeof(OBJVertex) * 65536);
-    mesh->indices  = malloc(sizeof(uint32_t) * 65536);
-    mesh->vertexCount = 0;
-    mesh->indexCount  = 0;
-
-    char line[256];
-    while (fgets(line, sizeof(line), file))
+    size_t size;
+    char* text = readFile(path, &size);
+    if (!text) return false;
+
+    Array positions = {.size = sizeof(vec3)};
+    Array uvs       = {.size = sizeof(vec2)};
+    Array normals   = {.size = sizeof(vec3)};
+    Array vertices  = {.size = sizeof(OBJVertex)};
+
+    // Every line is parsed in place, without copying it
+    for (const char* line = text; line < text + size; )
     {
-        if (line[0] == 'v' && line[1] == ' ' && posCount < 65536)  // Vertex position
-        {
-            float x, y, z;
-            sscanf(line, "v %f %f %f", &x, &y, &z);
-            tempPositions[posCount] = VEC3(x, y, z);
-            posCount++;
-        }
-        else if (line[0] == 'v' && line[1] == 't' && uvCount < 65536)  // Texture coord
-        {
-            float u, v;
-            sscanf(line, "vt %f %f", &u, &v);
-            tempUVs[uvCount] = VEC2(u, v);
-            uvCount++;
-        }
-        else if (line[0] == 'v' && line[1] == 'n' && normalCount < 65536) // Normals
-        {
-            float nx, ny, nz;
-            sscanf(line, "vn %f %f %f", &nx, &ny, &nz);
-            tempNormals[normalCount] = VEC3(nx, ny, nz);
-            normalCount++;
-        }
-        else if (line[0] == 'f')  // Face
+        const char* end = strchr(line, '\n');
+        if (!end) end = text + size;
+
+        if (line[0] == 'v' && line[1] == ' ')  // Vertex position
+            parseFloats(line + 2, ((vec3*) arrayPush(&positions))->v, 3);
+        else if (line[0] == 'v' && line[1] == 't')  // Texture coord
+            parseFloats(line + 2, ((vec2*) arrayPush(&uvs))->v, 2);
+        else if (line[0] == 'v' && line[1] == 'n')  // Normals
+            parseFloats(line + 2, ((vec3*) arrayPush(&normals))->v, 3);
+        else if (line[0] == 'f' && line[1] == ' ')  // Face, triangulated as a fan
         {
-            int vi[3], ti[3], ni[3];  // Vertex, texture, normal indices
-            int scanned = sscanf(
-                line, "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                &vi[0], &ti[0], &ni[0],
-                &vi[1], &ti[1], &ni[1],
-                &vi[2], &ti[2], &ni[2]
-            );
-            if (scanned == 9)
-                for (int i = 0; i < 3; i++)
+            const size_t counts[3] = {positions.count, uvs.count, normals.count};
+            OBJVertex corners[3];
+            long index[3];
+            size_t n = 0;
+            bool valid = true;
+            for (const char* p = line + 2; (p = parseCorner(p, counts, index)) && p <= end; n++)
+            {
+                if (index[0] < 0)
+                {
+                    valid = false;
+                    break;
+                }
+                OBJVertex v = {0};
+                v.position = ((vec3*) positions.data)[index[0]];
+                if (index[1] >= 0) v.uv     = ((vec2*) uvs.data)[index[1]];
+                if (index[2] >= 0) v.normal = ((vec3*) normals.data)[index[2]];
+
+                // Corners past the third one close a triangle with the
+                // first and the previous ones
+                corners[(n < 2) ? n : 2] = v;
+                if (n >= 2)
                 {
-                    OBJVertex v;
-                    v.position = tempPositions[vi[i] - 1];
-                    v.uv       = tempUVs[ti[i] - 1];
-                    v.normal   = tempNormals[ni[i] - 1];
-
-                    mesh->vertices[mesh->vertexCount] = v;
-                    mesh->indices[mesh->indexCount]   = mesh->vertexCount;
-                    mesh->vertexCount++;
-                    mesh->indexCount++;
+                    for (int i = 0; i < 3; i++)
+                        *(OBJVertex*) arrayPush(&vertices) = corners[i];
+                    corners[1] = corners[2];
                 }
-            else
-                fprintf(stderr, "Unsupported face format: %s\n", line);
+            }
+            if (!valid || n < 3)
+                fprintf(stderr, "Unsupported face format: %.*s\n", (int) (end - line), line);
         }
+        line = end + 1;
     }
 
-    free(tempPositions);
-    free(tempUVs);
-    free(tempNormals);
-    fclose(file);
+    mesh->vertices = vertices.data;
+    mesh->vertexCount = vertices.count;
+    mesh->indexCount = vertices.count;
+    mesh->indices = malloc(sizeof(uint32_t) * (vertices.count + 1));
+    for (size_t i = 0; i < vertices.count; i++)
+        mesh->indices[i] = i;
+
+    free(positions.data);
+    free(uvs.data);
+    free(normals.data);
+    free(text);
 
     return true;
 }
@@ -87,3 +105,86 @@ void freeOBJMesh(OBJMesh* mesh)
     free(mesh->vertices);
     free(mesh->indices);
 }
+
+static void* arrayPush(Array* array)
+{
+    if (array->count == array->capacity)
+    {
+        array->capacity = (array->capacity) ? array->capacity * 2 : 1024;
+        array->data = realloc(array->data, array->size * array->capacity);
+    }
+    return (char*) array->data + array->size * array->count++;
+}
+
+static char* readFile(const char* path, size_t* outSize)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (size >= 0) ? malloc(size + 1) : NULL;
+    if (text && fread(text, 1, size, file) != (size_t) size)
+    {
+        free(text);
+        text = NULL;
+    }
+    fclose(file);
+
+    if (text)
+    {
+        text[size] = '\0';
+        *outSize = size;
+    }
+    return text;
+}
+
+static const char* parseFloats(const char* p, float* out, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        char* end;
+        out[i] = strtof(p, &end);
+        if (end == p)  // Missing or not a number
+        {
+            for (; i < count; i++)
+                out[i] = 0;
+            break;
+        }
+        p = end;
+    }
+    return p;
+}
+
+static const char* parseCorner(
+    const char* p, const size_t counts[3], long out[3]
+)
+{
+    while (*p == ' ' || *p == '\t') p++;
+
+    out[0] = out[1] = out[2] = -1;
+    for (int i = 0; i < 3; i++)
+    {
+        char* end;
+        const long value = strtol(p, &end, 10);
+        if (end != p)
+        {
+            // 1-based, or relative to the end if negative
+            const long index = (value < 0) ? (long) counts[i] + value : value - 1;
+            out[i] = (index >= 0 && (size_t) index < counts[i]) ? index : -2;
+            p = end;
+        }
+        else if (i == 0)
+            return NULL;
+
+        if (*p != '/')
+            break;
+        p++;
+    }
+
+    // Any element that is present must be valid
+    for (int i = 1; i < 3; i++)
+        if (out[i] == -2) out[0] = -1;
+    return p;
+}
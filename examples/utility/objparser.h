@@ -2,6 +2,7 @@
 
 #include <srp/vec.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 typedef struct OBJVertex {
     vec3 position;
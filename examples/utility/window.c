@@ -1,6 +1,10 @@
+#include <stdio.h>
 #include <srp/color.h>
 #include "window.h"
 
+// SDL pixel format laid out as the color format, or SDL_PIXELFORMAT_UNKNOWN
+static Uint32 sdlPixelFormat(SRPColorFormat format);
+
 Window* newWindow(size_t width, size_t height, char* title, bool fullscreen)
 {
 	Window* this = malloc(sizeof(Window));
@@ -10,10 +14,8 @@ Window* newWindow(size_t width, size_t height, char* title, bool fullscreen)
 		width, height, fullscreen ? SDL_WINDOW_FULLSCREEN : 0
 	);
 	this->renderer = SDL_CreateRenderer(this->window, -1, 0);
-	this->texture = SDL_CreateTexture(
-		this->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
-		width, height
-	);
+	this->texture = NULL;
+	this->textureFormat = SDL_PIXELFORMAT_UNKNOWN;
 
 	this->running = true;
 	
@@ -24,7 +26,8 @@ void freeWindow(Window* this)
 {
 	SDL_DestroyWindow(this->window);
 	SDL_DestroyRenderer(this->renderer);
-	SDL_DestroyTexture(this->texture);
+	if (this->texture != NULL)
+		SDL_DestroyTexture(this->texture);
 	free(this);
 }
 
@@ -46,9 +49,57 @@ void windowPollEvents(Window* this)
 	}
 }
 
-void windowPresent(const Window* this, const SRPFramebuffer* fb)
+void windowPresent(Window* this, const SRPFramebuffer* fb)
+{
+	windowPresentRect(this, fb, &(SRPRect) {0, 0, fb->width, fb->height});
+}
+
+void windowPresentRect(Window* this, const SRPFramebuffer* fb, const SRPRect* rect)
 {
-	SDL_UpdateTexture(this->texture, NULL, fb->color, fb->width * sizeof(SRPColor));
+	// Upload the color buffer as is, in a texture of the same format
+	const Uint32 format = sdlPixelFormat(fb->colorFormat);
+	const SRPRect whole = {0, 0, fb->width, fb->height};
+	if (format == SDL_PIXELFORMAT_UNKNOWN)
+	{
+		fprintf(stderr, "Cannot present color format %i\n", fb->colorFormat);
+		return;
+	}
+	if (this->texture == NULL || this->textureFormat != format)
+	{
+		if (this->texture != NULL)
+			SDL_DestroyTexture(this->texture);
+		this->texture = SDL_CreateTexture(
+			this->renderer, format, SDL_TEXTUREACCESS_STREAMING,
+			fb->width, fb->height
+		);
+		this->textureFormat = format;
+		rect = &whole;  // Nothing to keep yet
+	}
+
+	const size_t pixelSize = srpColorFormatSize(fb->colorFormat);
+	if (rect->x0 < rect->x1 && rect->y0 < rect->y1)
+	{
+		const SDL_Rect area = {rect->x0, rect->y0, rect->x1 - rect->x0, rect->y1 - rect->y0};
+		const char* pixels = (const char*) fb->color + (rect->y0 * fb->width + rect->x0) * pixelSize;
+		SDL_UpdateTexture(this->texture, &area, pixels, fb->width * pixelSize);
+	}
 	SDL_RenderCopy(this->renderer, this->texture, NULL, NULL);
 	SDL_RenderPresent(this->renderer);
 }
+
+static Uint32 sdlPixelFormat(SRPColorFormat format)
+{
+	switch (format)
+	{
+		case SRP_COLOR_FORMAT_RGBA8:
+		case SRP_COLOR_FORMAT_SRGBA8:  // Displays expect sRGB-encoded bytes anyway
+			return SDL_PIXELFORMAT_RGBA8888;
+		case SRP_COLOR_FORMAT_BGRA8:
+		case SRP_COLOR_FORMAT_SBGRA8:
+			return SDL_PIXELFORMAT_BGRA32;
+		case SRP_COLOR_FORMAT_RGB565:
+			return SDL_PIXELFORMAT_RGB565;
+		default:  // No half float formats in SDL2
+			return SDL_PIXELFORMAT_UNKNOWN;
+	}
+}
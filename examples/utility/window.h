@@ -8,7 +8,8 @@ typedef struct
 {
 	SDL_Window* window;
 	SDL_Renderer* renderer;
-	SDL_Texture* texture;
+	SDL_Texture* texture;     // Created by windowPresent() to match the framebuffer
+	Uint32 textureFormat;
 	
 	bool running;
 } Window;
@@ -17,5 +18,8 @@ Window* newWindow(size_t width, size_t height, char* title, bool fullscreen);
 void freeWindow(Window* this);
 
 void windowPollEvents(Window* this);
-void windowPresent(const Window* this, const SRPFramebuffer* fb);
+void windowPresent(Window* this, const SRPFramebuffer* fb);
+// Upload only a rectangle of the color buffer (e.g. srpFramebufferDamage()),
+// keeping the rest of what was presented before
+void windowPresentRect(Window* this, const SRPFramebuffer* fb, const SRPRect* rect);
 
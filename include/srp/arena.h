@@ -1,16 +0,0 @@
-// Software Rendering Pipeline (SRP) library
-// Licensed under GNU GPLv3
-
-/** @file
- *  @ingroup Memory_allocation
- *  Opaque definition of SRPArena structure */
-
-#pragma once
-
-/** @ingroup Memory_allocation
- *  @{ */
-
-/** Opaque definition of SRPArena structure */
-typedef struct SRPArena SRPArena;
-
-/** @} */  // ingroup Memory_allocation
@@ -9,6 +9,7 @@
 
 #include "srp/framebuffer.h"
 #include "srp/shaders.h"
+#include "srp/context.h"
 
 /** @ingroup Buffer
  *  @{ */
@@ -49,16 +50,29 @@ void srpFreeVertexBuffer(SRPVertexBuffer* this);
 void srpVertexBufferCopyData
 	(SRPVertexBuffer* this, size_t nBytesPerVertex, size_t nBytesData, const void* data);
 
+/** Make the vertex buffer use existing vertex data without copying it, e.g.
+ *  a memory-mapped file. The data is neither modified nor freed by the
+ *  buffer, and must stay valid until the buffer is freed or given other data,
+ *  and until the draw calls using it complete (see srpFinish())
+ *  @param[in] this The pointer to vertex buffer
+ *  @param[in] nBytesPerVertex The size of one vertex, in bytes
+ *  @param[in] nBytesData The size of vertex data, in bytes
+ *  @param[in] data The pointer to vertex data */
+void srpVertexBufferWrapData
+	(SRPVertexBuffer* this, size_t nBytesPerVertex, size_t nBytesData, const void* data);
+
 /** Draw vertices from vertex buffer
- *  @param[in] this The pointer to vertex buffer to read the vertex data from
+ *  @param[in] ctx The context to draw with
+ *  @param[in] vb The pointer to vertex buffer to read the vertex data from
  *  @param[in] fb The framebuffer to draw to
- *  @param[in] sp The shader program to use
+ *  @param[in] sp The shader program to use. May be NULL if the bound pipeline
+ *             has one (see srpBindPipeline()), otherwise overrides it
  *  @param[in] primitive Specifies the primitive to draw
  *  @param[in] startIndex Specifies from what index to start drawing
  *  @param[in] count Specifies how many vertices to draw */
 void srpDrawVertexBuffer(
-	const SRPVertexBuffer* this, const SRPFramebuffer* fb, const SRPShaderProgram* sp,
-	SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
 );
 
 /** Construct the index buffer
@@ -74,21 +88,71 @@ SRPIndexBuffer* srpNewIndexBuffer();
 void srpIndexBufferCopyData
 	(SRPIndexBuffer* this, SRPType indicesType, size_t nBytesData, const void* data);
 
+/** Make the index buffer use existing indices without copying them, as
+ *  srpVertexBufferWrapData() does
+ *  @param[in] this The pointer to index buffer
+ *  @param[in] indicesType The type of indices passed by data.
+ *             Must be one of SRP_UINT8, SRP_UINT16, SRP_UINT32, SRP_UINT64
+ *  @param[in] nBytesData The size of index data
+ *  @param[in] data The pointer to an array of indices of type indicesType */
+void srpIndexBufferWrapData
+	(SRPIndexBuffer* this, SRPType indicesType, size_t nBytesData, const void* data);
+
 /** Free the index buffer
  *  @param[in] this The pointer to index buffer, as returned from srpNewIndexBuffer() */
 void srpFreeIndexBuffer(SRPIndexBuffer* this);
 
 /** Draw vertices using both vertex and index buffers
- *  @param[in] this The index buffer to read the indices from
+ *  @param[in] ctx The context to draw with
+ *  @param[in] ib The index buffer to read the indices from
  *  @param[in] vb The vertex buffer to read the vertex data from
  *  @param[in] fb The framebuffer to draw to
- *  @param[in] sp The shader program to use
+ *  @param[in] sp The shader program to use. May be NULL if the bound pipeline
+ *             has one (see srpBindPipeline()), otherwise overrides it
  *  @param[in] primitive Specifies the primitive to draw
  *  @param[in] startIndex Specifies from what index buffer's index to start drawing
  *  @param[in] count Specifies how many indices to draw */
 void srpDrawIndexBuffer(
-	const SRPIndexBuffer* this, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPShaderProgram* sp, SRPPrimitive primitive,
+	size_t startIndex, size_t count
+);
+
+/** A point of a point cloud drawn with srpDrawPointCloud(). Vertices of the
+ *  vertex buffer must start with it, anything after it is ignored */
+typedef struct SRPCloudPoint
+{
+	float position[3];  /**< Position of the point, transformed by the draw call */
+	uint32_t color;     /**< Color packed as 0xRRGGBBAA, converted to the
+	                         framebuffer's SRPColorFormat when written */
+} SRPCloudPoint;
+
+/** Draw a point cloud, bypassing the shaders. Every point covers the one
+ *  pixel it falls into and writes its color. The result does not depend
+ *  on the order of the points: the point nearest to the viewer wins, ties are
+ *  broken by color (the smallest packed value wins). Drawing is multithreaded
+ *  if the context has threads.
+ *  "Nearest" follows the depth state of the bound pipeline. Its compare
+ *  operation must be one of SRP_COMPARE_LESS, SRP_COMPARE_LEQUAL (the smallest
+ *  depth wins), SRP_COMPARE_GREATER or SRP_COMPARE_GEQUAL (the largest one
+ *  wins). If the depth test is enabled, the framebuffer's content competes with
+ *  the points as one more point, regardless of the compare operation being
+ *  strict, so splitting a cloud between calls does not change the result; if
+ *  the depth write is enabled, the winners' depth is written. Points outside
+ *  of the scissor box are dropped; stencil test and blending are not applied.
+ *  Only color attachment 0 is written, the others are left untouched.
+ *  The cost of a draw call is proportional to the amount of points plus the
+ *  amount of pixels, so a cloud should be drawn with as few calls as possible
+ *  @param[in] ctx The context to draw with
+ *  @param[in] vb The vertex buffer holding SRPCloudPoint-s
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] transform Row-major matrix transforming the points to clip space,
+ *                       e.g. `data` of a `mat4`
+ *  @param[in] startIndex Specifies from what index to start drawing
+ *  @param[in] count Specifies how many points to draw */
+void srpDrawPointCloud(
+	SRPContext* ctx, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	const float transform[4][4], size_t startIndex, size_t count
 );
 
 /** @} */  // ingroup Buffer
@@ -7,15 +7,41 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 /** @ingroup Framebuffer
  *  @{ */
 
+/** Format of a framebuffer's color buffer
+ *  @see srpNewFramebufferFormat() */
+typedef enum SRPColorFormat
+{
+	SRP_COLOR_FORMAT_RGBA8,   /**< 32-bit words, 0xRRGGBBAA (the default) */
+	SRP_COLOR_FORMAT_BGRA8,   /**< Bytes B, G, R, A in memory (0xAARRGGBB words
+	                               on little-endian hosts), the layout most
+	                               displays and video encoders take */
+	SRP_COLOR_FORMAT_RGB565,  /**< 16-bit words, 5 bits of red on top, then 6
+	                               of green and 5 of blue. Alpha is dropped */
+	SRP_COLOR_FORMAT_RGBA16F, /**< Half floats R, G, B, A in memory. Not
+	                               clamped, so it can hold HDR colors */
+	SRP_COLOR_FORMAT_SRGBA8,  /**< As SRP_COLOR_FORMAT_RGBA8, but the color
+	                               (not alpha) is sRGB-encoded when stored and
+	                               decoded when blended, so shaders work in
+	                               linear space */
+	SRP_COLOR_FORMAT_SBGRA8   /**< As SRP_COLOR_FORMAT_BGRA8, sRGB-encoded as
+	                               SRP_COLOR_FORMAT_SRGBA8 */
+} SRPColorFormat;
+
 /** Holds RGBA8888 color data */
 typedef struct SRPColor
 {
 	uint8_t r, g, b, a;
 } SRPColor;
 
+/** Get the size of one pixel of a color format
+ *  @param[in] format The color format
+ *  @return Size in bytes, or 0 if the format is invalid */
+size_t srpColorFormatSize(SRPColorFormat format);
+
 /** @} */  // ingroup Framebuffer
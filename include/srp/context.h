@@ -11,7 +11,6 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "srp/message_callback.h"
-#include "srp/arena.h"
 
 /** @ingroup Context
  *  @{ */
@@ -84,6 +83,11 @@ typedef struct SRPRasterState
 	SRPFace cullFace;            /**< Which face(s) should be culled */
 	SRPPolygonMode polygonMode;  /**< Polygon rendering mode */
 	float pointSize;             /**< Size of rasterized point, in pixels */
+	float lineWidth;             /**< Width of rasterized lines, in pixels */
+	bool lineSmooth;             /**< Whether lines are antialiased, blending
+	                                  their fragments by pixel coverage */
+	bool dedupEdges;             /**< Whether edges shared by triangles of a draw
+	                                  call are drawn once in SRP_POLYGON_MODE_LINE */
 } SRPRasterState;
 
 /** Scissor test state */
@@ -123,74 +127,97 @@ typedef struct SRPDepthState
 } SRPDepthState;
 
 
-/** Holds runtime settings. This always needs to be declared as `SRPContext
- *  srpContext` in user programs and initialized with srpNewContext() */
-typedef struct SRPContext
-{
-	/** Message callback that is called whenever an error/warning/etc. occurs */
-	SRPMessageCallback messageCallback;
-
-	/** Which vertex is considered to be the provoking vertex */
-	SRPProvokingVertexMode provokingVertexMode;
-
-	SRPRasterState raster;    /**< Rasterizer state */
-	SRPScissorState scissor;  /**< Scissor test state */
-    SRPStencilState stencil;  /**< Stencil test state */
-	SRPDepthState depth;      /**< Depth test state */
-
-	/** Arena for internal allocations. Is not exposed to the user */
-	SRPArena* arena;  
-} SRPContext;
-
-
-/** Initialize the context
- *  @param[in] pContext The pointer to the context */
-void srpNewContext(SRPContext* pContext);
-
-/** Set message callback function */
-void srpSetMessageCallback(SRPMessageCallback callback);
+/** Holds runtime settings and internal resources. Contexts are fully
+ *  independent from each other, so multiple of them may coexist and be used
+ *  concurrently on different threads (one context must not be used by
+ *  multiple threads at once) @see srpNewContext() */
+typedef struct SRPContext SRPContext;
+
+
+/** Create a context with default state
+ *  @return A pointer to the created context */
+SRPContext* srpNewContext();
+
+/** Free a context
+ *  @param[in] this The pointer to context, as returned from srpNewContext() */
+void srpFreeContext(SRPContext* this);
+
+/** Enable or disable asynchronous draw submission. When enabled, draw calls
+ *  only validate their arguments and enqueue the work onto a background render
+ *  thread, returning immediately. The draw calls are executed in submission
+ *  order with the context state at the moment of submission. The buffers and
+ *  the framebuffer must stay valid and unchanged until the work is complete
+ *  (see srpNewFence() and srpFinish()), as well as the uniform, unless
+ *  SRPShaderProgram.uniformSize is set. Disabled by default. Disabling blocks
+ *  until all the submitted work is complete */
+void srpAsyncDraw(SRPContext* this, bool enable);
+/** Block until all the draw calls submitted to the context are complete */
+void srpFinish(SRPContext* this);
+
+/** Set the amount of threads the work of the context is split across,
+ *  including the one executing the draw calls. 1 (default) means that
+ *  everything runs on that thread, 0 means one thread per CPU core.
+ *  With more than one thread, filled triangles are rasterized in screen
+ *  tiles distributed across the threads; the result is identical */
+void srpThreadCount(SRPContext* this, size_t count);
+/** Pin the worker threads of the context to NUMA nodes, splitting them into
+ *  contiguous groups, one per node. Combined with framebuffers placed with
+ *  SRP_NUMA_PLACEMENT_PARTITION, tiles are preferably rasterized by threads
+ *  of the node holding their memory. Only supported on Linux, disabled by
+ *  default. Changing it blocks until all the submitted work is complete */
+void srpThreadPinning(SRPContext* this, bool enable);
 
 /** Set the provoking vertex convention */
-void srpProvokingVertexMode(SRPProvokingVertexMode mode);
+void srpProvokingVertexMode(SRPContext* this, SRPProvokingVertexMode mode);
 
 /** Set the face(s) to cull */
-void srpRasterCullFace(SRPFace face);
+void srpRasterCullFace(SRPContext* this, SRPFace face);
 /** Set the winding order considered the front face */
-void srpRasterFrontFace(SRPWinding face);
+void srpRasterFrontFace(SRPContext* this, SRPWinding face);
 /** Set polygon rasterization mode */
-void srpRasterPolygonMode(SRPPolygonMode mode);
+void srpRasterPolygonMode(SRPContext* this, SRPPolygonMode mode);
 /** Set point size */
-void srpRasterPointSize(float size);
+void srpRasterPointSize(SRPContext* this, float size);
+/** Set line width. Aliased lines are rounded to a whole amount of pixels */
+void srpRasterLineWidth(SRPContext* this, float width);
+/** Enable or disable line antialiasing. Fragments of antialiased lines are
+ *  blended over the framebuffer by their coverage of the pixel */
+void srpRasterLineSmooth(SRPContext* this, bool enable);
+/** Enable or disable drawing the edges shared by triangles only once in
+ *  SRP_POLYGON_MODE_LINE. Edges are identified by vertex indices, so meshes
+ *  have to be indexed (or share vertices otherwise) to benefit. Skipped
+ *  edges do not take a primitive ID */
+void srpRasterDedupEdges(SRPContext* this, bool enable);
 
 /** Enable or disable the scissor test */
-void srpScissorTest(bool enable);
+void srpScissorTest(SRPContext* this, bool enable);
 /** Set the options for the scissor test */
-void srpScissorOptions(size_t x, size_t y, size_t width, size_t height);
+void srpScissorOptions(SRPContext* this, size_t x, size_t y, size_t width, size_t height);
 
 /** Enable or disable the stencil test */
-void srpStencilTest(bool enable);
+void srpStencilTest(SRPContext* this, bool enable);
 /** Set the stencil comparison function options */
-void srpStencilFunc(SRPCompareOp func, uint8_t ref, uint8_t mask);
+void srpStencilFunc(SRPContext* this, SRPCompareOp func, uint8_t ref, uint8_t mask);
 /** Set the stencil comparison function options for a specific face type */
-void srpStencilFuncSeparate(SRPFace face, SRPCompareOp func, uint8_t ref, uint8_t mask);
+void srpStencilFuncSeparate(
+	SRPContext* this, SRPFace face, SRPCompareOp func, uint8_t ref, uint8_t mask
+);
 /** Set the stencil update operation options */
-void srpStencilOp(SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass);
+void srpStencilOp(SRPContext* this, SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass);
 /** Set the stencil update operation options for a specific face type */
-void srpStencilOpSeparate(SRPFace face, SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass);
+void srpStencilOpSeparate(
+	SRPContext* this, SRPFace face, SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass
+);
 /** Set the write mask on stencil operations */
-void srpStencilWriteMask(uint8_t mask);
+void srpStencilWriteMask(SRPContext* this, uint8_t mask);
 /** Set the write mask on stencil operations for a specific face type */
-void srpStencilWriteMaskSeparate(SRPFace face, uint8_t mask);
+void srpStencilWriteMaskSeparate(SRPContext* this, SRPFace face, uint8_t mask);
 
 /** Enable or disable the depth test */
-void srpDepthTest(bool enable);
+void srpDepthTest(SRPContext* this, bool enable);
 /** Enable or disable the depth writing */
-void srpDepthWrite(bool enable);
+void srpDepthWrite(SRPContext* this, bool enable);
 /** Set the compare operation used in the depth test */
-void srpDepthCompareOp(SRPCompareOp op);
-
-
-/** Global context declaration */
-extern SRPContext srpContext;
+void srpDepthCompareOp(SRPContext* this, SRPCompareOp op);
 
 /** @} */  // ingroup Context
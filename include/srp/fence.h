@@ -0,0 +1,39 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context
+ *  SRPFence and related functions */
+
+#pragma once
+
+#include <stdbool.h>
+#include "srp/context.h"
+
+/** @ingroup Context
+ *  @{ */
+
+/** Synchronization object that gets signaled once all the draw calls
+ *  submitted to a context before it are complete @see srpAsyncDraw() */
+typedef struct SRPFence SRPFence;
+
+/** Create a fence in the context's command stream. If asynchronous draw
+ *  submission is disabled, the fence is created already signaled
+ *  @param[in] ctx The context to create the fence in
+ *  @return A pointer to the created fence */
+SRPFence* srpNewFence(SRPContext* ctx);
+
+/** Free a fence, waiting for it to be signaled first
+ *  @param[in] this The pointer to fence, as returned from srpNewFence() */
+void srpFreeFence(SRPFence* this);
+
+/** Block until the fence is signaled
+ *  @param[in] this The pointer to fence, as returned from srpNewFence() */
+void srpFenceWait(SRPFence* this);
+
+/** Check if the fence is signaled without blocking
+ *  @param[in] this The pointer to fence, as returned from srpNewFence()
+ *  @return `true` if all the work submitted before the fence is complete */
+bool srpFenceIsSignaled(SRPFence* this);
+
+/** @} */  // ingroup Context
@@ -9,33 +9,293 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include "srp/context.h"
+#include "srp/color.h"
 
 /** @ingroup Framebuffer
  *  @{ */
 
-/** Holds RBGA8888 color buffer and depth buffer */
+/** Placement of the memory of a framebuffer across NUMA nodes
+ *  @see srpFramebufferNumaPlacement() */
+typedef enum SRPNumaPlacement
+{
+	SRP_NUMA_PLACEMENT_DEFAULT,     /**< Left to the operating system */
+	SRP_NUMA_PLACEMENT_INTERLEAVE,  /**< Pages spread round-robin across all the nodes */
+	SRP_NUMA_PLACEMENT_PARTITION    /**< Contiguous horizontal bands of tile rows,
+	                                     one band per node */
+} SRPNumaPlacement;
+
+/** Maximum amount of color buffers of a framebuffer
+ *  @see srpNewFramebufferAttachments() */
+#define SRP_MAX_COLOR_ATTACHMENTS 4
+
+/** A rectangle of pixels `[x0, x1) x [y0, y1)`, empty if `x0 >= x1` or
+ *  `y0 >= y1` */
+typedef struct SRPRect
+{
+	size_t x0, y0;  /**< Top left corner, inclusive */
+	size_t x1, y1;  /**< Bottom right corner, exclusive */
+} SRPRect;
+
+/** Holds color buffers, depth buffer and stencil buffer */
 typedef struct SRPFramebuffer
 {
 	size_t width;      /**< Width */
 	size_t height;     /**< Height */
 	size_t size;       /**< Total amount of pixels (width * height) */
-	uint32_t* color;   /**< Pointer to the color buffer */
+	void* color;       /**< Pointer to the color buffer (attachment 0), row by row */
+	SRPColorFormat colorFormat;  /**< Format of the pixels of `color` */
+	size_t nColorAttachments;    /**< Amount of color buffers, `color` included */
+	/** Color attachments 1 and above, laid out as `color`. The first
+	 *  `nColorAttachments - 1` are valid */
+	void* extraColor[SRP_MAX_COLOR_ATTACHMENTS - 1];
+	/** Formats of the pixels of `extraColor` */
+	SRPColorFormat extraColorFormat[SRP_MAX_COLOR_ATTACHMENTS - 1];
 	float* depth;      /**< Pointer to the depth buffer */
 	uint8_t* stencil;  /**< Pointer to the stencil buffer */
+	SRPNumaPlacement numaPlacement;  /**< Set by srpFramebufferNumaPlacement() */
+	/** Private, see srpFramebufferDamage() */
+	struct SRPFramebufferDamage* damage;
 } SRPFramebuffer;
 
-/** Create a framebuffer
+/** Create a framebuffer with SRP_COLOR_FORMAT_RGBA8 color buffer
  *  @param[in] width Width of a new framebuffer in pixels
  *  @param[in] height Height of a new framebuffer in pixels
  *  @return A pointer to the created framebuffer */
 SRPFramebuffer* srpNewFramebuffer(size_t width, size_t height);
 
+/** Create a framebuffer with the given color format. Shaders write colors
+ *  the same way regardless of it, the conversion is done when storing them,
+ *  so the buffer may be handed to a display or an encoder as is
+ *  @param[in] width Width of a new framebuffer in pixels
+ *  @param[in] height Height of a new framebuffer in pixels
+ *  @param[in] format Format of the color buffer
+ *  @return A pointer to the created framebuffer, or NULL if the format is invalid */
+SRPFramebuffer* srpNewFramebufferFormat(size_t width, size_t height, SRPColorFormat format);
+
+/** Create a framebuffer with several color buffers (multiple render targets),
+ *  e.g. the G-buffer of a deferred renderer. A fragment shader writes
+ *  SRPFragmentShaderOut.color to attachment 0 and
+ *  SRPFragmentShaderOut.extraColors to the others; everything else (depth,
+ *  stencil, scissor tests) is shared between them
+ *  @param[in] width Width of a new framebuffer in pixels
+ *  @param[in] height Height of a new framebuffer in pixels
+ *  @param[in] nAttachments Amount of color buffers, in
+ *                          [1, SRP_MAX_COLOR_ATTACHMENTS]
+ *  @param[in] formats Array of `nAttachments` formats, one per color buffer
+ *  @return A pointer to the created framebuffer, or NULL if the arguments
+ *          are invalid */
+SRPFramebuffer* srpNewFramebufferAttachments(
+	size_t width, size_t height, size_t nAttachments, const SRPColorFormat* formats
+);
+
 /** Free a framebuffer
  *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer() */
 void srpFreeFramebuffer(SRPFramebuffer* this);
 
-/** Clear a framebuffer: fill the color with black and depth with -1
+/** Clear a framebuffer: fill all the color buffers with black and depth with -1
  *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer() */
 void srpFramebufferClear(const SRPFramebuffer* this);
 
+/** Clear a rectangle of a framebuffer, as srpFramebufferClear() does
+ *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer()
+ *  @param[in] rect The rectangle to clear, clamped to the framebuffer */
+void srpFramebufferClearRect(const SRPFramebuffer* this, const SRPRect* rect);
+
+/** Get the damage of a framebuffer: the bounding box of the pixels that may
+ *  have been drawn to since it was created or srpFramebufferResetDamage() was
+ *  last called. Every rasterized primitive adds its bounding box (clamped to
+ *  the framebuffer and, for triangles, to the scissor box); full-screen passes
+ *  and composites add the whole framebuffer. Clears are not damage, as the
+ *  caller knows what it clears. Draw calls submitted asynchronously count
+ *  once they complete (see srpFinish()).
+ *
+ *  Frames that change a small region are then cheaper to update: reset the
+ *  damage, clear the previous frame's damage with srpFramebufferClearRect(),
+ *  draw, and present or export (see SRPExportOptions.rect) only the union of
+ *  the previous and the new damage (see srpRectUnion())
+ *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer()
+ *  @return The damaged rectangle, empty (all zeros) if nothing was drawn */
+SRPRect srpFramebufferDamage(const SRPFramebuffer* this);
+
+/** Forget the damage of a framebuffer, see srpFramebufferDamage()
+ *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer() */
+void srpFramebufferResetDamage(SRPFramebuffer* this);
+
+/** Get the bounding box of two rectangles, ignoring empty ones
+ *  @param[in] a,b The rectangles
+ *  @return The smallest rectangle containing both, all zeros if both are empty */
+SRPRect srpRectUnion(SRPRect a, SRPRect b);
+
+/** Read a pixel of the color buffer, whatever its format is
+ *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer()
+ *  @param[in] x,y Coordinates of the pixel
+ *  @param[out] color The color. Alpha is 1 for formats without it */
+void srpFramebufferReadPixel(const SRPFramebuffer* this, size_t x, size_t y, float color[4]);
+
+/** Read a pixel of one of the color buffers, whatever its format is
+ *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer()
+ *  @param[in] attachment Index of the color buffer, less than `nColorAttachments`
+ *  @param[in] x,y Coordinates of the pixel
+ *  @param[out] color The color. Alpha is 1 for formats without it */
+void srpFramebufferReadAttachmentPixel(
+	const SRPFramebuffer* this, size_t attachment, size_t x, size_t y, float color[4]
+);
+
+/** Place the buffers of a framebuffer on NUMA nodes, migrating their pages.
+ *  Meant for big framebuffers rasterized on many threads of a multi-socket
+ *  machine, where memory bandwidth is the bottleneck. With
+ *  SRP_NUMA_PLACEMENT_PARTITION and srpThreadPinning() enabled, tiles are
+ *  preferably rasterized by threads of the node holding them.
+ *  SRP_NUMA_PLACEMENT_DEFAULT does not move the pages back. Only supported on
+ *  Linux; a warning is sent if the pages could not be placed
+ *  @param[in] this The pointer to SRPFramebuffer, as returned from srpNewFramebuffer()
+ *  @param[in] placement The placement to use */
+void srpFramebufferNumaPlacement(SRPFramebuffer* this, SRPNumaPlacement placement);
+
+/** Depth-composite framebuffers into one (sort-last parallel rendering).
+ *  Every pixel of `dst` is replaced by the pixel of a source whose depth passes
+ *  the context's depth compare operation (see srpDepthCompareOp()) against
+ *  the depth stored in `dst`, regardless of whether the depth test is enabled.
+ *  The sources are merged in order. Color and depth are merged, stencil is
+ *  left untouched. Framebuffers with several color buffers are not supported.
+ *  Uses the context's threads (see srpThreadCount()) and waits for the draw
+ *  calls submitted to the context to complete first. All of `dst` counts as
+ *  damaged (see srpFramebufferDamage())
+ *  @param[in] ctx The context to take the compare operation and threads from
+ *  @param[in] dst The framebuffer to composite into. Its contents take part in
+ *                 the merge, so it may be one of the rendered framebuffers
+ *  @param[in] sources Array of `nSources` framebuffers of the same size and
+ *                     color format as `dst`.
+ *                     May contain `dst`, which is then skipped
+ *  @param[in] nSources Amount of source framebuffers */
+void srpFramebufferComposite(
+	SRPContext* ctx, const SRPFramebuffer* dst,
+	const SRPFramebuffer* const* sources, size_t nSources
+);
+
+/** A rectangle of a framebuffer handed to a SRPTileKernel. Pixel
+ *  `(x0 + i, y0 + j)` of color attachment `a` is at
+ *  `(char*) color[a] + (j * stride + i) * srpColorFormatSize(format of a)`,
+ *  depth and stencil are indexed by `j * stride + i` */
+typedef struct SRPFramebufferTile
+{
+	size_t x0, y0;      /**< Top-left pixel of the tile */
+	size_t x1, y1;      /**< Pixel after the bottom-right one, exclusive */
+	size_t stride;      /**< Distance between rows, in pixels */
+	/** Pointers to pixel `(x0, y0)` of every color attachment, NULL for the
+	 *  ones the framebuffer does not have */
+	void* color[SRP_MAX_COLOR_ATTACHMENTS];
+	float* depth;       /**< Pointer to the depth of pixel `(x0, y0)` */
+	uint8_t* stencil;   /**< Pointer to the stencil value of pixel `(x0, y0)` */
+} SRPFramebufferTile;
+
+/** A pixel of a framebuffer handed to a SRPPixelKernel */
+typedef struct SRPFramebufferPixel
+{
+	size_t x, y;        /**< Coordinates of the pixel */
+	/** Pointers to the pixel in every color attachment, NULL for the ones
+	 *  the framebuffer does not have */
+	void* color[SRP_MAX_COLOR_ATTACHMENTS];
+	float* depth;       /**< Pointer to the depth of the pixel */
+	uint8_t* stencil;   /**< Pointer to the stencil value of the pixel */
+} SRPFramebufferPixel;
+
+/** Function processing a tile of a framebuffer
+ *  @see srpFramebufferDispatchTiles() */
+typedef void (*SRPTileKernel)(const SRPFramebufferTile* tile, void* userData);
+
+/** Function processing a pixel of a framebuffer
+ *  @see srpFramebufferDispatchPixels() */
+typedef void (*SRPPixelKernel)(const SRPFramebufferPixel* pixel, void* userData);
+
+/** Run a kernel over every tile of a framebuffer, bypassing the rasterization
+ *  pipeline: no primitive setup, interpolation or per-fragment tests. Meant
+ *  for full-screen passes (lighting, tonemapping, blur) that would otherwise
+ *  draw a full-screen quad. Tiles are processed concurrently on the context's
+ *  threads (see srpThreadCount()), so a kernel must only write to its own
+ *  tile, and must not read pixels of other tiles of `fb` (read another
+ *  framebuffer instead, e.g. for a blur). Waits for the draw calls submitted
+ *  to the context to complete first, and returns once every tile is done.
+ *  All of `fb` counts as damaged (see srpFramebufferDamage())
+ *  @param[in] ctx The context to take the threads from
+ *  @param[in] fb The framebuffer to process
+ *  @param[in] kernel The function to call for every tile
+ *  @param[in] userData User pointer passed to `kernel` */
+void srpFramebufferDispatchTiles(
+	SRPContext* ctx, const SRPFramebuffer* fb, SRPTileKernel kernel, void* userData
+);
+
+/** Run a kernel over every pixel of a framebuffer. Same as
+ *  srpFramebufferDispatchTiles(), but the pixels of a tile are walked by the
+ *  library, calling `kernel` for each of them
+ *  @param[in] ctx The context to take the threads from
+ *  @param[in] fb The framebuffer to process
+ *  @param[in] kernel The function to call for every pixel
+ *  @param[in] userData User pointer passed to `kernel` */
+void srpFramebufferDispatchPixels(
+	SRPContext* ctx, const SRPFramebuffer* fb, SRPPixelKernel kernel, void* userData
+);
+
+/** Image file formats a framebuffer can be exported to */
+typedef enum SRPImageFormat
+{
+	SRP_IMAGE_FORMAT_RAW,  /**< The color buffer as is, row by row, no header */
+	SRP_IMAGE_FORMAT_PPM,  /**< Binary PPM (P6), 8-bit RGB */
+	SRP_IMAGE_FORMAT_QOI,  /**< QOI, 8-bit RGB or RGBA */
+	SRP_IMAGE_FORMAT_PNG   /**< PNG, 8-bit RGB or RGBA */
+} SRPImageFormat;
+
+/** How to export a framebuffer
+ *  @see srpFramebufferExport() */
+typedef struct SRPExportOptions
+{
+	SRPImageFormat format;    /**< Format of the image */
+	size_t attachment;        /**< Index of the color buffer to export */
+	/** Whether to keep the alpha channel (QOI and PNG only), otherwise the
+	 *  image is RGB */
+	bool alpha;
+	/** PNG only: 0 stores the pixels uncompressed (the fastest), 1 to 9 trade
+	 *  speed for smaller files */
+	int compressionLevel;
+	/** Region to export (e.g. the damage, see srpFramebufferDamage()),
+	 *  clamped to the framebuffer, or NULL to export all of it */
+	const SRPRect* rect;
+} SRPExportOptions;
+
+/** Encode a color buffer of a framebuffer to an image file format.
+ *  Color formats other than RGBA8 and BGRA8 (and their sRGB variants, whose
+ *  bytes are written as is) are rounded to 8 bits per component.
+ *  The image is encoded in bands of rows concurrently on the context's threads
+ *  (see srpThreadCount()); the result does not depend on the amount of
+ *  threads. Waits for the draw calls submitted to the context to complete first
+ *  @param[in] ctx The context to take the threads from
+ *  @param[in] fb The framebuffer to encode
+ *  @param[in] options How to encode it
+ *  @param[out] outSize Size of the encoded image, in bytes
+ *  @return The encoded image, to be freed with srpFreeEncodedImage(), or NULL
+ *          if the options are invalid */
+void* srpFramebufferEncode(
+	SRPContext* ctx, const SRPFramebuffer* fb, const SRPExportOptions* options,
+	size_t* outSize
+);
+
+/** Free an image returned from srpFramebufferEncode()
+ *  @param[in] data The encoded image */
+void srpFreeEncodedImage(void* data);
+
+/** Encode a color buffer of a framebuffer to an image file, as
+ *  srpFramebufferEncode() does
+ *  @param[in] ctx The context to take the threads from
+ *  @param[in] fb The framebuffer to export
+ *  @param[in] options How to encode it
+ *  @param[in] path Path of the file to write, overwritten if it exists
+ *  @return `true` on success, `false` if the options are invalid or the file
+ *          could not be written */
+bool srpFramebufferExport(
+	SRPContext* ctx, const SRPFramebuffer* fb, const SRPExportOptions* options,
+	const char* path
+);
+
 /** @} */  // ingroup Framebuffer
@@ -26,7 +26,7 @@ typedef enum SRPMessageSeverity
 } SRPMessageSeverity;
 
 /** A function of this type may be defined by user to handle the messages
- *  generated by the library (errors, warnings, etc.) @see `SRPContext`
+ *  generated by the library (errors, warnings, etc.) @see srpSetMessageCallback()
  * 	@param[in] type The type of the message
  *  @param[in] severity Severity of the message
  *  @param[in] sourceFunction String containing the name of the function which issued this callback
@@ -44,4 +44,8 @@ typedef struct SRPMessageCallback
 	void* userParameter;          /**< User pointer to pass to message callback function */
 } SRPMessageCallback;
 
+/** Set message callback function. It is shared by all contexts and may be
+ *  called concurrently if they are used from multiple threads */
+void srpSetMessageCallback(SRPMessageCallback callback);
+
 /** @} */  // ingroup Context
@@ -0,0 +1,56 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context
+ *  SRPPipeline and related functions */
+
+#pragma once
+
+#include "srp/context.h"
+#include "srp/shaders.h"
+
+/** @ingroup Context
+ *  @{ */
+
+/** Describes all the state baked into SRPPipeline. Has the same meaning as
+ *  the corresponding SRPContext setters
+ *  @see srpNewPipeline() */
+typedef struct SRPPipelineState
+{
+	/** The shader program to use. May be NULL, in which case the shader
+	 *  program must be passed to the draw call */
+	const SRPShaderProgram* shaderProgram;
+	/** Which vertex is considered to be the provoking vertex */
+	SRPProvokingVertexMode provokingVertexMode;
+
+	SRPRasterState raster;    /**< Rasterizer state */
+	SRPScissorState scissor;  /**< Scissor test state */
+	SRPStencilState stencil;  /**< Stencil test state */
+	SRPDepthState depth;      /**< Depth test state */
+} SRPPipelineState;
+
+/** Immutable, validated pipeline state object. Bundles a shader program with
+ *  the raster, scissor, stencil and depth state, so that switching between
+ *  them is a single pointer assignment @see srpBindPipeline() */
+typedef struct SRPPipeline SRPPipeline;
+
+/** Validate the state and construct a pipeline from it
+ *  @param[in] state The state to bake into the pipeline. Is copied, so it
+ *                   can be modified or freed after the call
+ *  @return A pointer to the constructed pipeline, or NULL if the state is invalid */
+SRPPipeline* srpNewPipeline(const SRPPipelineState* state);
+
+/** Free a pipeline
+ *  @param[in] this The pointer to pipeline, as returned from srpNewPipeline() */
+void srpFreePipeline(SRPPipeline* this);
+
+/** Bind a pipeline to a context. While a pipeline is bound, draw calls use
+ *  its state instead of the one set via SRPContext setters. Must stay valid
+ *  while bound. The same pipeline may be bound to multiple contexts
+ *  @param[in] ctx The context to bind the pipeline to
+ *  @param[in] pipeline The pipeline to bind, or NULL to go back to the state
+ *                      set via SRPContext setters */
+void srpBindPipeline(SRPContext* ctx, const SRPPipeline* pipeline);
+
+/** @} */  // ingroup Context
@@ -8,7 +8,9 @@
  *  Typedefs related to shaders */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "srp/vertex.h"
+#include "srp/framebuffer.h"
 
 /** @ingroup Shaders
  *  @{ */
@@ -37,6 +39,9 @@ typedef struct SRPVertexShaderOut
 		float ndcPosition[4];   /**< Position after perspective divide */
 	};
 	SRPVarying* varyings;   /**< Pointer to the buffer of vertex variables */
+	float pointSize;        /**< Size of the point, in pixels. Optional: if left
+	                             zero, SRPRasterState.pointSize is used. Only
+	                             affects the vertices drawn as points */
 } SRPVertexShaderOut;
 
 /** Represents the vertex shader
@@ -63,6 +68,10 @@ typedef struct SRPFragmentShaderIn
 	float fragCoord[4];         /**< Window space coordinates of the fragment */
 	bool frontFacing;           /**< Whether or not the current primitive is facing front */
 	size_t primitiveID;         /**< ID of the currently processing primitive */
+	float pointCoord[2];        /**< Position of the fragment inside the point
+	                                 being drawn, from (0, 0) in its upper left
+	                                 corner to (1, 1) in the lower right one.
+	                                 Zero for other primitives */
 } SRPFragmentShaderIn;
 
 /** Holds outputs from fragment shader
@@ -72,6 +81,13 @@ typedef struct SRPFragmentShaderOut
 	float color[4];   /**< Color to draw at this fragment */
 	float fragDepth;  /**< Set the depth value of the current fragment. May be written
 						   only if SRPFragmentShader.mayOverwriteDepth is `true` */
+	uint32_t packedColor;  /**< Color to draw at this fragment, packed as
+	                            0xRRGGBBAA. Written instead of `color` if
+	                            SRPFragmentShader.writesPackedColor is `true` */
+	/** Colors to draw to color attachments 1 and above: `extraColors[i]` goes
+	 *  to attachment `i + 1`. Only used if the framebuffer has them (see
+	 *  srpNewFramebufferAttachments()), zero if not written */
+	float extraColors[SRP_MAX_COLOR_ATTACHMENTS - 1][4];
 } SRPFragmentShaderOut;
 
 /** Represents the fragment shader
@@ -83,6 +99,10 @@ typedef struct SRPFragmentShader
 	/** Whether or not this shader may overwrite depth via SRPFragmentShaderOut.fragDepth
 	 *  If `false`, early depth test is activated (less fragment shader invocations) */
 	bool mayOverwriteDepth;
+	/** Whether this shader writes SRPFragmentShaderOut.packedColor instead of
+	 *  SRPFragmentShaderOut.color. Saves converting the color from floats for
+	 *  every fragment, which is enough for flat colors and UI */
+	bool writesPackedColor;
 } SRPFragmentShader;
 
 
@@ -94,6 +114,11 @@ typedef struct SRPShaderProgram
 	SRPUniform* uniform;    /** Pointer to the uniform to use */
 	SRPVertexShader* vs;    /** Pointer to the vertex shader to use */
 	SRPFragmentShader* fs;  /** Pointer to the fragment shader to use */
+	/** Size of the uniform in bytes. If nonzero, asynchronous draw calls
+	 *  (see srpAsyncDraw()) snapshot the uniform when submitted, so it may be
+	 *  modified as soon as the draw call returns. If zero, the uniform is read
+	 *  by pointer and must stay unchanged until the draw call is complete */
+	size_t uniformSize;
 } SRPShaderProgram;
 
 /** @} */  // ingroup Shaders
@@ -7,10 +7,13 @@
  *  The only header the end user needs to include */
 
 #include "srp/context.h"
+#include "srp/pipeline.h"
+#include "srp/fence.h"
 #include "srp/buffer.h"
 #include "srp/texture.h"
 #include "srp/color.h"
 #include "srp/framebuffer.h"
+#include "srp/swapchain.h"
 #include "srp/vertex.h"
 #include "srp/shaders.h"
 
@@ -0,0 +1,74 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Framebuffer
+ *  SRPSwapchain and related functions */
+
+#pragma once
+
+#include <stddef.h>
+#include "srp/context.h"
+#include "srp/framebuffer.h"
+
+/** @ingroup Framebuffer
+ *  @{ */
+
+/** Set of framebuffers rendered to and presented in turns, so that rendering
+ *  of a frame overlaps with presenting (uploading, encoding, ...) of the
+ *  previous ones. Presentation happens on a thread of the swap chain
+ *  @see srpNewSwapchain() */
+typedef struct SRPSwapchain SRPSwapchain;
+
+/** Function presenting a framebuffer, e.g. uploading it to a window or
+ *  encoding it to a file. Called on the swap chain's presentation thread,
+ *  one framebuffer at a time, in presentation order. The framebuffer is
+ *  given back to the swap chain once the function returns
+ *  @param[in] fb The framebuffer to present
+ *  @param[in] frame Index of the frame, counting presentations from 0
+ *  @param[in] userData User pointer passed to srpNewSwapchain() */
+typedef void (*SRPPresentFunc)(const SRPFramebuffer* fb, size_t frame, void* userData);
+
+/** Create a swap chain and start its presentation thread
+ *  @param[in] width Width of the framebuffers in pixels
+ *  @param[in] height Height of the framebuffers in pixels
+ *  @param[in] format Color format of the framebuffers
+ *  @param[in] nImages Amount of framebuffers, at least 2. With N of them,
+ *                     up to N - 1 frames may wait for presentation while one
+ *                     is rendered
+ *  @param[in] present The function presenting the framebuffers
+ *  @param[in] userData User pointer passed to `present`
+ *  @return A pointer to the created swap chain, or NULL if the arguments are
+ *          invalid */
+SRPSwapchain* srpNewSwapchain(
+	size_t width, size_t height, SRPColorFormat format, size_t nImages,
+	SRPPresentFunc present, void* userData
+);
+
+/** Present all the pending frames, then stop the presentation thread and
+ *  free the swap chain with its framebuffers
+ *  @param[in] this The pointer to the swap chain, as returned from srpNewSwapchain() */
+void srpFreeSwapchain(SRPSwapchain* this);
+
+/** Get a framebuffer to render the next frame to, blocking until one is done
+ *  being presented. Its contents are left from the frame it last held, so it
+ *  usually has to be cleared. Every acquired framebuffer must be presented
+ *  before it can be acquired again; acquiring all of them at once blocks forever
+ *  @param[in] this The pointer to the swap chain, as returned from srpNewSwapchain()
+ *  @return The framebuffer */
+SRPFramebuffer* srpSwapchainAcquire(SRPSwapchain* this);
+
+/** Queue an acquired framebuffer for presentation and return immediately.
+ *  The framebuffer is presented once the draw calls submitted to `ctx` so far
+ *  are complete, so rendering with srpAsyncDraw() enabled does not block here.
+ *  The framebuffer must not be used after this until it is acquired again
+ *  @param[in] this The pointer to the swap chain, as returned from srpNewSwapchain()
+ *  @param[in] ctx The context the frame was rendered with
+ *  @param[in] fb The framebuffer, as returned from srpSwapchainAcquire() */
+void srpSwapchainPresent(SRPSwapchain* this, SRPContext* ctx, SRPFramebuffer* fb);
+
+/** Block until all the queued frames are presented
+ *  @param[in] this The pointer to the swap chain, as returned from srpNewSwapchain() */
+void srpSwapchainWaitIdle(SRPSwapchain* this);
+
+/** @} */  // ingroup Framebuffer
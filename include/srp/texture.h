@@ -42,7 +42,9 @@ void srpFreeTexture(SRPTexture* this);
  *  @param[in] this A pointer to the texture, as returned by srpNewTexture()
  *  @param[in] u,v Coordinates of the requested texel
  *  @param[out] out An array of 4 values each in [0, 1] interval, representing
- *                  RGBA8888 color (0.0 = 0x0; 1.0 = 0xFF) */
+ *                  RGBA8888 color (0.0 = 0x0; 1.0 = 0xFF). If the texture is
+ *                  sRGB (see SRP_TEXTURE_SRGB), the color is decoded to
+ *                  linear space */
 void srpTextureGetFilteredColor(
 	const SRPTexture* this, float u, float v, float out[4]
 );
@@ -52,7 +54,9 @@ void srpTextureGetFilteredColor(
 typedef enum SRPTextureParameter
 {
 	SRP_TEXTURE_WRAPPING_MODE_X,
-	SRP_TEXTURE_WRAPPING_MODE_Y
+	SRP_TEXTURE_WRAPPING_MODE_Y,
+	SRP_TEXTURE_SRGB  /**< Whether the texels are sRGB-encoded, as most color
+	                       images are. `0` (the default) or `1` */
 } SRPTextureParameter;
 
  /** Get a parameter from existing SRPTexture
@@ -24,6 +24,7 @@ SRPVertexBuffer* srpNewVertexBuffer()
 	this->nVertices = 0;
 	this->nBytesAllocated = 0;
 	this->data = NULL;
+	this->ownsData = true;
 	return this;
 }
 
@@ -33,9 +34,11 @@ void srpVertexBufferCopyData
 	// Reallocate the buffer if there is not enough allocated space
 	if (nBytesData > this->nBytesAllocated)
 	{
-		SRP_FREE(this->data);
+		if (this->ownsData)
+			SRP_FREE(this->data);
 		this->data = SRP_MALLOC(nBytesData);
 		this->nBytesAllocated = nBytesData;
+		this->ownsData = true;
 	}
 
 	this->nBytesPerVertex = nBytesPerVertex;
@@ -44,18 +47,39 @@ void srpVertexBufferCopyData
 	memcpy(this->data, data, nBytesData);
 }
 
+void srpVertexBufferWrapData
+	(SRPVertexBuffer* this, size_t nBytesPerVertex, size_t nBytesData, const void* data)
+{
+	if (this->ownsData)
+		SRP_FREE(this->data);
+	this->data = (SRPVertex*) data;  // Never written to
+	this->nBytesAllocated = 0;
+	this->ownsData = false;
+	this->nBytesPerVertex = nBytesPerVertex;
+	this->nVertices = nBytesData / nBytesPerVertex;
+}
+
 void srpFreeVertexBuffer(SRPVertexBuffer* this)
 {
-	SRP_FREE(this->data);
+	if (this->ownsData)
+		SRP_FREE(this->data);
 	SRP_FREE(this);
 }
 
 void srpDrawVertexBuffer(
-	const SRPVertexBuffer* this, const SRPFramebuffer* fb, const SRPShaderProgram* sp,
-	SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+)
+{
+	drawBuffer(ctx, NULL, vb, fb, sp, primitive, startIndex, count);
+}
+
+void srpDrawPointCloud(
+	SRPContext* ctx, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	const float transform[4][4], size_t startIndex, size_t count
 )
 {
-	drawBuffer(NULL, this, fb, sp, primitive, startIndex, count);
+	drawPointCloud(ctx, vb, fb, transform, startIndex, count);
 }
 
 SRPVertex* indexVertexBuffer(const SRPVertexBuffer* this, size_t index)
@@ -71,6 +95,7 @@ SRPIndexBuffer* srpNewIndexBuffer()
 	this->nIndices = 0;
 	this->nBytesAllocated = 0;
 	this->data = NULL;
+	this->ownsData = true;
 	return this;
 }
 
@@ -81,9 +106,11 @@ void srpIndexBufferCopyData(
 	// Reallocate the buffer if there is not enough allocated space
 	if (nBytesData > this->nBytesAllocated)
 	{
-		SRP_FREE(this->data);
+		if (this->ownsData)
+			SRP_FREE(this->data);
 		this->data = SRP_MALLOC(nBytesData);
 		this->nBytesAllocated = nBytesData;
+		this->ownsData = true;
 	}
 
 	this->indicesType = indicesType;
@@ -93,9 +120,23 @@ void srpIndexBufferCopyData(
 	memcpy(this->data, data, nBytesData);
 }
 
+void srpIndexBufferWrapData
+	(SRPIndexBuffer* this, SRPType indicesType, size_t nBytesData, const void* data)
+{
+	if (this->ownsData)
+		SRP_FREE(this->data);
+	this->data = (void*) data;  // Never written to
+	this->nBytesAllocated = 0;
+	this->ownsData = false;
+	this->indicesType = indicesType;
+	this->nBytesPerIndex = srpSizeofType(indicesType);
+	this->nIndices = nBytesData / this->nBytesPerIndex;
+}
+
 void srpFreeIndexBuffer(SRPIndexBuffer* this)
 {
-	SRP_FREE(this->data);
+	if (this->ownsData)
+		SRP_FREE(this->data);
 	SRP_FREE(this);
 }
 
@@ -128,11 +169,12 @@ uint64_t indexIndexBuffer(const SRPIndexBuffer* this, size_t index)
 }
 
 void srpDrawIndexBuffer(
-	const SRPIndexBuffer* this, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPShaderProgram* sp, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 )
 {
-	drawBuffer(this, vb, fb, sp, primitive, startIndex, count);
+	drawBuffer(ctx, ib, vb, fb, sp, primitive, startIndex, count);
 }
 
 /** @} */  // ingroup Buffer_internal
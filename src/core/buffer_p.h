@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include "srp/buffer.h"
 
 /** @ingroup Buffer_internal
@@ -18,6 +19,8 @@ struct SRPVertexBuffer
 	size_t nVertices;        /**< How many vertices does this vertex buffer contain */
 	size_t nBytesAllocated;  /**< How many bytes was already allocated for `data` */
 	SRPVertex* data;         /**< Pointer to the vertex data */
+	bool ownsData;           /**< Whether `data` was allocated by the buffer,
+	                              rather than wrapped with srpVertexBufferWrapData() */
 };
 
 struct SRPIndexBuffer
@@ -27,6 +30,8 @@ struct SRPIndexBuffer
 	size_t nIndices;         /**< How many indices does this index buffer contain */
 	size_t nBytesAllocated;  /**< How many bytes was already allocated for `data` */
 	void* data;              /**< Pointer to the index data */
+	bool ownsData;           /**< Whether `data` was allocated by the buffer,
+	                              rather than wrapped with srpIndexBufferWrapData() */
 };
 
 /** Get an element stored in SRPIndexBuffer.
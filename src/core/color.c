@@ -5,21 +5,111 @@
  *  @ingroup Framebuffer_internal
  *  SRPColor internal */
 
+#include <math.h>
+#include <threads.h>
 #include "core/color_p.h"
-#include "math/utils.h"
 
 /** @ingroup Framebuffer
  *  @{ */
 
-inline uint32_t colorPack(float color[4])
+float colorSrgbDecodeTable[256];
+uint8_t colorSrgbEncodeTable[SRGB_ENCODE_TABLE_SIZE];
+
+/** Guards the initialization of the sRGB tables */
+static once_flag srgbTablesOnce = ONCE_FLAG_INIT;
+
+/** Fill the sRGB tables. Called through `call_once()` */
+static void fillSrgbTables(void);
+
+/** Decode 4 sRGB-encoded bytes of a `uint32_t` RGBA8888 color, alpha being
+ *  linear
+ *  @param[in] packed The color
+ *  @param[out] color The linear color */
+static void colorUnpackSrgb(uint32_t packed, float color[4]);
+
+void colorInitSrgbTables(void)
+{
+    call_once(&srgbTablesOnce, fillSrgbTables);
+}
+
+void colorUnpack(uint32_t packed, float color[4])
+{
+    color[0] = (float) ((packed >> 24) & 0xFF) / 255;
+    color[1] = (float) ((packed >> 16) & 0xFF) / 255;
+    color[2] = (float) ((packed >>  8) & 0xFF) / 255;
+    color[3] = (float) ( packed        & 0xFF) / 255;
+}
+
+void colorRead(SRPColorFormat format, const void* pixel, float color[4])
+{
+    switch (format)
+    {
+        case SRP_COLOR_FORMAT_RGBA8:
+            colorUnpack(*(const uint32_t*) pixel, color);
+            break;
+        case SRP_COLOR_FORMAT_BGRA8:
+            colorUnpack(bgra8ToRgba8(*(const uint32_t*) pixel), color);
+            break;
+        case SRP_COLOR_FORMAT_RGB565:
+        {
+            const uint16_t value = *(const uint16_t*) pixel;
+            color[0] = (float) ((value >> 11) & 0x1F) / 31;
+            color[1] = (float) ((value >>  5) & 0x3F) / 63;
+            color[2] = (float) ( value        & 0x1F) / 31;
+            color[3] = 1;
+            break;
+        }
+        case SRP_COLOR_FORMAT_RGBA16F:
+            for (uint8_t i = 0; i < 4; i++)
+                color[i] = halfToFloat(((const uint16_t*) pixel)[i]);
+            break;
+        case SRP_COLOR_FORMAT_SRGBA8:
+            colorUnpackSrgb(*(const uint32_t*) pixel, color);
+            break;
+        case SRP_COLOR_FORMAT_SBGRA8:
+            colorUnpackSrgb(bgra8ToRgba8(*(const uint32_t*) pixel), color);
+            break;
+    }
+}
+
+uint32_t colorReadPacked(SRPColorFormat format, const void* pixel)
+{
+    if (format == SRP_COLOR_FORMAT_RGBA8)
+        return *(const uint32_t*) pixel;
+    if (format == SRP_COLOR_FORMAT_BGRA8)
+        return bgra8ToRgba8(*(const uint32_t*) pixel);
+
+    float color[4];
+    colorRead(format, pixel, color);
+    return colorPack(color);
+}
+
+size_t srpColorFormatSize(SRPColorFormat format)
+{
+    return colorFormatSize(format);
+}
+
+static void fillSrgbTables(void)
+{
+    for (size_t i = 0; i < 256; i++)
+    {
+        const float c = i / 255.f;
+        colorSrgbDecodeTable[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (size_t i = 0; i < SRGB_ENCODE_TABLE_SIZE; i++)
+    {
+        const float c = (float) i / (SRGB_ENCODE_TABLE_SIZE - 1);
+        const float encoded = (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1 / 2.4f) - 0.055f;
+        colorSrgbEncodeTable[i] = (uint8_t) (encoded * 255 + 0.5f);
+    }
+}
+
+static void colorUnpackSrgb(uint32_t packed, float color[4])
 {
-    SRPColor c = {
-        CLAMP(0, 255, color[0] * 255),
-        CLAMP(0, 255, color[1] * 255),
-        CLAMP(0, 255, color[2] * 255),
-        CLAMP(0, 255, color[3] * 255)
-    };
-    return SRP_COLOR_TO_UINT32_T(c);
+    color[0] = colorSrgbDecodeTable[(packed >> 24) & 0xFF];
+    color[1] = colorSrgbDecodeTable[(packed >> 16) & 0xFF];
+    color[2] = colorSrgbDecodeTable[(packed >>  8) & 0xFF];
+    color[3] = (float) (packed & 0xFF) / 255;
 }
 
 /** @} */  // ingroup Framebuffer_internal
@@ -7,22 +7,212 @@
 
 #pragma once
 
+#include <math.h>
+#include <string.h>
 #include "srp/color.h"
-#ifdef _WIN32
-	#include <winsock.h>
-#else
-	#include <arpa/inet.h>
+#include "math/utils.h"
+#if defined(__SSSE3__) || defined(__F16C__)
+	#include <immintrin.h>
 #endif
 
 /** @ingroup Framebuffer
  *  @{ */
 
-/** Convert the `SRPColor` to `uint32_t` RGBA8888 */
-// Using `htonl` since we need to convert host endian data to big endian data
-// (we want red component to be the most significant one!)
-#define SRP_COLOR_TO_UINT32_T(color) (htonl(*(uint32_t*) &color))
+/** Amount of entries in `colorSrgbEncodeTable` */
+#define SRGB_ENCODE_TABLE_SIZE 4096
+
+/** Linear value of every sRGB-encoded byte. Filled by colorInitSrgbTables() */
+extern float colorSrgbDecodeTable[256];
+/** sRGB-encoded byte of linear values `i / (SRGB_ENCODE_TABLE_SIZE - 1)`.
+ *  Looking up the nearest entry is within one step of the exact encoding and
+ *  maps every decoded byte back to itself. Filled by colorInitSrgbTables() */
+extern uint8_t colorSrgbEncodeTable[SRGB_ENCODE_TABLE_SIZE];
+
+/** Fill the sRGB conversion tables, once per process. Has to be called before
+ *  anything sRGB is read or written; thread-safe */
+void colorInitSrgbTables(void);
+
+/** Size of one pixel of a color format, as srpColorFormatSize(). Defined here
+ *  so that addressing pixels does not call into color.c per fragment */
+static inline size_t colorFormatSize(SRPColorFormat format)
+{
+	switch (format)
+	{
+		case SRP_COLOR_FORMAT_RGBA8:
+		case SRP_COLOR_FORMAT_BGRA8:
+		case SRP_COLOR_FORMAT_SRGBA8:
+		case SRP_COLOR_FORMAT_SBGRA8:
+			return sizeof(uint32_t);
+		case SRP_COLOR_FORMAT_RGB565:
+			return sizeof(uint16_t);
+		case SRP_COLOR_FORMAT_RGBA16F:
+			return 4 * sizeof(uint16_t);
+	}
+	return 0;
+}
+
+/** Pack a color represented via `float[4]` into `uint32_t` RGBA8888, red being
+ *  the most significant byte. Components are clamped to [0, 1] and truncated.
+ *  Defined here so that it is inlined into the per-fragment code */
+static inline uint32_t colorPack(const float color[4])
+{
+#ifdef __SSSE3__
+	// All four components at once; the shuffle picks the low byte of every
+	// lane in reverse order, which puts red on top without a byte swap
+	__m128 v = _mm_mul_ps(_mm_loadu_ps(color), _mm_set1_ps(255));
+	v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255));
+	const __m128i bytes = _mm_shuffle_epi8(
+		_mm_cvttps_epi32(v),
+		_mm_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)
+	);
+	return _mm_cvtsi128_si32(bytes);
+#else
+	return ((uint32_t) (uint8_t) CLAMP(0, 255, color[0] * 255) << 24) |
+	       ((uint32_t) (uint8_t) CLAMP(0, 255, color[1] * 255) << 16) |
+	       ((uint32_t) (uint8_t) CLAMP(0, 255, color[2] * 255) <<  8) |
+	        (uint32_t) (uint8_t) CLAMP(0, 255, color[3] * 255);
+#endif
+}
+
+/** Unpack `uint32_t` RGBA8888 into a color represented via `float[4]` */
+void colorUnpack(uint32_t packed, float color[4]);
+
+/** Convert a `float` to a half float, rounding to the nearest even */
+static inline uint16_t floatToHalf(float f)
+{
+#ifdef __F16C__
+	return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+	const uint16_t sign = (bits >> 16) & 0x8000;
+	uint32_t abs = bits & 0x7FFFFFFF;
+
+	if (abs >= 0x7F800000)  // Infinity or NaN, keeping NaN quiet
+		return sign | 0x7C00 | ((abs > 0x7F800000) ? 0x200 : 0);
+	if (abs >= 0x477FF000)  // At least 65520, rounds to infinity
+		return sign | 0x7C00;
+	if (abs < 0x38800000)   // Subnormal in half: a multiple of 2^-24
+		return sign | (uint16_t) nearbyintf(fabsf(f) * 0x1p24f);
+
+	// Rebias the exponent, round the dropped 13 bits to the nearest even
+	abs += 0xC8000FFF + ((abs >> 13) & 1);
+	return sign | (abs >> 13);
+#endif
+}
+
+/** Convert a half float to a `float` */
+static inline float halfToFloat(uint16_t h)
+{
+#ifdef __F16C__
+	return _cvtsh_ss(h);
+#else
+	const uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+	const uint32_t exponent = (h >> 10) & 0x1F, mantissa = h & 0x3FF;
+	if (exponent == 0)  // Zero or subnormal
+		return (sign ? -1 : 1) * (mantissa * 0x1p-24f);
+
+	const uint32_t bits = sign | (mantissa << 13) | \
+		((exponent == 0x1F) ? 0x7F800000 : (exponent + 112) << 23);
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+#endif
+}
+
+/** Swizzle a `uint32_t` RGBA8888 to SRP_COLOR_FORMAT_BGRA8 */
+static inline uint32_t rgba8ToBgra8(uint32_t rgba)
+{
+	const uint32_t argb = (rgba >> 8) | (rgba << 24);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return __builtin_bswap32(argb);
+#else
+	return argb;
+#endif
+}
+
+/** Inverse of rgba8ToBgra8() */
+static inline uint32_t bgra8ToRgba8(uint32_t bgra)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	bgra = __builtin_bswap32(bgra);
+#endif
+	return (bgra << 8) | (bgra >> 24);
+}
+
+/** Pack a linear color into `uint32_t` RGBA8888 with sRGB-encoded color
+ *  components. Alpha is packed as by colorPack()
+ *  @see colorPack() */
+static inline uint32_t colorPackSrgb(const float color[4])
+{
+	uint32_t packed = (uint8_t) CLAMP(0, 255, color[3] * 255);
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		// Written so that NaN maps to 0 rather than indexing out of the table
+		const float c = !(color[i] > 0) ? 0 : (color[i] < 1) ? color[i] : 1;
+		const uint8_t encoded = colorSrgbEncodeTable[(size_t) (c * (SRGB_ENCODE_TABLE_SIZE - 1) + 0.5)];
+		packed |= (uint32_t) encoded << (24 - 8 * i);
+	}
+	return packed;
+}
+
+/** Write a color to a pixel of a color buffer
+ *  @param[in] format Format of the color buffer
+ *  @param[out] pixel Pointer to the pixel
+ *  @param[in] color The color to write */
+static inline void colorWrite(SRPColorFormat format, void* pixel, const float color[4])
+{
+	switch (format)
+	{
+		case SRP_COLOR_FORMAT_RGBA8:
+			*(uint32_t*) pixel = colorPack(color);
+			break;
+		case SRP_COLOR_FORMAT_BGRA8:
+			*(uint32_t*) pixel = rgba8ToBgra8(colorPack(color));
+			break;
+		case SRP_COLOR_FORMAT_RGB565:
+			*(uint16_t*) pixel = \
+				((uint16_t) CLAMP(0, 31, color[0] * 31 + 0.5) << 11) |
+				((uint16_t) CLAMP(0, 63, color[1] * 63 + 0.5) <<  5) |
+				 (uint16_t) CLAMP(0, 31, color[2] * 31 + 0.5);
+			break;
+		case SRP_COLOR_FORMAT_RGBA16F:
+			for (uint8_t i = 0; i < 4; i++)
+				((uint16_t*) pixel)[i] = floatToHalf(color[i]);
+			break;
+		case SRP_COLOR_FORMAT_SRGBA8:
+			*(uint32_t*) pixel = colorPackSrgb(color);
+			break;
+		case SRP_COLOR_FORMAT_SBGRA8:
+			*(uint32_t*) pixel = rgba8ToBgra8(colorPackSrgb(color));
+			break;
+	}
+}
+
+/** Write a `uint32_t` RGBA8888 color to a pixel of a color buffer
+ *  @see colorWrite() */
+static inline void colorWritePacked(SRPColorFormat format, void* pixel, uint32_t packed)
+{
+	if (format == SRP_COLOR_FORMAT_RGBA8)
+		*(uint32_t*) pixel = packed;
+	else if (format == SRP_COLOR_FORMAT_BGRA8)
+		*(uint32_t*) pixel = rgba8ToBgra8(packed);
+	else
+	{
+		float color[4];
+		colorUnpack(packed, color);
+		colorWrite(format, pixel, color);
+	}
+}
+
+/** Read a pixel of a color buffer
+ *  @param[in] format Format of the color buffer
+ *  @param[in] pixel Pointer to the pixel
+ *  @param[out] color The color. Alpha is 1 for formats without it */
+void colorRead(SRPColorFormat format, const void* pixel, float color[4]);
 
-/** Pack a color represented via `float[4]` into `uint32_t` RGBA8888 */
-uint32_t colorPack(float color[4]);
+/** Read a pixel of a color buffer as `uint32_t` RGBA8888
+ *  @see colorRead() */
+uint32_t colorReadPacked(SRPColorFormat format, const void* pixel);
 
 /** @} */  // ingroup Framebuffer_internal
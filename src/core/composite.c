@@ -0,0 +1,189 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Framebuffer_internal
+ *  Depth compositing of framebuffers */
+
+#include <stdbool.h>
+#include "core/framebuffer_p.h"
+#include "core/context_p.h"
+#include "core/pipeline_p.h"
+#include "parallel/thread_pool.h"
+#include "utils/message_callback_p.h"
+
+/** @ingroup Framebuffer_internal
+ *  @{ */
+
+/** Amount of pixels composited by a thread at once */
+#define COMPOSITE_GRAIN (16 * 1024)
+
+/** Merge pixels [begin, end) of one source into the destination buffers */
+typedef void (*CompositeFunc)(
+	void* restrict dstColor, float* restrict dstDepth,
+	const void* restrict srcColor, const float* restrict srcDepth,
+	size_t begin, size_t end
+);
+
+/** Define a CompositeFunc for one SRPCompareOp, copying colors as words of
+ *  `type`. The loop is branchless, so that the compiler turns it into SIMD
+ *  compares and blends */
+#define DEFINE_COMPOSITE_FUNC(name, type, expr) \
+	static void composite##name( \
+		void* restrict dstColorData, float* restrict dstDepth, \
+		const void* restrict srcColorData, const float* restrict srcDepth, \
+		size_t begin, size_t end \
+	) \
+	{ \
+		type* restrict dstColor = dstColorData; \
+		const type* restrict srcColor = srcColorData; \
+		for (size_t i = begin; i < end; i++) \
+		{ \
+			const float a = srcDepth[i], b = dstDepth[i]; \
+			const bool pass = (expr); \
+			dstDepth[i] = pass ? a : b; \
+			dstColor[i] = pass ? srcColor[i] : dstColor[i]; \
+		} \
+	}
+
+/** Define the CompositeFunc-s of one SRPCompareOp for every color pixel size */
+#define DEFINE_COMPOSITE_FUNCS(name, expr) \
+	DEFINE_COMPOSITE_FUNC(name##16, uint16_t, expr) \
+	DEFINE_COMPOSITE_FUNC(name##32, uint32_t, expr) \
+	DEFINE_COMPOSITE_FUNC(name##64, uint64_t, expr)
+
+DEFINE_COMPOSITE_FUNCS(Always,   true)
+DEFINE_COMPOSITE_FUNCS(Less,     a <  b)
+DEFINE_COMPOSITE_FUNCS(LEqual,   a <= b)
+DEFINE_COMPOSITE_FUNCS(Greater,  a >  b)
+DEFINE_COMPOSITE_FUNCS(GEqual,   a >= b)
+DEFINE_COMPOSITE_FUNCS(Equal,    a == b)
+DEFINE_COMPOSITE_FUNCS(NotEqual, a != b)
+
+/** Composite functions, indexed by SRPCompareOp and color pixel size
+ *  (2, 4 and 8 bytes) */
+static const CompositeFunc compositeFuncs[][3] = {
+	[SRP_COMPARE_NEVER]    = {NULL, NULL, NULL},
+	[SRP_COMPARE_ALWAYS]   = {compositeAlways16,   compositeAlways32,   compositeAlways64},
+	[SRP_COMPARE_LESS]     = {compositeLess16,     compositeLess32,     compositeLess64},
+	[SRP_COMPARE_LEQUAL]   = {compositeLEqual16,   compositeLEqual32,   compositeLEqual64},
+	[SRP_COMPARE_GREATER]  = {compositeGreater16,  compositeGreater32,  compositeGreater64},
+	[SRP_COMPARE_GEQUAL]   = {compositeGEqual16,   compositeGEqual32,   compositeGEqual64},
+	[SRP_COMPARE_EQUAL]    = {compositeEqual16,    compositeEqual32,    compositeEqual64},
+	[SRP_COMPARE_NOTEQUAL] = {compositeNotEqual16, compositeNotEqual32, compositeNotEqual64}
+};
+
+/** Shared state of a parallel compositing loop */
+typedef struct CompositeJob
+{
+	const SRPFramebuffer* dst;              /**< The destination framebuffer */
+	const SRPFramebuffer* const* sources;   /**< The source framebuffers */
+	size_t nSources;                        /**< Amount of source framebuffers */
+	CompositeFunc func;                     /**< Merge function to use */
+} CompositeJob;
+
+/** Composite a range of pixels of all the sources, one after another,
+ *  while the destination range is hot in cache. A ParallelForFunc */
+static void compositeRange(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Check that all the sources have the same size and color format as the
+ *  destination and that no framebuffer has several color attachments, send an
+ *  error message if not
+ *  @return `true` if the sizes match, `false` otherwise */
+static bool checkSizes(
+	const SRPFramebuffer* dst, const SRPFramebuffer* const* sources, size_t nSources
+);
+
+void srpFramebufferComposite(
+	SRPContext* ctx, const SRPFramebuffer* dst,
+	const SRPFramebuffer* const* sources, size_t nSources
+)
+{
+	if (nSources == 0 || !checkSizes(dst, sources, nSources))
+		return;
+
+	const SRPCompareOp op = (ctx->boundPipeline != NULL) ? \
+		ctx->boundPipeline->state.depth.compareOp : ctx->state.depth.compareOp;
+	if (op < SRP_COMPARE_NEVER || op > SRP_COMPARE_NOTEQUAL)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid depth compare operation (%i)\n", op
+		);
+		return;
+	}
+	if (op == SRP_COMPARE_NEVER)  // Nothing ever passes
+		return;
+
+	// Draw calls to the framebuffers may still be queued
+	srpFinish(ctx);
+
+	const size_t pixelSize = framebufferColorPixelSize(dst);
+	const size_t sizeIndex = (pixelSize == 2) ? 0 : (pixelSize == 4) ? 1 : 2;
+	CompositeJob job = {
+		.dst = dst,
+		.sources = sources,
+		.nSources = nSources,
+		.func = compositeFuncs[op][sizeIndex]
+	};
+	threadPoolParallelFor(ctx->threadPool, dst->size, COMPOSITE_GRAIN, compositeRange, &job);
+	framebufferAddDamage(dst, 0, 0, dst->width, dst->height);
+}
+
+static void compositeRange(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	const CompositeJob* job = (const CompositeJob*) data;
+	for (size_t i = 0; i < job->nSources; i++)
+	{
+		const SRPFramebuffer* src = job->sources[i];
+		if (src == job->dst)
+			continue;
+		job->func(job->dst->color, job->dst->depth, src->color, src->depth, begin, end);
+	}
+}
+
+static bool checkSizes(
+	const SRPFramebuffer* dst, const SRPFramebuffer* const* sources, size_t nSources
+)
+{
+	if (dst->nColorAttachments > 1)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Framebuffers with several color attachments cannot be composited\n"
+		);
+		return false;
+	}
+	for (size_t i = 0; i < nSources; i++)
+	{
+		if (sources[i]->nColorAttachments > 1)
+		{
+			srpMessageCallbackHelper(
+				SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+				"Source framebuffer %zu has several color attachments, cannot composite it\n", i
+			);
+			return false;
+		}
+		if (sources[i]->colorFormat != dst->colorFormat)
+		{
+			srpMessageCallbackHelper(
+				SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+				"Color format of source framebuffer %zu (%i) does not match the destination (%i)\n",
+				i, sources[i]->colorFormat, dst->colorFormat
+			);
+			return false;
+		}
+		if (sources[i]->width == dst->width && sources[i]->height == dst->height)
+			continue;
+
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Size of source framebuffer %zu (%zux%zu) does not match the destination (%zux%zu)\n",
+			i, sources[i]->width, sources[i]->height, dst->width, dst->height
+		);
+		return false;
+	}
+	return true;
+}
+
+/** @} */  // ingroup Framebuffer_internal
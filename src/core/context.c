@@ -5,30 +5,40 @@
  *  @ingroup Context_internal
  *  SRPContext implementation */
 
-#include "utils/message_callback_p.h"
-#include "srp/context.h"
+#include <unistd.h>
+#include "utils/defines.h"
+#include "core/context_p.h"
+#include "core/pipeline_p.h"
 #include "memory/arena_p.h"
+#include "parallel/render_thread.h"
+#include "parallel/thread_pool.h"
 
 /** @ingroup Context_internal
  *  @{ */
 
-void srpNewContext(SRPContext* pContext)
+/** Replace the thread pool of a context, waiting for its work to complete
+ *  @param[in] this The context
+ *  @param[in] count Amount of threads of the new pool, 1 for no pool */
+static void recreateThreadPool(SRPContext* this, size_t count);
+
+SRPContext* srpNewContext()
 {
-	pContext->messageCallback = (SRPMessageCallback) {
-		.func = NULL,
-		.userParameter = NULL
-	};
+	SRPContext* this = SRP_MALLOC(sizeof(SRPContext));
 
-	pContext->provokingVertexMode = SRP_PROVOKING_VERTEX_LAST;
+	this->state.shaderProgram = NULL;
+	this->state.provokingVertexMode = SRP_PROVOKING_VERTEX_LAST;
 
-	pContext->raster = (SRPRasterState) {
+	this->state.raster = (SRPRasterState) {
 		.frontFace = SRP_WINDING_CCW,
 		.cullFace = SRP_FACE_NONE,
 		.polygonMode = SRP_POLYGON_MODE_FILL,
-		.pointSize = 1.
+		.pointSize = 1.,
+		.lineWidth = 1.,
+		.lineSmooth = false,
+		.dedupEdges = false
 	};
-	pContext->scissor = (SRPScissorState) { 0 };
-	pContext->depth = (SRPDepthState) {
+	this->state.scissor = (SRPScissorState) { 0 };
+	this->state.depth = (SRPDepthState) {
 		.testEnable = false,
 		.writeEnable = true,
 		.compareOp = SRP_COMPARE_GREATER,  /** @todo use LESS here? like OpenGL */
@@ -43,140 +53,271 @@ void srpNewContext(SRPContext* pContext)
 		.dfailOp = SRP_STENCIL_KEEP,
 		.passOp  = SRP_STENCIL_KEEP
 	};
-	pContext->stencil.enabled = false;
-	pContext->stencil.front = temp;
-	pContext->stencil.back = temp;
+	this->state.stencil.enabled = false;
+	this->state.stencil.front = temp;
+	this->state.stencil.back = temp;
+
+	this->arena = newArena(SRP_DEFAULT_ARENA_CAPACITY);
+
+	this->pipeline = SRP_MALLOC(sizeof(SRPPipeline));
+	this->pipelineDirty = true;
+	this->boundPipeline = NULL;
+
+	this->renderThread = NULL;
+	this->threadPool = NULL;
+	this->threadArenas = NULL;
+	this->pinThreads = false;
+
+	return this;
+}
+
+void srpFreeContext(SRPContext* this)
+{
+	srpAsyncDraw(this, false);
+	srpThreadCount(this, 1);
+	freeArena(this->arena);
+	SRP_FREE(this->pipeline);
+	SRP_FREE(this);
+}
+
+void srpBindPipeline(SRPContext* ctx, const SRPPipeline* pipeline)
+{
+	ctx->boundPipeline = pipeline;
+}
+
+void srpAsyncDraw(SRPContext* this, bool enable)
+{
+	if (enable && this->renderThread == NULL)
+		this->renderThread = newRenderThread(this);
+	else if (!enable && this->renderThread != NULL)
+	{
+		freeRenderThread(this->renderThread);
+		this->renderThread = NULL;
+	}
+}
+
+void srpFinish(SRPContext* this)
+{
+	if (this->renderThread != NULL)
+		renderThreadFinish(this->renderThread);
+}
 
-	pContext->arena = newArena(SRP_DEFAULT_ARENA_CAPACITY);
+void srpThreadCount(SRPContext* this, size_t count)
+{
+	if (count == 0)
+	{
+		long nCores = sysconf(_SC_NPROCESSORS_ONLN);
+		count = (nCores > 0) ? (size_t) nCores : 1;
+	}
+	if (count == threadPoolSize(this->threadPool))
+		return;
+	recreateThreadPool(this, count);
+}
+
+void srpThreadPinning(SRPContext* this, bool enable)
+{
+	if (enable == this->pinThreads)
+		return;
+	this->pinThreads = enable;
+	if (this->threadPool != NULL)
+		recreateThreadPool(this, threadPoolSize(this->threadPool));
+}
+
+static void recreateThreadPool(SRPContext* this, size_t count)
+{
+	// The pool may be in use by the render thread
+	srpFinish(this);
+	if (this->threadPool != NULL)
+	{
+		for (size_t i = 0; i < threadPoolSize(this->threadPool); i++)
+			freeArena(this->threadArenas[i]);
+		SRP_FREE(this->threadArenas);
+		freeThreadPool(this->threadPool);
+		this->threadPool = NULL;
+		this->threadArenas = NULL;
+	}
+	if (count > 1)
+	{
+		this->threadPool = newThreadPool(count, this->pinThreads);
+		this->threadArenas = SRP_MALLOC(sizeof(SRPArena*) * count);
+		for (size_t i = 0; i < count; i++)
+			this->threadArenas[i] = newArena(SRP_DEFAULT_ARENA_CAPACITY);
+	}
+}
+
+const SRPPipeline* contextGetPipeline(SRPContext* this)
+{
+	if (this->boundPipeline != NULL)
+		return this->boundPipeline;
+
+	if (this->pipelineDirty)
+	{
+		// Stay dirty if invalid, so the error is reported until the state is fixed
+		if (!pipelineInit(this->pipeline, &this->state))
+			return NULL;
+		this->pipelineDirty = false;
+	}
+
+	return this->pipeline;
+}
+
+void srpProvokingVertexMode(SRPContext* this, SRPProvokingVertexMode mode)
+{
+	this->pipelineDirty = true;
+	this->state.provokingVertexMode = mode;
+}
+
+void srpRasterCullFace(SRPContext* this, SRPFace face)
+{
+	this->pipelineDirty = true;
+	this->state.raster.cullFace = face;
 }
 
-void srpSetMessageCallback(SRPMessageCallback callback)
+void srpRasterFrontFace(SRPContext* this, SRPWinding face)
 {
-	srpContext.messageCallback = callback;
+	this->pipelineDirty = true;
+	this->state.raster.frontFace = face;
 }
 
-void srpProvokingVertexMode(SRPProvokingVertexMode mode)
+void srpRasterPolygonMode(SRPContext* this, SRPPolygonMode mode)
 {
-	srpContext.provokingVertexMode = mode;
+	this->pipelineDirty = true;
+	this->state.raster.polygonMode = mode;
 }
 
-void srpRasterCullFace(SRPFace face)
+void srpRasterPointSize(SRPContext* this, float size)
 {
-	srpContext.raster.cullFace = face;
+	this->pipelineDirty = true;
+	this->state.raster.pointSize = size;
 }
 
-void srpRasterFrontFace(SRPWinding face)
+void srpRasterLineWidth(SRPContext* this, float width)
 {
-	srpContext.raster.frontFace = face;
+	this->pipelineDirty = true;
+	this->state.raster.lineWidth = width;
 }
 
-void srpRasterPolygonMode(SRPPolygonMode mode)
+void srpRasterLineSmooth(SRPContext* this, bool enable)
 {
-	srpContext.raster.polygonMode = mode;
+	this->pipelineDirty = true;
+	this->state.raster.lineSmooth = enable;
 }
 
-void srpRasterPointSize(float size)
+void srpRasterDedupEdges(SRPContext* this, bool enable)
 {
-	srpContext.raster.pointSize = size;
+	this->pipelineDirty = true;
+	this->state.raster.dedupEdges = enable;
 }
 
-void srpScissorTest(bool enable)
+void srpScissorTest(SRPContext* this, bool enable)
 {
-	srpContext.scissor.enabled = enable;
+	this->pipelineDirty = true;
+	this->state.scissor.enabled = enable;
 }
 
-void srpScissorOptions(size_t x, size_t y, size_t width, size_t height)
+void srpScissorOptions(SRPContext* this, size_t x, size_t y, size_t width, size_t height)
 {
-	srpContext.scissor.x = x;
-	srpContext.scissor.y = y;
-	srpContext.scissor.width = width;
-	srpContext.scissor.height = height;
+	this->pipelineDirty = true;
+	this->state.scissor.x = x;
+	this->state.scissor.y = y;
+	this->state.scissor.width = width;
+	this->state.scissor.height = height;
 }
 
-void srpStencilTest(bool enable)
+void srpStencilTest(SRPContext* this, bool enable)
 {
-	srpContext.stencil.enabled = true;
+	this->pipelineDirty = true;
+	this->state.stencil.enabled = enable;
 }
 
-void srpStencilFunc(SRPCompareOp func, uint8_t ref, uint8_t mask)
+void srpStencilFunc(SRPContext* this, SRPCompareOp func, uint8_t ref, uint8_t mask)
 {
-	srpContext.stencil.front.func = func;
-	srpContext.stencil.front.ref = ref;
-	srpContext.stencil.front.mask = mask;
-	srpContext.stencil.back.func = func;
-	srpContext.stencil.back.ref = ref;
-	srpContext.stencil.back.mask = mask;
+	this->pipelineDirty = true;
+	this->state.stencil.front.func = func;
+	this->state.stencil.front.ref = ref;
+	this->state.stencil.front.mask = mask;
+	this->state.stencil.back.func = func;
+	this->state.stencil.back.ref = ref;
+	this->state.stencil.back.mask = mask;
 }
 
-void srpStencilFuncSeparate(SRPFace face, SRPCompareOp func, uint8_t ref, uint8_t mask)
+void srpStencilFuncSeparate(SRPContext* this, SRPFace face, SRPCompareOp func, uint8_t ref, uint8_t mask)
 {
+	this->pipelineDirty = true;
 	if (face == SRP_FACE_NONE)
 		return;
 
 	if (face == SRP_FACE_FRONT_AND_BACK)
-		srpStencilFunc(func, ref, mask);
+		srpStencilFunc(this, func, ref, mask);
 
-	SRPStencilFaceState* state = (face == SRP_FACE_FRONT) ? &srpContext.stencil.front : &srpContext.stencil.back;
+	SRPStencilFaceState* state = (face == SRP_FACE_FRONT) ? &this->state.stencil.front : &this->state.stencil.back;
 	state->func = func;
 	state->ref = ref;
 	state->mask = mask;
 }
 
-void srpStencilOp(SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass)
+void srpStencilOp(SRPContext* this, SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass)
 {
-	srpContext.stencil.front.sfailOp = sfail;
-	srpContext.stencil.front.dfailOp = dfail;
-	srpContext.stencil.front.passOp = pass;
-	srpContext.stencil.back.sfailOp = sfail;
-	srpContext.stencil.back.dfailOp = dfail;
-	srpContext.stencil.back.passOp = pass;
+	this->pipelineDirty = true;
+	this->state.stencil.front.sfailOp = sfail;
+	this->state.stencil.front.dfailOp = dfail;
+	this->state.stencil.front.passOp = pass;
+	this->state.stencil.back.sfailOp = sfail;
+	this->state.stencil.back.dfailOp = dfail;
+	this->state.stencil.back.passOp = pass;
 }
 
-void srpStencilOpSeparate(SRPFace face, SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass)
+void srpStencilOpSeparate(SRPContext* this, SRPFace face, SRPStencilOp sfail, SRPStencilOp dfail, SRPStencilOp pass)
 {
+	this->pipelineDirty = true;
 	if (face == SRP_FACE_NONE)
 		return;
 
 	if (face == SRP_FACE_FRONT_AND_BACK)
-		srpStencilOp(sfail, dfail, pass);
+		srpStencilOp(this, sfail, dfail, pass);
 
-	SRPStencilFaceState* state = (face == SRP_FACE_FRONT) ? &srpContext.stencil.front : &srpContext.stencil.back;
+	SRPStencilFaceState* state = (face == SRP_FACE_FRONT) ? &this->state.stencil.front : &this->state.stencil.back;
 	state->sfailOp = sfail;
 	state->dfailOp = dfail;
 	state->passOp = pass;
 }
 
-void srpStencilWriteMask(uint8_t mask)
+void srpStencilWriteMask(SRPContext* this, uint8_t mask)
 {
-	srpContext.stencil.front.writeMask = mask;
-	srpContext.stencil.back.writeMask = mask;
+	this->pipelineDirty = true;
+	this->state.stencil.front.writeMask = mask;
+	this->state.stencil.back.writeMask = mask;
 }
 
-void srpStencilWriteMaskSeparate(SRPFace face, uint8_t mask)
+void srpStencilWriteMaskSeparate(SRPContext* this, SRPFace face, uint8_t mask)
 {
+	this->pipelineDirty = true;
 	if (face == SRP_FACE_NONE)
 		return;
 
 	if (face == SRP_FACE_FRONT_AND_BACK)
-		srpStencilWriteMask(mask);
+		srpStencilWriteMask(this, mask);
 
-	SRPStencilFaceState* state = (face == SRP_FACE_FRONT) ? &srpContext.stencil.front : &srpContext.stencil.back;
+	SRPStencilFaceState* state = (face == SRP_FACE_FRONT) ? &this->state.stencil.front : &this->state.stencil.back;
 	state->writeMask = mask;
 }
 
-void srpDepthTest(bool enable)
+void srpDepthTest(SRPContext* this, bool enable)
 {
-	srpContext.depth.testEnable = enable;
+	this->pipelineDirty = true;
+	this->state.depth.testEnable = enable;
 }
 
-void srpDepthWrite(bool enable)
+void srpDepthWrite(SRPContext* this, bool enable)
 {
-	srpContext.depth.writeEnable = enable;
+	this->pipelineDirty = true;
+	this->state.depth.writeEnable = enable;
 }
 
-void srpDepthCompareOp(SRPCompareOp op)
+void srpDepthCompareOp(SRPContext* this, SRPCompareOp op)
 {
-	srpContext.depth.compareOp = op;
+	this->pipelineDirty = true;
+	this->state.depth.compareOp = op;
 }
 
 /** @} */  // ingroup Context_internal
@@ -0,0 +1,48 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context_internal
+ *  Private header for `include/srp/context.h` */
+
+#pragma once
+
+#include "srp/context.h"
+#include "srp/pipeline.h"
+#include "memory/arena_p.h"
+
+/** @ingroup Context_internal
+ *  @{ */
+
+struct SRPContext
+{
+	/** State set via setters. `shaderProgram` is always NULL */
+	SRPPipelineState state;
+	/** Pipeline compiled from `state` */
+	SRPPipeline* pipeline;
+	/** Whether `state` was changed since `pipeline` was compiled */
+	bool pipelineDirty;
+	/** Pipeline bound via srpBindPipeline(), or NULL */
+	const SRPPipeline* boundPipeline;
+
+	/** Arena for internal allocations */
+	SRPArena* arena;
+	/** Thread executing the draw calls if asynchronous submission is
+	 *  enabled, NULL otherwise */
+	struct RenderThread* renderThread;
+	/** Pool of threads sharing the work, or NULL if single-threaded */
+	struct ThreadPool* threadPool;
+	/** Arena of every thread of `threadPool`, indexed by the thread index,
+	 *  or NULL if single-threaded */
+	SRPArena** threadArenas;
+	/** Whether the workers of `threadPool` are pinned to NUMA nodes */
+	bool pinThreads;
+};
+
+/** Get the pipeline a draw call should use: the bound one, or the one compiled
+ *  from the context state (recompiled if it was changed)
+ *  @param[in] this The context
+ *  @return Pointer to the pipeline, or NULL if the context state is invalid */
+const SRPPipeline* contextGetPipeline(SRPContext* this);
+
+/** @} */  // ingroup Context_internal
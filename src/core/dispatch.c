@@ -0,0 +1,125 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Framebuffer_internal
+ *  Full-screen passes over framebuffer tiles */
+
+#include "core/framebuffer_p.h"
+#include "core/context_p.h"
+#include "math/utils.h"
+#include "parallel/thread_pool.h"
+#include "raster/tile_bins.h"
+
+/** @ingroup Framebuffer_internal
+ *  @{ */
+
+/** Shared state of a dispatch over framebuffer tiles */
+typedef struct DispatchJob
+{
+	const SRPFramebuffer* fb;    /**< The framebuffer to process */
+	size_t nTilesX;              /**< Amount of tiles in a row */
+	SRPTileKernel tileKernel;    /**< Kernel to call per tile, or NULL */
+	SRPPixelKernel pixelKernel;  /**< Kernel to call per pixel, or NULL */
+	void* userData;              /**< User pointer passed to the kernel */
+} DispatchJob;
+
+/** Run the kernels over all the framebuffer's tiles
+ *  @param[in] ctx The context to take the threads from
+ *  @param[in] job The job to run, `nTilesX` is filled in */
+static void dispatch(SRPContext* ctx, DispatchJob* job);
+
+/** Process a range of tiles. A ParallelForFunc */
+static void dispatchRange(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Call a pixel kernel for every pixel of a tile, row by row
+ *  @param[in] job The job being run
+ *  @param[in] tile The tile to walk */
+static void walkTilePixels(const DispatchJob* job, const SRPFramebufferTile* tile);
+
+void srpFramebufferDispatchTiles(
+	SRPContext* ctx, const SRPFramebuffer* fb, SRPTileKernel kernel, void* userData
+)
+{
+	DispatchJob job = {.fb = fb, .tileKernel = kernel, .userData = userData};
+	dispatch(ctx, &job);
+}
+
+void srpFramebufferDispatchPixels(
+	SRPContext* ctx, const SRPFramebuffer* fb, SRPPixelKernel kernel, void* userData
+)
+{
+	DispatchJob job = {.fb = fb, .pixelKernel = kernel, .userData = userData};
+	dispatch(ctx, &job);
+}
+
+static void dispatch(SRPContext* ctx, DispatchJob* job)
+{
+	const SRPFramebuffer* fb = job->fb;
+	if (fb->size == 0)
+		return;
+
+	// Draw calls to the framebuffer may still be queued
+	srpFinish(ctx);
+
+	job->nTilesX = (fb->width + TILE_SIZE - 1) / TILE_SIZE;
+	const size_t nTilesY = (fb->height + TILE_SIZE - 1) / TILE_SIZE;
+	threadPoolParallelFor(ctx->threadPool, job->nTilesX * nTilesY, 1, dispatchRange, job);
+	framebufferAddDamage(fb, 0, 0, fb->width, fb->height);
+}
+
+static void dispatchRange(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	const DispatchJob* job = (const DispatchJob*) data;
+	const SRPFramebuffer* fb = job->fb;
+	for (size_t t = begin; t < end; t++)
+	{
+		const size_t x0 = (t % job->nTilesX) * TILE_SIZE;
+		const size_t y0 = (t / job->nTilesX) * TILE_SIZE;
+		const size_t first = y0 * fb->width + x0;
+
+		SRPFramebufferTile tile = {
+			.x0 = x0,
+			.y0 = y0,
+			.x1 = MIN(x0 + TILE_SIZE, fb->width),
+			.y1 = MIN(y0 + TILE_SIZE, fb->height),
+			.stride = fb->width,
+			.color = {framebufferPixel(fb, first)},
+			.depth = fb->depth + first,
+			.stencil = fb->stencil + first
+		};
+		for (size_t a = 1; a < fb->nColorAttachments; a++)
+			tile.color[a] = framebufferExtraPixel(fb, a - 1, first);
+
+		if (job->tileKernel != NULL)
+			job->tileKernel(&tile, job->userData);
+		else
+			walkTilePixels(job, &tile);
+	}
+}
+
+static void walkTilePixels(const DispatchJob* job, const SRPFramebufferTile* tile)
+{
+	const SRPFramebuffer* fb = job->fb;
+	size_t pixelSizes[SRP_MAX_COLOR_ATTACHMENTS] = {framebufferColorPixelSize(fb)};
+	for (size_t a = 1; a < fb->nColorAttachments; a++)
+		pixelSizes[a] = colorFormatSize(fb->extraColorFormat[a - 1]);
+
+	SRPFramebufferPixel pixel = {0};
+	for (size_t j = 0; j < tile->y1 - tile->y0; j++)
+	{
+		pixel.y = tile->y0 + j;
+		for (size_t i = 0; i < tile->x1 - tile->x0; i++)
+		{
+			const size_t offset = j * tile->stride + i;
+			pixel.x = tile->x0 + i;
+			for (size_t a = 0; a < fb->nColorAttachments; a++)
+				pixel.color[a] = (char*) tile->color[a] + offset * pixelSizes[a];
+			pixel.depth = tile->depth + offset;
+			pixel.stencil = tile->stencil + offset;
+			job->pixelKernel(&pixel, job->userData);
+		}
+	}
+}
+
+/** @} */  // ingroup Framebuffer_internal
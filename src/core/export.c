@@ -0,0 +1,659 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Framebuffer_internal
+ *  Export of framebuffers to image files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core/framebuffer_p.h"
+#include "core/context_p.h"
+#include "core/color_p.h"
+#include "math/utils.h"
+#include "parallel/thread_pool.h"
+#include "utils/deflate.h"
+#include "utils/message_callback_p.h"
+
+/** @ingroup Framebuffer_internal
+ *  @{ */
+
+/** Amount of pixels encoded by a thread at once. Depends on nothing but the
+ *  image size, so that the output does not depend on the amount of threads */
+#define EXPORT_BAND_PIXELS (64 * 1024)
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF  0x40
+#define QOI_OP_LUMA  0x80
+#define QOI_OP_RUN   0xC0
+#define QOI_OP_RGB   0xFE
+#define QOI_OP_RGBA  0xFF
+/** Longest run a QOI_OP_RUN can encode */
+#define QOI_MAX_RUN 62
+
+/** A band of rows, encoded independently of the others */
+typedef struct EncodedBand
+{
+	uint8_t* data;        /**< The encoded bytes */
+	size_t size;          /**< Amount of encoded bytes */
+	uint32_t adler;       /**< PNG only: Adler-32 of the filtered rows */
+	size_t filteredSize;  /**< PNG only: size of the filtered rows */
+} EncodedBand;
+
+/** An encoded image, as pieces to be written one after another */
+typedef struct EncodedImage
+{
+	uint8_t header[64];    /**< Bytes before the bands */
+	size_t headerSize;     /**< Amount of bytes of `header` */
+	const void* raw;       /**< SRP_IMAGE_FORMAT_RAW only: the color buffer */
+	size_t rawSize;        /**< Size of `raw` */
+	EncodedBand* bands;    /**< The bands, top to bottom */
+	size_t nBands;         /**< Amount of bands */
+	uint8_t trailer[32];   /**< Bytes after the bands */
+	size_t trailerSize;    /**< Amount of bytes of `trailer` */
+} EncodedImage;
+
+/** Shared state of a parallel encoding of bands */
+typedef struct ExportJob
+{
+	const SRPFramebuffer* fb;          /**< The framebuffer to encode */
+	const SRPExportOptions* options;   /**< How to encode it */
+	SRPRect rect;                      /**< The region to encode, within `fb` */
+	size_t width, height;              /**< Size of `rect` */
+	const uint8_t* color;              /**< The color buffer to encode */
+	SRPColorFormat format;             /**< Format of `color` */
+	size_t channels;                   /**< 3 for RGB, 4 for RGBA */
+	size_t bandRows;                   /**< Amount of rows in a band */
+	EncodedBand* bands;                /**< Where to put the bands */
+} ExportJob;
+
+/** Validate the options and encode the image, sending an error message on
+ *  failure
+ *  @return `true` on success, `false` otherwise */
+static bool encodeImage(
+	SRPContext* ctx, const SRPFramebuffer* fb, const SRPExportOptions* options,
+	EncodedImage* image
+);
+
+/** Free the bands of an encoded image */
+static void freeEncodedImage(EncodedImage* image);
+
+/** Encode a range of bands. A ParallelForFunc */
+static void encodeBands(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Copy rows [y0, y1) of a region of the color buffer as they are */
+static void encodeRawBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band);
+
+/** Encode rows [y0, y1) as binary PPM pixels */
+static void encodePpmBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band);
+
+/** Encode rows [y0, y1) as QOI chunks. The band starts with a full pixel and
+ *  only refers to the entries of the color index it has written itself, so
+ *  a decoder reading the bands one after another sees a valid stream */
+static void encodeQoiBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band);
+
+/** Encode rows [y0, y1) as one PNG IDAT chunk holding their filtered and
+ *  deflated bytes. The first band also holds the zlib header */
+static void encodePngBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band);
+
+/** Read a row of the exported region of the color buffer as `uint32_t`
+ *  RGBA8888, opaque if the image has no alpha channel */
+static void readRow(const ExportJob* job, size_t y, uint32_t* out);
+
+/** Split `uint32_t` RGBA8888 pixels into `channels` bytes each */
+static void unpackRow(const uint32_t* row, size_t width, size_t channels, uint8_t* out);
+
+/** Apply the PNG filter that makes the row the most compressible, by the
+ *  minimum sum of absolute differences heuristic, or no filter for level 0
+ *  @param[in] prev The previous row, unfiltered, zeros for the first one
+ *  @param[in] row The row to filter
+ *  @param[in] stride Size of a row, in bytes
+ *  @param[in] bpp Size of a pixel, in bytes
+ *  @param[in] level Compression level
+ *  @param[out] out The filter type followed by the filtered row
+ *  @param[out] scratch Space for `4 * stride` bytes */
+static void filterPngRow(
+	const uint8_t* prev, const uint8_t* row, size_t stride, size_t bpp, int level,
+	uint8_t* out, uint8_t* scratch
+);
+
+/** Write a complete PNG chunk
+ *  @return Amount of bytes written, `12 + size` */
+static size_t writePngChunk(uint8_t* out, const char type[4], const uint8_t* data, size_t size);
+
+/** Write a 32-bit big-endian value */
+static inline void putBE32(uint8_t* p, uint32_t value);
+
+void* srpFramebufferEncode(
+	SRPContext* ctx, const SRPFramebuffer* fb, const SRPExportOptions* options,
+	size_t* outSize
+)
+{
+	EncodedImage image;
+	if (!encodeImage(ctx, fb, options, &image))
+		return NULL;
+
+	size_t size = image.headerSize + image.rawSize + image.trailerSize;
+	for (size_t i = 0; i < image.nBands; i++)
+		size += image.bands[i].size;
+
+	uint8_t* data = SRP_MALLOC(MAX(size, 1));
+	uint8_t* p = data;
+	memcpy(p, image.header, image.headerSize);
+	p += image.headerSize;
+	if (image.rawSize > 0)
+		memcpy(p, image.raw, image.rawSize);
+	p += image.rawSize;
+	for (size_t i = 0; i < image.nBands; i++)
+	{
+		memcpy(p, image.bands[i].data, image.bands[i].size);
+		p += image.bands[i].size;
+	}
+	memcpy(p, image.trailer, image.trailerSize);
+
+	freeEncodedImage(&image);
+	*outSize = size;
+	return data;
+}
+
+void srpFreeEncodedImage(void* data)
+{
+	SRP_FREE(data);
+}
+
+bool srpFramebufferExport(
+	SRPContext* ctx, const SRPFramebuffer* fb, const SRPExportOptions* options,
+	const char* path
+)
+{
+	EncodedImage image;
+	if (!encodeImage(ctx, fb, options, &image))
+		return false;
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Could not open %s for writing\n", path
+		);
+		freeEncodedImage(&image);
+		return false;
+	}
+
+	// The bands are written as they are, without joining them first
+	bool ok = fwrite(image.header, 1, image.headerSize, file) == image.headerSize;
+	ok &= fwrite(image.raw, 1, image.rawSize, file) == image.rawSize;
+	for (size_t i = 0; i < image.nBands; i++)
+		ok &= fwrite(image.bands[i].data, 1, image.bands[i].size, file) == image.bands[i].size;
+	ok &= fwrite(image.trailer, 1, image.trailerSize, file) == image.trailerSize;
+	ok &= fclose(file) == 0;
+
+	if (!ok)
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Could not write %s\n", path
+		);
+	freeEncodedImage(&image);
+	return ok;
+}
+
+static bool encodeImage(
+	SRPContext* ctx, const SRPFramebuffer* fb, const SRPExportOptions* options,
+	EncodedImage* image
+)
+{
+	if (options->format < SRP_IMAGE_FORMAT_RAW || options->format > SRP_IMAGE_FORMAT_PNG)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid image format (%i)\n", options->format
+		);
+		return false;
+	}
+	if (options->attachment >= fb->nColorAttachments)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid color attachment %zu (framebuffer has %zu)\n",
+			options->attachment, fb->nColorAttachments
+		);
+		return false;
+	}
+	if (options->format == SRP_IMAGE_FORMAT_PNG &&
+	    (options->compressionLevel < 0 || options->compressionLevel > 9))
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid PNG compression level (%i, must be in [0, 9])\n",
+			options->compressionLevel
+		);
+		return false;
+	}
+
+	SRPRect rect = {0, 0, fb->width, fb->height};
+	if (options->rect != NULL)
+	{
+		rect.x0 = MIN(options->rect->x0, fb->width);
+		rect.y0 = MIN(options->rect->y0, fb->height);
+		rect.x1 = CLAMP(rect.x0, fb->width, options->rect->x1);
+		rect.y1 = CLAMP(rect.y0, fb->height, options->rect->y1);
+	}
+	const size_t width = rect.x1 - rect.x0, height = rect.y1 - rect.y0;
+	if (options->format != SRP_IMAGE_FORMAT_RAW && (width == 0 || height == 0))
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Cannot encode an empty image\n"
+		);
+		return false;
+	}
+
+	// Draw calls to the framebuffer may still be queued
+	srpFinish(ctx);
+
+	const size_t a = options->attachment;
+	ExportJob job = {
+		.fb = fb,
+		.options = options,
+		.rect = rect,
+		.width = width,
+		.height = height,
+		.color = (a == 0) ? fb->color : fb->extraColor[a - 1],
+		.format = (a == 0) ? fb->colorFormat : fb->extraColorFormat[a - 1],
+		.channels = (options->format != SRP_IMAGE_FORMAT_PPM && options->alpha) ? 4 : 3
+	};
+	*image = (EncodedImage) {0};
+
+	// Other regions are copied row by row, as any other format
+	if (options->format == SRP_IMAGE_FORMAT_RAW && width == fb->width && height == fb->height)
+	{
+		image->raw = job.color;
+		image->rawSize = fb->size * colorFormatSize(job.format);
+		return true;
+	}
+
+	job.bandRows = MAX(EXPORT_BAND_PIXELS / MAX(width, 1), 1);
+	image->nBands = (height + job.bandRows - 1) / job.bandRows;
+	image->bands = SRP_MALLOC(sizeof(EncodedBand) * image->nBands);
+	job.bands = image->bands;
+	threadPoolParallelFor(ctx->threadPool, image->nBands, 1, encodeBands, &job);
+
+	uint8_t* h = image->header;
+	uint8_t* t = image->trailer;
+	switch (options->format)
+	{
+		case SRP_IMAGE_FORMAT_PPM:
+			image->headerSize = snprintf(
+				(char*) h, sizeof(image->header), "P6\n%zu %zu\n255\n", width, height
+			);
+			break;
+		case SRP_IMAGE_FORMAT_QOI:
+			memcpy(h, "qoif", 4);
+			putBE32(h + 4, width);
+			putBE32(h + 8, height);
+			h[12] = job.channels;
+			h[13] = 0;  // sRGB color with linear alpha
+			image->headerSize = 14;
+			memcpy(t, (uint8_t[]) {0, 0, 0, 0, 0, 0, 0, 1}, 8);
+			image->trailerSize = 8;
+			break;
+		case SRP_IMAGE_FORMAT_PNG:
+		{
+			memcpy(h, (uint8_t[]) {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'}, 8);
+			uint8_t ihdr[13] = {
+				[8] = 8,                              // Bit depth
+				[9] = (job.channels == 4) ? 6 : 2     // Truecolor (with alpha)
+			};
+			putBE32(ihdr, width);
+			putBE32(ihdr + 4, height);
+			image->headerSize = 8 + writePngChunk(h + 8, "IHDR", ihdr, sizeof(ihdr));
+
+			// Terminate the deflate stream, and the zlib stream with the
+			// checksum of all the bands
+			uint32_t adler = 1;
+			for (size_t i = 0; i < image->nBands; i++)
+				adler = adler32Combine(adler, image->bands[i].adler, image->bands[i].filteredSize);
+			uint8_t end[DEFLATE_FINAL_BLOCK_SIZE + 4];
+			memcpy(end, deflateFinalBlock, DEFLATE_FINAL_BLOCK_SIZE);
+			putBE32(end + DEFLATE_FINAL_BLOCK_SIZE, adler);
+			image->trailerSize = writePngChunk(t, "IDAT", end, sizeof(end));
+			image->trailerSize += writePngChunk(t + image->trailerSize, "IEND", NULL, 0);
+			break;
+		}
+		default:
+			break;
+	}
+	return true;
+}
+
+static void freeEncodedImage(EncodedImage* image)
+{
+	for (size_t i = 0; i < image->nBands; i++)
+		SRP_FREE(image->bands[i].data);
+	SRP_FREE(image->bands);
+}
+
+static void encodeBands(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	const ExportJob* job = (const ExportJob*) data;
+	for (size_t b = begin; b < end; b++)
+	{
+		const size_t y0 = b * job->bandRows;
+		const size_t y1 = MIN(y0 + job->bandRows, job->height);
+		EncodedBand* band = &job->bands[b];
+		*band = (EncodedBand) {0};
+		switch (job->options->format)
+		{
+			case SRP_IMAGE_FORMAT_RAW:
+				encodeRawBand(job, y0, y1, band);
+				break;
+			case SRP_IMAGE_FORMAT_PPM:
+				encodePpmBand(job, y0, y1, band);
+				break;
+			case SRP_IMAGE_FORMAT_QOI:
+				encodeQoiBand(job, y0, y1, band);
+				break;
+			case SRP_IMAGE_FORMAT_PNG:
+				encodePngBand(job, y0, y1, band);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+static void encodeRawBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band)
+{
+	const size_t pixelSize = colorFormatSize(job->format);
+	const size_t stride = job->width * pixelSize;
+	band->size = (y1 - y0) * stride;
+	band->data = SRP_MALLOC(MAX(band->size, 1));
+	for (size_t y = y0; y < y1; y++)
+	{
+		const size_t index = (job->rect.y0 + y) * job->fb->width + job->rect.x0;
+		memcpy(band->data + (y - y0) * stride, job->color + index * pixelSize, stride);
+	}
+}
+
+static void encodePpmBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band)
+{
+	const size_t width = job->width;
+	uint32_t* row = SRP_MALLOC(sizeof(uint32_t) * width);
+	band->size = (y1 - y0) * width * 3;
+	band->data = SRP_MALLOC(band->size);
+	for (size_t y = y0; y < y1; y++)
+	{
+		readRow(job, y, row);
+		unpackRow(row, width, 3, band->data + (y - y0) * width * 3);
+	}
+	SRP_FREE(row);
+}
+
+static void encodeQoiBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band)
+{
+	const size_t width = job->width;
+	const size_t nPixels = (y1 - y0) * width;
+	uint32_t* pixels = SRP_MALLOC(sizeof(uint32_t) * nPixels);
+	for (size_t y = y0; y < y1; y++)
+		readRow(job, y, pixels + (y - y0) * width);
+
+	// Every pixel takes at most 5 bytes, the first one included
+	uint8_t* out = band->data = SRP_MALLOC(nPixels * 5);
+	uint32_t index[64];
+	uint64_t written = 0;  // Bit mask of the `index` entries written by this band
+	uint32_t prev = pixels[0];
+	size_t run = 0;
+
+	if (job->channels == 4)
+	{
+		*out++ = QOI_OP_RGBA;
+		*out++ = prev >> 24; *out++ = prev >> 16; *out++ = prev >> 8; *out++ = prev;
+	}
+	else  // Opaque, as the last pixel of the previous band
+	{
+		*out++ = QOI_OP_RGB;
+		*out++ = prev >> 24; *out++ = prev >> 16; *out++ = prev >> 8;
+	}
+	{
+		const uint8_t r = prev >> 24, g = prev >> 16, b = prev >> 8, a = prev;
+		const unsigned h = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+		index[h] = prev;
+		written |= 1ull << h;
+	}
+
+	for (size_t i = 1; i < nPixels; i++)
+	{
+		const uint32_t px = pixels[i];
+		if (px == prev)
+		{
+			if (++run == QOI_MAX_RUN)
+			{
+				*out++ = QOI_OP_RUN | (run - 1);
+				run = 0;
+			}
+			continue;
+		}
+		if (run > 0)
+		{
+			*out++ = QOI_OP_RUN | (run - 1);
+			run = 0;
+		}
+
+		const uint8_t r = px >> 24, g = px >> 16, b = px >> 8, a = px;
+		const unsigned h = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+		if ((written >> h & 1) && index[h] == px)
+			*out++ = QOI_OP_INDEX | h;
+		else
+		{
+			index[h] = px;
+			written |= 1ull << h;
+
+			if (a == (uint8_t) prev)
+			{
+				const int8_t dr = r - (uint8_t) (prev >> 24);
+				const int8_t dg = g - (uint8_t) (prev >> 16);
+				const int8_t db = b - (uint8_t) (prev >> 8);
+				const int8_t drg = dr - dg, dbg = db - dg;
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+					*out++ = QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+				else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+				{
+					*out++ = QOI_OP_LUMA | (dg + 32);
+					*out++ = (drg + 8) << 4 | (dbg + 8);
+				}
+				else
+				{
+					*out++ = QOI_OP_RGB;
+					*out++ = r; *out++ = g; *out++ = b;
+				}
+			}
+			else
+			{
+				*out++ = QOI_OP_RGBA;
+				*out++ = r; *out++ = g; *out++ = b; *out++ = a;
+			}
+		}
+		prev = px;
+	}
+	if (run > 0)
+		*out++ = QOI_OP_RUN | (run - 1);
+
+	band->size = out - band->data;
+	SRP_FREE(pixels);
+}
+
+static void encodePngBand(const ExportJob* job, size_t y0, size_t y1, EncodedBand* band)
+{
+	const size_t width = job->width, channels = job->channels;
+	const size_t stride = width * channels, rows = y1 - y0;
+	const int level = job->options->compressionLevel;
+
+	// Filters look at the row above, so the one above the band is read too
+	uint32_t* row = SRP_MALLOC(sizeof(uint32_t) * width);
+	uint8_t* raw = SRP_MALLOC(stride * (rows + 1));
+	if (y0 == 0)
+		memset(raw, 0, stride);
+	for (size_t y = (y0 == 0) ? 0 : y0 - 1; y < y1; y++)
+	{
+		readRow(job, y, row);
+		unpackRow(row, width, channels, raw + (y + 1 - y0) * stride);
+	}
+
+	const size_t filteredSize = (stride + 1) * rows;
+	uint8_t* filtered = SRP_MALLOC(filteredSize);
+	uint8_t* scratch = SRP_MALLOC(4 * stride);
+	for (size_t r = 0; r < rows; r++)
+	{
+		filterPngRow(
+			raw + r * stride, raw + (r + 1) * stride, stride, channels, level,
+			filtered + r * (stride + 1), scratch
+		);
+	}
+	band->adler = adler32Update(1, filtered, filteredSize);
+	band->filteredSize = filteredSize;
+
+	// Chunk length and type, zlib header, deflate blocks, CRC
+	band->data = SRP_MALLOC(8 + 2 + deflateBound(filteredSize) + 4);
+	uint8_t* p = band->data + 8;
+	if (y0 == 0)
+	{
+		// Deflate with 32 KiB window; the level hint matches zlib's
+		*p++ = 0x78;
+		*p++ = (level <= 1) ? 0x01 : (level <= 5) ? 0x5E : (level == 6) ? 0x9C : 0xDA;
+	}
+	p += deflateCompress(filtered, filteredSize, level, p);
+
+	const size_t dataSize = p - (band->data + 8);
+	putBE32(band->data, dataSize);
+	memcpy(band->data + 4, "IDAT", 4);
+	putBE32(p, crc32Update(0, band->data + 4, dataSize + 4));
+	band->size = dataSize + 12;
+
+	SRP_FREE(row);
+	SRP_FREE(raw);
+	SRP_FREE(filtered);
+	SRP_FREE(scratch);
+}
+
+static void readRow(const ExportJob* job, size_t y, uint32_t* out)
+{
+	const size_t width = job->width;
+	const size_t pixelSize = colorFormatSize(job->format);
+	const size_t index = (job->rect.y0 + y) * job->fb->width + job->rect.x0;
+	const uint8_t* pixel = job->color + index * pixelSize;
+	const uint32_t opaque = (job->channels == 3) ? 0xFF : 0;
+
+	switch (job->format)
+	{
+		// sRGB bytes are what image files expect, so they are copied as well
+		case SRP_COLOR_FORMAT_RGBA8:
+		case SRP_COLOR_FORMAT_SRGBA8:
+			for (size_t x = 0; x < width; x++)
+				out[x] = ((const uint32_t*) pixel)[x] | opaque;
+			break;
+		case SRP_COLOR_FORMAT_BGRA8:
+		case SRP_COLOR_FORMAT_SBGRA8:
+			for (size_t x = 0; x < width; x++)
+				out[x] = bgra8ToRgba8(((const uint32_t*) pixel)[x]) | opaque;
+			break;
+		default:
+			// Rounded, unlike colorPack(), for the closest 8-bit color
+			for (size_t x = 0; x < width; x++)
+			{
+				float color[4];
+				colorRead(job->format, pixel + x * pixelSize, color);
+				out[x] = opaque;
+				for (int i = 0; i < 4; i++)
+					out[x] |= (uint32_t) (CLAMP(0, 1, color[i]) * 255 + 0.5f) << (24 - 8 * i);
+			}
+			break;
+	}
+}
+
+static void unpackRow(const uint32_t* row, size_t width, size_t channels, uint8_t* out)
+{
+	if (channels == 4)
+	{
+		for (size_t x = 0; x < width; x++, out += 4)
+		{
+			out[0] = row[x] >> 24; out[1] = row[x] >> 16; out[2] = row[x] >> 8; out[3] = row[x];
+		}
+	}
+	else
+	{
+		for (size_t x = 0; x < width; x++, out += 3)
+		{
+			out[0] = row[x] >> 24; out[1] = row[x] >> 16; out[2] = row[x] >> 8;
+		}
+	}
+}
+
+static void filterPngRow(
+	const uint8_t* prev, const uint8_t* row, size_t stride, size_t bpp, int level,
+	uint8_t* out, uint8_t* scratch
+)
+{
+	out[0] = 0;
+	memcpy(out + 1, row, stride);
+	if (level == 0)
+		return;
+
+	// Sub, Up, Average and Paeth into the scratch, None is already in place
+	for (size_t i = 0; i < stride; i++)
+	{
+		const int left = (i >= bpp) ? row[i - bpp] : 0;
+		const int up = prev[i];
+		const int upLeft = (i >= bpp) ? prev[i - bpp] : 0;
+
+		const int pa = abs(up - upLeft), pb = abs(left - upLeft);
+		const int pc = abs(left + up - 2 * upLeft);
+		const int paeth = (pa <= pb && pa <= pc) ? left : (pb <= pc) ? up : upLeft;
+
+		scratch[i] = row[i] - left;
+		scratch[stride + i] = row[i] - up;
+		scratch[2 * stride + i] = row[i] - ((left + up) >> 1);
+		scratch[3 * stride + i] = row[i] - paeth;
+	}
+
+	size_t best = 0, bestScore = 0;
+	for (size_t i = 0; i < stride; i++)
+		bestScore += abs((int8_t) row[i]);
+	for (size_t f = 0; f < 4; f++)
+	{
+		size_t score = 0;
+		for (size_t i = 0; i < stride; i++)
+			score += abs((int8_t) scratch[f * stride + i]);
+		if (score < bestScore)
+		{
+			best = f + 1;
+			bestScore = score;
+		}
+	}
+	if (best != 0)
+	{
+		out[0] = best;
+		memcpy(out + 1, scratch + (best - 1) * stride, stride);
+	}
+}
+
+static size_t writePngChunk(uint8_t* out, const char type[4], const uint8_t* data, size_t size)
+{
+	putBE32(out, size);
+	memcpy(out + 4, type, 4);
+	if (size > 0)
+		memcpy(out + 8, data, size);
+	putBE32(out + 8 + size, crc32Update(0, out + 4, size + 4));
+	return size + 12;
+}
+
+static inline void putBE32(uint8_t* p, uint32_t value)
+{
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+/** @} */  // ingroup Framebuffer_internal
@@ -0,0 +1,64 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context_internal
+ *  SRPFence implementation */
+
+#include "core/fence_p.h"
+#include "core/context_p.h"
+#include "parallel/render_thread.h"
+#include "utils/defines.h"
+
+/** @ingroup Context_internal
+ *  @{ */
+
+SRPFence* srpNewFence(SRPContext* ctx)
+{
+	SRPFence* this = SRP_MALLOC(sizeof(SRPFence));
+	mtx_init(&this->lock, mtx_plain);
+	cnd_init(&this->cond);
+	this->signaled = false;
+
+	if (ctx->renderThread != NULL)
+		renderThreadSubmitFence(ctx->renderThread, this);
+	else
+		this->signaled = true;
+
+	return this;
+}
+
+void srpFreeFence(SRPFence* this)
+{
+	// The render thread may still hold a pointer to it
+	srpFenceWait(this);
+	mtx_destroy(&this->lock);
+	cnd_destroy(&this->cond);
+	SRP_FREE(this);
+}
+
+void srpFenceWait(SRPFence* this)
+{
+	mtx_lock(&this->lock);
+	while (!this->signaled)
+		cnd_wait(&this->cond, &this->lock);
+	mtx_unlock(&this->lock);
+}
+
+bool srpFenceIsSignaled(SRPFence* this)
+{
+	mtx_lock(&this->lock);
+	bool signaled = this->signaled;
+	mtx_unlock(&this->lock);
+	return signaled;
+}
+
+void fenceSignal(SRPFence* this)
+{
+	mtx_lock(&this->lock);
+	this->signaled = true;
+	cnd_broadcast(&this->cond);
+	mtx_unlock(&this->lock);
+}
+
+/** @} */  // ingroup Context_internal
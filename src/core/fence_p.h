@@ -0,0 +1,27 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context_internal
+ *  Private header for `include/srp/fence.h` */
+
+#pragma once
+
+#include <threads.h>
+#include "srp/fence.h"
+
+/** @ingroup Context_internal
+ *  @{ */
+
+struct SRPFence
+{
+	mtx_t lock;      /**< Protects `signaled` */
+	cnd_t cond;      /**< Broadcasted when the fence gets signaled */
+	bool signaled;   /**< Whether the fence is signaled */
+};
+
+/** Signal the fence, waking up everyone waiting on it
+ *  @param[in] this The fence to signal */
+void fenceSignal(SRPFence* this);
+
+/** @} */  // ingroup Context_internal
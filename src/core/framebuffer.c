@@ -8,39 +8,92 @@
 #include <stdio.h>
 #include <string.h>
 #include "core/framebuffer_p.h"
+#include "core/color_p.h"
 #include "utils/message_callback_p.h"
 #include "math/utils.h"
+#include "parallel/numa.h"
+#include "raster/tile_bins.h"
 
 /** @ingroup Framebuffer_internal
  *  @{ */
 
 SRPFramebuffer* srpNewFramebuffer(size_t width, size_t height)
 {
+	return srpNewFramebufferFormat(width, height, SRP_COLOR_FORMAT_RGBA8);
+}
+
+SRPFramebuffer* srpNewFramebufferFormat(size_t width, size_t height, SRPColorFormat format)
+{
+	return srpNewFramebufferAttachments(width, height, 1, &format);
+}
+
+SRPFramebuffer* srpNewFramebufferAttachments(
+	size_t width, size_t height, size_t nAttachments, const SRPColorFormat* formats
+)
+{
+	if (nAttachments == 0 || nAttachments > SRP_MAX_COLOR_ATTACHMENTS)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid amount of color attachments (%zu, at most %i)\n",
+			nAttachments, SRP_MAX_COLOR_ATTACHMENTS
+		);
+		return NULL;
+	}
+	for (size_t i = 0; i < nAttachments; i++)
+	{
+		if (colorFormatSize(formats[i]) == 0)
+		{
+			srpMessageCallbackHelper(
+				SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+				"Invalid color format of attachment %zu (%i)\n", i, formats[i]
+			);
+			return NULL;
+		}
+		if (formats[i] == SRP_COLOR_FORMAT_SRGBA8 || formats[i] == SRP_COLOR_FORMAT_SBGRA8)
+			colorInitSrgbTables();
+	}
+
 	SRPFramebuffer* this = SRP_MALLOC(sizeof(SRPFramebuffer));
 	this->width = width;
 	this->height = height;
 	this->size = width * height;
-	this->color = SRP_MALLOC(sizeof(uint32_t) * this->size);
+	this->color = SRP_MALLOC(colorFormatSize(formats[0]) * this->size);
+	this->colorFormat = formats[0];
+	this->nColorAttachments = nAttachments;
+	for (size_t i = 0; i < SRP_MAX_COLOR_ATTACHMENTS - 1; i++)
+	{
+		const bool used = i + 1 < nAttachments;
+		this->extraColorFormat[i] = (used) ? formats[i + 1] : SRP_COLOR_FORMAT_RGBA8;
+		this->extraColor[i] = (used) ?
+			SRP_MALLOC(colorFormatSize(formats[i + 1]) * this->size) : NULL;
+	}
 	this->depth = SRP_MALLOC(sizeof(float) * this->size);
 	this->stencil = SRP_MALLOC(sizeof(uint8_t) * this->size);
+	this->numaPlacement = SRP_NUMA_PLACEMENT_DEFAULT;
+	this->damage = SRP_MALLOC(sizeof(SRPFramebufferDamage));
+	srpFramebufferResetDamage(this);
 	return this;
 }
 
 void srpFreeFramebuffer(SRPFramebuffer* this)
 {
 	SRP_FREE(this->color);
+	for (size_t i = 0; i + 1 < this->nColorAttachments; i++)
+		SRP_FREE(this->extraColor[i]);
 	SRP_FREE(this->depth);
 	SRP_FREE(this->stencil);
+	SRP_FREE(this->damage);
 	SRP_FREE(this);
 }
 
 SRP_FORCEINLINE void framebufferGetPointers(
 	const SRPFramebuffer* this, size_t x, size_t y,
-	uint32_t** pColor, float** pDepth, uint8_t** pStencil
+	void** pColor, float** pDepth, uint8_t** pStencil
 )
 {
     size_t idx = y * this->width + x;
-    *pColor = &this->color[idx];
+    *pColor = framebufferPixel(this, idx);
     *pDepth = &this->depth[idx];
 	*pStencil = &this->stencil[idx];
 }
@@ -56,9 +109,163 @@ void framebufferNDCToScreenSpace(
 
 void srpFramebufferClear(const SRPFramebuffer* this)
 {
-	memset(this->color, 0x00, this->size * sizeof(uint32_t));
+	// Zero is transparent black in every color format
+	memset(this->color, 0x00, this->size * framebufferColorPixelSize(this));
+	for (size_t i = 0; i + 1 < this->nColorAttachments; i++)
+		memset(this->extraColor[i], 0x00, this->size * colorFormatSize(this->extraColorFormat[i]));
     for (size_t i = 0; i < this->size; i++)
         this->depth[i] = -1.;
 }
 
+void srpFramebufferClearRect(const SRPFramebuffer* this, const SRPRect* rect)
+{
+	const size_t x0 = MIN(rect->x0, this->width), x1 = MIN(rect->x1, this->width);
+	const size_t y0 = MIN(rect->y0, this->height), y1 = MIN(rect->y1, this->height);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	const size_t pixelSize = framebufferColorPixelSize(this);
+	for (size_t y = y0; y < y1; y++)
+	{
+		const size_t row = y * this->width;
+		memset(framebufferPixel(this, row + x0), 0x00, (x1 - x0) * pixelSize);
+		for (size_t i = 0; i + 1 < this->nColorAttachments; i++)
+			memset(
+				framebufferExtraPixel(this, i, row + x0), 0x00,
+				(x1 - x0) * colorFormatSize(this->extraColorFormat[i])
+			);
+		for (size_t x = x0; x < x1; x++)
+			this->depth[row + x] = -1.;
+	}
+}
+
+SRPRect srpFramebufferDamage(const SRPFramebuffer* this)
+{
+	const SRPFramebufferDamage* damage = this->damage;
+	SRPRect rect = {
+		.x0 = atomic_load_explicit(&damage->x0, memory_order_relaxed),
+		.y0 = atomic_load_explicit(&damage->y0, memory_order_relaxed),
+		.x1 = atomic_load_explicit(&damage->x1, memory_order_relaxed),
+		.y1 = atomic_load_explicit(&damage->y1, memory_order_relaxed)
+	};
+	if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1)
+		return (SRPRect) {0};
+	return rect;
+}
+
+SRPRect srpRectUnion(SRPRect a, SRPRect b)
+{
+	if (a.x0 >= a.x1 || a.y0 >= a.y1)
+		return (b.x0 >= b.x1 || b.y0 >= b.y1) ? (SRPRect) {0} : b;
+	if (b.x0 >= b.x1 || b.y0 >= b.y1)
+		return a;
+	return (SRPRect) {
+		.x0 = MIN(a.x0, b.x0), .y0 = MIN(a.y0, b.y0),
+		.x1 = MAX(a.x1, b.x1), .y1 = MAX(a.y1, b.y1)
+	};
+}
+
+void srpFramebufferResetDamage(SRPFramebuffer* this)
+{
+	SRPFramebufferDamage* damage = this->damage;
+	atomic_store_explicit(&damage->x0, SIZE_MAX, memory_order_relaxed);
+	atomic_store_explicit(&damage->y0, SIZE_MAX, memory_order_relaxed);
+	atomic_store_explicit(&damage->x1, 0, memory_order_relaxed);
+	atomic_store_explicit(&damage->y1, 0, memory_order_relaxed);
+}
+
+void srpFramebufferReadPixel(const SRPFramebuffer* this, size_t x, size_t y, float color[4])
+{
+	srpFramebufferReadAttachmentPixel(this, 0, x, y, color);
+}
+
+void srpFramebufferReadAttachmentPixel(
+	const SRPFramebuffer* this, size_t attachment, size_t x, size_t y, float color[4]
+)
+{
+	if (attachment >= this->nColorAttachments)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid color attachment %zu (framebuffer has %zu)\n",
+			attachment, this->nColorAttachments
+		);
+		return;
+	}
+
+	const size_t index = y * this->width + x;
+	if (attachment == 0)
+		colorRead(this->colorFormat, framebufferPixel(this, index), color);
+	else
+		colorRead(
+			this->extraColorFormat[attachment - 1],
+			framebufferExtraPixel(this, attachment - 1, index), color
+		);
+}
+
+void srpFramebufferNumaPlacement(SRPFramebuffer* this, SRPNumaPlacement placement)
+{
+	const size_t pixelSize = framebufferColorPixelSize(this);
+	bool success = true;
+	if (placement == SRP_NUMA_PLACEMENT_INTERLEAVE)
+	{
+		success &= numaInterleave(this->color, pixelSize * this->size);
+		for (size_t i = 0; i + 1 < this->nColorAttachments; i++)
+			success &= numaInterleave(
+				this->extraColor[i], colorFormatSize(this->extraColorFormat[i]) * this->size
+			);
+		success &= numaInterleave(this->depth, sizeof(float) * this->size);
+		success &= numaInterleave(this->stencil, sizeof(uint8_t) * this->size);
+	}
+	else if (placement == SRP_NUMA_PLACEMENT_PARTITION)
+	{
+		// Tile rows are contiguous in memory, so every band is as well
+		const size_t nNodes = numaNodeCount();
+		const size_t nTileRows = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+		for (size_t ty = 0; ty < nTileRows; ty++)
+		{
+			const size_t node = numaPartitionNode(ty, nTileRows, nNodes);
+			const size_t first = ty * TILE_SIZE * this->width;
+			const size_t count = MIN(TILE_SIZE, this->height - ty * TILE_SIZE) * this->width;
+			success &= numaBind((char*) this->color + pixelSize * first, pixelSize * count, node);
+			for (size_t i = 0; i + 1 < this->nColorAttachments; i++)
+			{
+				const size_t size = colorFormatSize(this->extraColorFormat[i]);
+				success &= numaBind((char*) this->extraColor[i] + size * first, size * count, node);
+			}
+			success &= numaBind(this->depth + first, sizeof(float) * count, node);
+			success &= numaBind(this->stencil + first, sizeof(uint8_t) * count, node);
+		}
+	}
+	else if (placement == SRP_NUMA_PLACEMENT_DEFAULT)
+	{
+		// Otherwise the pages keep the policy of the previous placement
+		if (this->numaPlacement != SRP_NUMA_PLACEMENT_DEFAULT)
+		{
+			success &= numaResetPlacement(this->color, pixelSize * this->size);
+			for (size_t i = 0; i + 1 < this->nColorAttachments; i++)
+				success &= numaResetPlacement(
+					this->extraColor[i], colorFormatSize(this->extraColorFormat[i]) * this->size
+				);
+			success &= numaResetPlacement(this->depth, sizeof(float) * this->size);
+			success &= numaResetPlacement(this->stencil, sizeof(uint8_t) * this->size);
+		}
+	}
+	else
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Invalid NUMA placement (%i)\n", placement
+		);
+		return;
+	}
+
+	if (!success)
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_WARNING, SRP_MESSAGE_SEVERITY_LOW, __func__,
+			"Could not place the framebuffer on NUMA nodes\n"
+		);
+	this->numaPlacement = placement;
+}
+
 /** @} */  // ingroup Framebuffer_internal
@@ -8,12 +8,61 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "srp/framebuffer.h"
+#include "core/color_p.h"
 #include "utils/defines.h"
 
 /** @ingroup Framebuffer_internal
  *  @{ */
 
+/** Bounding box of the pixels that may have changed, grown concurrently by
+ *  the threads rasterizing into the framebuffer. Empty if `x0 >= x1`
+ *  @see srpFramebufferDamage() */
+typedef struct SRPFramebufferDamage
+{
+	_Atomic uint64_t x0, y0;  /**< Top left corner, inclusive */
+	_Atomic uint64_t x1, y1;  /**< Bottom right corner, exclusive */
+} SRPFramebufferDamage;
+
+/** Atomically lower a value to `value` if it is bigger. Used by the damage
+ *  boxes and by point cloud splatting */
+static inline void atomicStoreMin(_Atomic uint64_t* p, uint64_t value)
+{
+	// Most calls do not lower the value, so the plain load filters them out
+	// without taking the cache line exclusively
+	uint64_t current = atomic_load_explicit(p, memory_order_relaxed);
+	while (value < current && !atomic_compare_exchange_weak_explicit(
+		p, &current, value, memory_order_relaxed, memory_order_relaxed
+	));
+}
+
+/** Atomically raise a value to `value` if it is smaller */
+static inline void atomicStoreMax(_Atomic uint64_t* p, uint64_t value)
+{
+	uint64_t current = atomic_load_explicit(p, memory_order_relaxed);
+	while (value > current && !atomic_compare_exchange_weak_explicit(
+		p, &current, value, memory_order_relaxed, memory_order_relaxed
+	));
+}
+
+/** Add a rectangle to the damage of a framebuffer. Thread-safe
+ *  @param[in] this Pointer to the SRPFramebuffer
+ *  @param[in] x0,y0,x1,y1 The rectangle, `[x0, x1) x [y0, y1)`, within the
+ *                         framebuffer. Ignored if empty */
+static inline void framebufferAddDamage(
+	const SRPFramebuffer* this, size_t x0, size_t y0, size_t x1, size_t y1
+)
+{
+	if (x0 >= x1 || y0 >= y1)
+		return;
+	SRPFramebufferDamage* damage = this->damage;
+	atomicStoreMin(&damage->x0, x0);
+	atomicStoreMin(&damage->y0, y0);
+	atomicStoreMax(&damage->x1, x1);
+	atomicStoreMax(&damage->y1, y1);
+}
+
 /** Get pointers inside color and depth buffers for pixel at (x, y)
  *  @param[in] this Pointer to the SRPFramebuffer
  *  @param[in] x,y Coordinates of the needed pixel
@@ -22,9 +71,36 @@
  *  @param[out] pStencil Pointer to the stencil value */
 void framebufferGetPointers(
 	const SRPFramebuffer* this, size_t x, size_t y,
-	uint32_t** pColor, float** pDepth, uint8_t** pStencil
+	void** pColor, float** pDepth, uint8_t** pStencil
 );
 
+/** Get the size of one pixel of the color buffer
+ *  @param[in] this Pointer to the SRPFramebuffer
+ *  @return Size in bytes */
+static inline size_t framebufferColorPixelSize(const SRPFramebuffer* this)
+{
+	return colorFormatSize(this->colorFormat);
+}
+
+/** Get a pointer to a pixel of the color buffer
+ *  @param[in] this Pointer to the SRPFramebuffer
+ *  @param[in] index Index of the pixel, `y * width + x`
+ *  @return Pointer to the pixel */
+static inline void* framebufferPixel(const SRPFramebuffer* this, size_t index)
+{
+	return (char*) this->color + index * framebufferColorPixelSize(this);
+}
+
+/** Get a pointer to a pixel of color attachment 1 or above
+ *  @param[in] this Pointer to the SRPFramebuffer
+ *  @param[in] extra Index into SRPFramebuffer.extraColor, i.e. attachment - 1
+ *  @param[in] index Index of the pixel, `y * width + x`
+ *  @return Pointer to the pixel */
+static inline void* framebufferExtraPixel(const SRPFramebuffer* this, size_t extra, size_t index)
+{
+	return (char*) this->extraColor[extra] + index * colorFormatSize(this->extraColorFormat[extra]);
+}
+
 /** Convert Normalized Device Coordinates to screen-space coordiantes
  *  @param[in] this The pointer to SRPFramebuffer, as returned
  *                    from srpNewFramebuffer
@@ -0,0 +1,227 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context_internal
+ *  SRPPipeline implementation */
+
+#include <stdint.h>
+#include "core/pipeline_p.h"
+#include "utils/message_callback_p.h"
+#include "utils/defines.h"
+
+/** @ingroup Context_internal
+ *  @{ */
+
+/** Define depth and stencil comparison functions for one SRPCompareOp */
+#define DEFINE_COMPARE_FUNCS(name, expr) \
+	static bool depth##name(float a, float b) { return (expr); } \
+	static bool stencil##name(uint8_t a, uint8_t b) { return (expr); }
+
+DEFINE_COMPARE_FUNCS(Never,    false)
+DEFINE_COMPARE_FUNCS(Always,   true)
+DEFINE_COMPARE_FUNCS(Less,     a <  b)
+DEFINE_COMPARE_FUNCS(LEqual,   a <= b)
+DEFINE_COMPARE_FUNCS(Greater,  a >  b)
+DEFINE_COMPARE_FUNCS(GEqual,   a >= b)
+DEFINE_COMPARE_FUNCS(Equal,    a == b)
+DEFINE_COMPARE_FUNCS(NotEqual, a != b)
+
+static const DepthTestFunc depthTestFuncs[] = {
+	[SRP_COMPARE_NEVER]    = depthNever,
+	[SRP_COMPARE_ALWAYS]   = depthAlways,
+	[SRP_COMPARE_LESS]     = depthLess,
+	[SRP_COMPARE_LEQUAL]   = depthLEqual,
+	[SRP_COMPARE_GREATER]  = depthGreater,
+	[SRP_COMPARE_GEQUAL]   = depthGEqual,
+	[SRP_COMPARE_EQUAL]    = depthEqual,
+	[SRP_COMPARE_NOTEQUAL] = depthNotEqual
+};
+
+static const StencilCompareFunc stencilCompareFuncs[] = {
+	[SRP_COMPARE_NEVER]    = stencilNever,
+	[SRP_COMPARE_ALWAYS]   = stencilAlways,
+	[SRP_COMPARE_LESS]     = stencilLess,
+	[SRP_COMPARE_LEQUAL]   = stencilLEqual,
+	[SRP_COMPARE_GREATER]  = stencilGreater,
+	[SRP_COMPARE_GEQUAL]   = stencilGEqual,
+	[SRP_COMPARE_EQUAL]    = stencilEqual,
+	[SRP_COMPARE_NOTEQUAL] = stencilNotEqual
+};
+
+static uint8_t stencilKeep(uint8_t stored, uint8_t ref)     { return stored; }
+static uint8_t stencilZero(uint8_t stored, uint8_t ref)     { return 0; }
+static uint8_t stencilReplace(uint8_t stored, uint8_t ref)  { return ref; }
+static uint8_t stencilIncr(uint8_t stored, uint8_t ref)     { return (stored < 255) ? stored + 1 : 255; }
+static uint8_t stencilIncrWrap(uint8_t stored, uint8_t ref) { return stored + 1; }
+static uint8_t stencilDecr(uint8_t stored, uint8_t ref)     { return (stored > 0) ? stored - 1 : 0; }
+static uint8_t stencilDecrWrap(uint8_t stored, uint8_t ref) { return stored - 1; }
+static uint8_t stencilInvert(uint8_t stored, uint8_t ref)   { return ~stored; }
+
+static const StencilOpFunc stencilOpFuncs[] = {
+	[SRP_STENCIL_KEEP]      = stencilKeep,
+	[SRP_STENCIL_ZERO]      = stencilZero,
+	[SRP_STENCIL_REPLACE]   = stencilReplace,
+	[SRP_STENCIL_INCR]      = stencilIncr,
+	[SRP_STENCIL_INCR_WRAP] = stencilIncrWrap,
+	[SRP_STENCIL_DECR]      = stencilDecr,
+	[SRP_STENCIL_DECR_WRAP] = stencilDecrWrap,
+	[SRP_STENCIL_INVERT]    = stencilInvert
+};
+
+/** Check if an enum value is in [0, max] interval, send an error message if not
+ *  @param[in] value The value to check
+ *  @param[in] max The last valid value of the enum
+ *  @param[in] name The name of the field, used in the message
+ *  @return `true` if valid, `false` otherwise */
+static bool validateEnum(int value, int max, const char* name);
+
+/** Validate the shader program, sending an error message if it is invalid
+ *  @param[in] sp The shader program to validate
+ *  @return `true` if valid, `false` otherwise */
+static bool validateShaderProgram(const SRPShaderProgram* sp);
+
+/** Validate and resolve the stencil state of one face
+ *  @param[out] out Resolved face state
+ *  @param[in] in Face state to resolve
+ *  @return `true` if valid, `false` otherwise */
+static bool resolveStencilFace(PipelineStencilFace* out, const SRPStencilFaceState* in);
+
+SRPPipeline* srpNewPipeline(const SRPPipelineState* state)
+{
+	SRPPipeline* this = SRP_MALLOC(sizeof(SRPPipeline));
+	if (!pipelineInit(this, state))
+	{
+		SRP_FREE(this);
+		return NULL;
+	}
+	return this;
+}
+
+void srpFreePipeline(SRPPipeline* this)
+{
+	SRP_FREE(this);
+}
+
+bool pipelineInit(SRPPipeline* this, const SRPPipelineState* state)
+{
+	bool valid = true;
+	this->state = *state;
+	this->sp = state->shaderProgram;
+
+	if (state->shaderProgram != NULL)
+		valid &= validateShaderProgram(state->shaderProgram);
+
+	valid &= validateEnum(
+		state->provokingVertexMode, SRP_PROVOKING_VERTEX_LAST, "provokingVertexMode"
+	);
+	this->provokingFirst = state->provokingVertexMode == SRP_PROVOKING_VERTEX_FIRST;
+
+	const SRPRasterState* raster = &state->raster;
+	valid &= validateEnum(raster->frontFace, SRP_WINDING_CW, "raster.frontFace");
+	valid &= validateEnum(raster->cullFace, SRP_FACE_FRONT_AND_BACK, "raster.cullFace");
+	valid &= validateEnum(raster->polygonMode, SRP_POLYGON_MODE_POINT, "raster.polygonMode");
+	if (!(raster->pointSize > 0))  // Also catches NaN
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Point size must be positive (got %f)\n", raster->pointSize
+		);
+		valid = false;
+	}
+	if (!(raster->lineWidth > 0))
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Line width must be positive (got %f)\n", raster->lineWidth
+		);
+		valid = false;
+	}
+	this->frontFaceCCW = raster->frontFace == SRP_WINDING_CCW;
+	this->cullFront = raster->cullFace == SRP_FACE_FRONT || raster->cullFace == SRP_FACE_FRONT_AND_BACK;
+	this->cullBack = raster->cullFace == SRP_FACE_BACK || raster->cullFace == SRP_FACE_FRONT_AND_BACK;
+
+	const SRPScissorState* scissor = &state->scissor;
+	if (scissor->enabled)
+	{
+		this->scissorMinX = scissor->x;
+		this->scissorMaxX = scissor->x + scissor->width;
+		this->scissorMinY = scissor->y;
+		this->scissorMaxY = scissor->y + scissor->height;
+	}
+	else
+	{
+		this->scissorMinX = 0;
+		this->scissorMaxX = SIZE_MAX;
+		this->scissorMinY = 0;
+		this->scissorMaxY = SIZE_MAX;
+	}
+
+	this->stencilEnabled = state->stencil.enabled;
+	valid &= resolveStencilFace(&this->stencil[0], &state->stencil.front);
+	valid &= resolveStencilFace(&this->stencil[1], &state->stencil.back);
+
+	const SRPDepthState* depth = &state->depth;
+	if (validateEnum(depth->compareOp, SRP_COMPARE_NOTEQUAL, "depth.compareOp"))
+		this->depthTest = (depth->testEnable) ? depthTestFuncs[depth->compareOp] : depthAlways;
+	else
+		valid = false;
+	// Cannot write when not testing (mimicking OpenGL behaviour)
+	this->depthWrite = depth->testEnable && depth->writeEnable;
+
+	return valid;
+}
+
+static bool validateEnum(int value, int max, const char* name)
+{
+	if (value >= 0 && value <= max)
+		return true;
+
+	srpMessageCallbackHelper(
+		SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+		"Invalid value of `%s` (%i)\n", name, value
+	);
+	return false;
+}
+
+static bool validateShaderProgram(const SRPShaderProgram* sp)
+{
+	const char* error = NULL;
+	if (sp->vs == NULL || sp->vs->shader == NULL)
+		error = "Shader program has no vertex shader\n";
+	else if (sp->fs == NULL || sp->fs->shader == NULL)
+		error = "Shader program has no fragment shader\n";
+	else if (sp->vs->nVaryings > 0 && sp->vs->varyingsInfo == NULL)
+		error = "Vertex shader has varyings, but `varyingsInfo` is NULL\n";
+
+	if (error == NULL)
+		return true;
+
+	srpMessageCallbackHelper(SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__, error);
+	return false;
+}
+
+static bool resolveStencilFace(PipelineStencilFace* out, const SRPStencilFaceState* in)
+{
+	bool valid = true;
+	valid &= validateEnum(in->func, SRP_COMPARE_NOTEQUAL, "stencil.func");
+	valid &= validateEnum(in->sfailOp, SRP_STENCIL_INVERT, "stencil.sfailOp");
+	valid &= validateEnum(in->dfailOp, SRP_STENCIL_INVERT, "stencil.dfailOp");
+	valid &= validateEnum(in->passOp, SRP_STENCIL_INVERT, "stencil.passOp");
+	if (!valid)
+		return false;
+
+	*out = (PipelineStencilFace) {
+		.compare = stencilCompareFuncs[in->func],
+		.ref = in->ref,
+		.mask = in->mask,
+		.maskedRef = in->ref & in->mask,
+		.writeMask = in->writeMask,
+		.sfailOp = stencilOpFuncs[in->sfailOp],
+		.dfailOp = stencilOpFuncs[in->dfailOp],
+		.passOp = stencilOpFuncs[in->passOp]
+	};
+	return true;
+}
+
+/** @} */  // ingroup Context_internal
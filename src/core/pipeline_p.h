@@ -0,0 +1,67 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Context_internal
+ *  Private header for `include/srp/pipeline.h` */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "srp/pipeline.h"
+
+/** @ingroup Context_internal
+ *  @{ */
+
+/** Depth comparison specialized for one SRPCompareOp */
+typedef bool (*DepthTestFunc)(float incoming, float stored);
+/** Stencil comparison specialized for one SRPCompareOp. Takes masked values */
+typedef bool (*StencilCompareFunc)(uint8_t ref, uint8_t stored);
+/** Stencil update specialized for one SRPStencilOp */
+typedef uint8_t (*StencilOpFunc)(uint8_t stored, uint8_t ref);
+
+/** Stencil state of one face, resolved to function pointers */
+typedef struct PipelineStencilFace
+{
+	StencilCompareFunc compare;  /**< Comparison function */
+	uint8_t ref;                 /**< The reference value */
+	uint8_t mask;                /**< Mask for the comparison */
+	uint8_t maskedRef;           /**< `ref & mask`, precomputed */
+	uint8_t writeMask;           /**< Mask for writing to the buffer */
+	StencilOpFunc sfailOp;       /**< Action if stencil test fails */
+	StencilOpFunc dfailOp;       /**< Action if stencil test passes but depth test fails */
+	StencilOpFunc passOp;        /**< Action if both stencil and depth tests pass */
+} PipelineStencilFace;
+
+struct SRPPipeline
+{
+	SRPPipelineState state;      /**< Copy of the state the pipeline was created from */
+	const SRPShaderProgram* sp;  /**< The shader program used by the draw call */
+
+	bool provokingFirst;         /**< Whether the first vertex is the provoking one */
+	bool cullFront;              /**< Whether front-facing triangles are culled */
+	bool cullBack;               /**< Whether back-facing triangles are culled */
+	bool frontFaceCCW;           /**< Whether CCW triangles are front-facing */
+
+	/** Scissor box, exclusive upper bounds. Covers everything when the test is disabled */
+	size_t scissorMinX, scissorMaxX, scissorMinY, scissorMaxY;
+
+	bool stencilEnabled;              /**< Whether the stencil test is enabled */
+	PipelineStencilFace stencil[2];   /**< Front (0) and back (1) stencil state */
+
+	/** Depth comparison. Always passes if the depth test is disabled */
+	DepthTestFunc depthTest;
+	/** Whether the passed fragments' depth should be written */
+	bool depthWrite;
+};
+
+/** Validate the state and initialize a pipeline from it. Sends an error
+ *  message for every invalid field
+ *  @param[out] this The pipeline to initialize
+ *  @param[in] state The state to bake into the pipeline
+ *  @return `true` if the state is valid, `false` otherwise (`this` is
+ *          left in undefined state) */
+bool pipelineInit(SRPPipeline* this, const SRPPipelineState* state);
+
+/** @} */  // ingroup Context_internal
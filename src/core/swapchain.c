@@ -0,0 +1,162 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Framebuffer_internal
+ *  SRPSwapchain implementation */
+
+#include "core/swapchain_p.h"
+#include "utils/defines.h"
+#include "utils/message_callback_p.h"
+
+/** @ingroup Framebuffer_internal
+ *  @{ */
+
+/** Entry point of the presentation thread
+ *  @param[in] arg Pointer to the SRPSwapchain
+ *  @return Always 0 */
+static int swapchainMain(void* arg);
+
+SRPSwapchain* srpNewSwapchain(
+	size_t width, size_t height, SRPColorFormat format, size_t nImages,
+	SRPPresentFunc present, void* userData
+)
+{
+	if (nImages < 2)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"A swap chain needs at least 2 framebuffers (got %zu)\n", nImages
+		);
+		return NULL;
+	}
+
+	SRPFramebuffer* first = srpNewFramebufferFormat(width, height, format);
+	if (first == NULL)
+		return NULL;
+
+	SRPSwapchain* this = SRP_MALLOC(sizeof(SRPSwapchain));
+	this->nImages = nImages;
+	this->images = SRP_MALLOC(sizeof(SRPFramebuffer*) * nImages);
+	this->available = SRP_MALLOC(sizeof(size_t) * nImages);
+	this->pending = SRP_MALLOC(sizeof(PendingFrame) * nImages);
+	for (size_t i = 0; i < nImages; i++)
+	{
+		this->images[i] = (i == 0) ? first : srpNewFramebufferFormat(width, height, format);
+		this->available[i] = i;
+	}
+	this->availableHead = 0;
+	this->nAvailable = nImages;
+	this->pendingHead = 0;
+	this->nPending = 0;
+	this->presenting = false;
+	this->nPresented = 0;
+	this->stop = false;
+	this->present = present;
+	this->userData = userData;
+	mtx_init(&this->lock, mtx_plain);
+	cnd_init(&this->changed);
+	thrd_create(&this->thread, swapchainMain, this);
+	return this;
+}
+
+void srpFreeSwapchain(SRPSwapchain* this)
+{
+	mtx_lock(&this->lock);
+	this->stop = true;
+	cnd_broadcast(&this->changed);
+	mtx_unlock(&this->lock);
+	thrd_join(this->thread, NULL);
+
+	for (size_t i = 0; i < this->nImages; i++)
+		srpFreeFramebuffer(this->images[i]);
+	mtx_destroy(&this->lock);
+	cnd_destroy(&this->changed);
+	SRP_FREE(this->images);
+	SRP_FREE(this->available);
+	SRP_FREE(this->pending);
+	SRP_FREE(this);
+}
+
+SRPFramebuffer* srpSwapchainAcquire(SRPSwapchain* this)
+{
+	mtx_lock(&this->lock);
+	while (this->nAvailable == 0)
+		cnd_wait(&this->changed, &this->lock);
+	const size_t image = this->available[this->availableHead];
+	this->availableHead = (this->availableHead + 1) % this->nImages;
+	this->nAvailable--;
+	mtx_unlock(&this->lock);
+	return this->images[image];
+}
+
+void srpSwapchainPresent(SRPSwapchain* this, SRPContext* ctx, SRPFramebuffer* fb)
+{
+	size_t image = 0;
+	while (image < this->nImages && this->images[image] != fb)
+		image++;
+	if (image == this->nImages)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"The framebuffer does not belong to the swap chain\n"
+		);
+		return;
+	}
+
+	// Created before taking the lock: it may have to wait for the render thread
+	SRPFence* fence = srpNewFence(ctx);
+
+	mtx_lock(&this->lock);
+	const size_t tail = (this->pendingHead + this->nPending) % this->nImages;
+	this->pending[tail] = (PendingFrame) {
+		.image = image,
+		.fence = fence,
+		.frame = this->nPresented++
+	};
+	this->nPending++;
+	cnd_broadcast(&this->changed);
+	mtx_unlock(&this->lock);
+}
+
+void srpSwapchainWaitIdle(SRPSwapchain* this)
+{
+	mtx_lock(&this->lock);
+	while (this->nPending > 0 || this->presenting)
+		cnd_wait(&this->changed, &this->lock);
+	mtx_unlock(&this->lock);
+}
+
+static int swapchainMain(void* arg)
+{
+	SRPSwapchain* this = (SRPSwapchain*) arg;
+	mtx_lock(&this->lock);
+	while (true)
+	{
+		while (this->nPending == 0 && !this->stop)
+			cnd_wait(&this->changed, &this->lock);
+		if (this->nPending == 0)
+			break;
+
+		const PendingFrame frame = this->pending[this->pendingHead];
+		this->pendingHead = (this->pendingHead + 1) % this->nImages;
+		this->nPending--;
+		this->presenting = true;
+		mtx_unlock(&this->lock);
+
+		// The frame may still be rendered by the context's render thread
+		srpFreeFence(frame.fence);
+		this->present(this->images[frame.image], frame.frame, this->userData);
+
+		mtx_lock(&this->lock);
+		const size_t tail = (this->availableHead + this->nAvailable) % this->nImages;
+		this->available[tail] = frame.image;
+		this->nAvailable++;
+		this->presenting = false;
+		cnd_broadcast(&this->changed);
+	}
+	mtx_unlock(&this->lock);
+	return 0;
+}
+
+/** @} */  // ingroup Framebuffer_internal
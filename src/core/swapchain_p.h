@@ -0,0 +1,48 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Framebuffer_internal
+ *  Private header for `include/srp/swapchain.h` */
+
+#pragma once
+
+#include <stdbool.h>
+#include <threads.h>
+#include "srp/swapchain.h"
+#include "srp/fence.h"
+
+/** @ingroup Framebuffer_internal
+ *  @{ */
+
+/** A frame waiting for presentation */
+typedef struct PendingFrame
+{
+	size_t image;     /**< Index of the framebuffer */
+	SRPFence* fence;  /**< Signaled once the frame is rendered */
+	size_t frame;     /**< Index of the frame */
+} PendingFrame;
+
+struct SRPSwapchain
+{
+	SRPFramebuffer** images;  /**< The framebuffers */
+	size_t nImages;           /**< Amount of framebuffers */
+	SRPPresentFunc present;   /**< The function presenting the framebuffers */
+	void* userData;           /**< User pointer passed to `present` */
+	thrd_t thread;            /**< The presentation thread */
+	mtx_t lock;               /**< Protects everything below */
+	cnd_t changed;            /**< Broadcasted on every change of the queues */
+	/** Ring buffer of the indices of framebuffers available for acquisition,
+	 *  in the order they became available */
+	size_t* available;
+	size_t availableHead;     /**< Index of the oldest entry of `available` */
+	size_t nAvailable;        /**< Amount of entries in `available` */
+	PendingFrame* pending;    /**< Ring buffer of the frames to present */
+	size_t pendingHead;       /**< Index of the oldest entry of `pending` */
+	size_t nPending;          /**< Amount of entries in `pending` */
+	bool presenting;          /**< Whether a frame is being presented */
+	size_t nPresented;        /**< Amount of frames queued for presentation so far */
+	bool stop;                /**< Whether the thread should exit once drained */
+};
+
+/** @} */  // ingroup Framebuffer_internal
@@ -17,6 +17,7 @@
 #include "utils/voidptr.h"
 #include "srp/vec.h"
 #include "core/texture_p.h"
+#include "core/color_p.h"
 
 /** @ingroup Texture_internal
  *  @{ */
@@ -44,6 +45,7 @@ SRPTexture* srpNewTexture(
 	this->heightMinusOne = this->height - 1;
 	this->wrappingModeX = wrappingModeX;
 	this->wrappingModeY = wrappingModeY;
+	this->srgb = false;
 	return this;
 }
 
@@ -73,6 +75,14 @@ void srpTextureGetFilteredColor(
 	uint8_t* start = \
 		INDEX_VOID_PTR(this->data, xi + yi * this->width, N_CHANNELS_REQUESTED);
 	const float inv255 = 1. / 255.;
+	if (this->srgb)
+	{
+		out[0] = colorSrgbDecodeTable[start[0]];
+		out[1] = colorSrgbDecodeTable[start[1]];
+		out[2] = colorSrgbDecodeTable[start[2]];
+		out[3] = (N_CHANNELS_REQUESTED == 3) ? 1. : (start[3] * inv255);
+		return;
+	}
 	out[0] = start[0] * inv255;
 	out[1] = start[1] * inv255;
 	out[2] = start[2] * inv255;
@@ -88,6 +98,8 @@ int srpTextureGet(SRPTexture* this, SRPTextureParameter parameter)
 		return this->wrappingModeX;
 	case SRP_TEXTURE_WRAPPING_MODE_Y:
 		return this->wrappingModeY;
+	case SRP_TEXTURE_SRGB:
+		return this->srgb;
 	default:
 		srpMessageCallbackHelper(
 			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
@@ -127,6 +139,11 @@ void srpTextureSet(SRPTexture* this, SRPTextureParameter parameter, int data)
 				);
 		}
 		return;
+	case SRP_TEXTURE_SRGB:
+		if (data)
+			colorInitSrgbTables();
+		this->srgb = data;
+		return;
 	default:
 		srpMessageCallbackHelper(
 			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
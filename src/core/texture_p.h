@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include "srp/texture.h"
 
 /** @ingroup Texture_internal
@@ -21,6 +22,7 @@ struct SRPTexture
 	int heightMinusOne;  /**< Precomputed for optimization */
 	SRPTextureWrappingMode wrappingModeX;  /**< Wrapping mode for X axis */
 	SRPTextureWrappingMode wrappingModeY;  /**< Wrapping mode for Y axis */
+	bool srgb;           /**< Whether the texels are sRGB-encoded */
 };
 
 /** @} */  // ingroup Texture_internal
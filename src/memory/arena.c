@@ -6,6 +6,7 @@
  *  SRPArena and related functions implementation */
 
 #include <string.h>
+#include <stdint.h>
 #include "memory/arena_p.h"
 #include "utils/defines.h"
 #include "utils/voidptr.h"
@@ -85,6 +86,13 @@ void* arenaAlloc(SRPArena* this, size_t size)
     return ptr;
 }
 
+void* arenaAllocAligned(SRPArena* this, size_t size, size_t alignment)
+{
+    // Blocks are only 8-byte aligned, so over-allocate and align the pointer
+    const uintptr_t ptr = (uintptr_t) arenaAlloc(this, size + alignment - 1);
+    return (void*) ((ptr + alignment - 1) & ~(uintptr_t) (alignment - 1));
+}
+
 void* arenaCalloc(SRPArena* this, size_t size)
 {
     void* ptr = arenaAlloc(this, size);
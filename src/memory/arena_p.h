@@ -8,7 +8,6 @@
 #pragma once
 
 #include <stddef.h>
-#include "srp/context.h"
 
 /** @ingroup Memory_allocation
  *  @{ */
@@ -46,6 +45,14 @@ void freeArena(SRPArena* this);
  *  @return Pointer to the allocated block */
 void* arenaAlloc(SRPArena* this, size_t size);
 
+/** Allocate a block of memory in the arena with a stricter alignment than
+ *  arenaAlloc() guarantees
+ *  @param[in] this Pointer to the arena
+ *  @param[in] size Size of the block to allocate in bytes
+ *  @param[in] alignment Alignment of the block in bytes, a power of two
+ *  @return Pointer to the allocated block */
+void* arenaAllocAligned(SRPArena* this, size_t size, size_t alignment);
+
 /** Allocate a block of memory in the arena, initializing the memory to zero
  *  @param[in] this Pointer to the arena
  *  @param[in] size Size of the block to allocate in bytes
@@ -56,9 +63,4 @@ void* arenaCalloc(SRPArena* this, size_t size);
  *  @param[in] this Pointer to the arena */
 void arenaReset(SRPArena* this);
 
-// Macros to manipulate context-stored arena
-#define ARENA_ALLOC(size) (arenaAlloc(srpContext.arena, (size)))
-#define ARENA_CALLOC(size) (arenaCalloc(srpContext.arena, (size)))
-#define ARENA_RESET() (arenaReset(srpContext.arena))
-
 /** @} */  // ingroup Memory_allocation
@@ -0,0 +1,188 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  NUMA topology, thread pinning and memory placement implementation.
+ *  Talks to the Linux kernel directly (sysfs and raw system calls), so
+ *  that libnuma is not required. On other systems everything is a no-op */
+
+#ifdef __linux__
+	#define _GNU_SOURCE
+	#include <sched.h>
+	#include <stdio.h>
+	#include <stdint.h>
+	#include <unistd.h>
+	#include <sys/syscall.h>
+	#include <threads.h>
+#endif
+
+#include "parallel/numa.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+#ifdef __linux__
+
+/** Memory policy modes and flags of mbind(2), from <linux/mempolicy.h> */
+#define MPOL_DEFAULT 0
+#define MPOL_BIND 2
+#define MPOL_INTERLEAVE 3
+#define MPOL_MF_MOVE (1 << 1)
+
+/** Read a list of ranges like "0-3,8,10-11" as used by sysfs
+ *  @param[in] path Path of the file to read
+ *  @param[out] set The set to add the listed items to
+ *  @param[out] maxItem Greatest listed item, may be NULL
+ *  @return `false` if the file could not be read, `true` otherwise */
+static bool readSysfsList(const char* path, cpu_set_t* set, size_t* maxItem);
+
+/** Call mbind(2) on the pages fully inside a range
+ *  @return `true` on success or if the range has no full pages, `false` otherwise */
+static bool mbindRange(void* addr, size_t size, int mode, unsigned long nodemask);
+
+/** Amount of nodes, read once from sysfs by readNodeCount() */
+static size_t nodeCount;
+static once_flag nodeCountOnce = ONCE_FLAG_INIT;
+
+/** Fill `nodeCount`. Called through `call_once()` */
+static void readNodeCount(void);
+
+size_t numaNodeCount(void)
+{
+	// Called per buffer and tile row when placing framebuffers, and per draw
+	call_once(&nodeCountOnce, readNodeCount);
+	return nodeCount;
+}
+
+static void readNodeCount(void)
+{
+	cpu_set_t nodes;
+	size_t maxNode;
+	if (!readSysfsList("/sys/devices/system/node/online", &nodes, &maxNode))
+		nodeCount = 1;
+	else
+		nodeCount = (maxNode + 1 < NUMA_MAX_NODES) ? maxNode + 1 : NUMA_MAX_NODES;
+}
+
+bool numaPinCurrentThread(size_t node)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node);
+	cpu_set_t cpus;
+	if (!readSysfsList(path, &cpus, NULL) || CPU_COUNT(&cpus) == 0)
+		return false;
+	// 0 is the calling thread, not the whole process
+	return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+bool numaInterleave(void* addr, size_t size)
+{
+	const size_t nNodes = numaNodeCount();
+	if (nNodes < 2)
+		return true;
+	const unsigned long all = (nNodes == 64) ? ~0ul : (1ul << nNodes) - 1;
+	return mbindRange(addr, size, MPOL_INTERLEAVE, all);
+}
+
+bool numaBind(void* addr, size_t size, size_t node)
+{
+	if (node >= NUMA_MAX_NODES)
+		return false;
+	if (numaNodeCount() < 2)
+		return true;
+	return mbindRange(addr, size, MPOL_BIND, 1ul << node);
+}
+
+bool numaResetPlacement(void* addr, size_t size)
+{
+	if (numaNodeCount() < 2)
+		return true;
+	// The default policy takes an empty node mask
+	return mbindRange(addr, size, MPOL_DEFAULT, 0);
+}
+
+static bool readSysfsList(const char* path, cpu_set_t* set, size_t* maxItem)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+
+	CPU_ZERO(set);
+	size_t max = 0;
+	unsigned long first, last;
+	while (fscanf(file, "%lu", &first) == 1)
+	{
+		last = first;
+		int c = fgetc(file);
+		if (c == '-')
+		{
+			if (fscanf(file, "%lu", &last) != 1)
+				break;
+			c = fgetc(file);
+		}
+		for (unsigned long i = first; i <= last && i < CPU_SETSIZE; i++)
+			CPU_SET(i, set);
+		if (last > max)
+			max = last;
+		if (c != ',')
+			break;
+	}
+	fclose(file);
+
+	if (maxItem != NULL)
+		*maxItem = max;
+	return true;
+}
+
+static bool mbindRange(void* addr, size_t size, int mode, unsigned long nodemask)
+{
+	const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+	const uintptr_t begin = ((uintptr_t) addr + pageSize - 1) & ~(pageSize - 1);
+	const uintptr_t end = ((uintptr_t) addr + size) & ~(pageSize - 1);
+	if (end <= begin)
+		return true;
+
+	// The kernel reads `maxnode - 1` bits of the mask
+	long result = syscall(
+		SYS_mbind, (void*) begin, end - begin, mode, &nodemask,
+		(unsigned long) NUMA_MAX_NODES + 1, MPOL_MF_MOVE
+	);
+	return result == 0;
+}
+
+#else  // __linux__
+
+size_t numaNodeCount(void)
+{
+	return 1;
+}
+
+bool numaPinCurrentThread(size_t node)
+{
+	return false;
+}
+
+bool numaInterleave(void* addr, size_t size)
+{
+	return true;
+}
+
+bool numaBind(void* addr, size_t size, size_t node)
+{
+	return true;
+}
+
+bool numaResetPlacement(void* addr, size_t size)
+{
+	return true;
+}
+
+#endif  // __linux__
+
+size_t numaPartitionNode(size_t index, size_t count, size_t nNodes)
+{
+	return index * nNodes / count;
+}
+
+/** @} */  // ingroup Parallel
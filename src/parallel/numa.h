@@ -0,0 +1,62 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  NUMA topology, thread pinning and memory placement */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Maximal amount of NUMA nodes taken into account */
+#define NUMA_MAX_NODES 64
+
+/** Get the amount of NUMA nodes of the machine. Nodes are assumed to be
+ *  numbered consecutively from 0. The topology is read once per process;
+ *  thread-safe
+ *  @return Amount of nodes, 1 if the topology is unknown or not NUMA */
+size_t numaNodeCount(void);
+
+/** Get the node that a part of a partitioned range belongs to. A range of
+ *  `count` parts is split into `nNodes` contiguous bands of nearly equal size
+ *  @param[in] index Index of the part, in [0, count)
+ *  @param[in] count Amount of parts
+ *  @param[in] nNodes Amount of nodes
+ *  @return Index of the node */
+size_t numaPartitionNode(size_t index, size_t count, size_t nNodes);
+
+/** Restrict the calling thread to the CPUs of a node
+ *  @param[in] node Index of the node
+ *  @return `true` on success, `false` if not supported or failed */
+bool numaPinCurrentThread(size_t node);
+
+/** Spread the pages of a memory range round-robin across all the nodes,
+ *  migrating the already allocated ones. Only the pages fully inside the
+ *  range are affected
+ *  @param[in] addr Start of the range
+ *  @param[in] size Size of the range, in bytes
+ *  @return `true` on success or if there is a single node, `false` if failed */
+bool numaInterleave(void* addr, size_t size);
+
+/** Place the pages of a memory range on a node, migrating the already
+ *  allocated ones. Only the pages fully inside the range are affected
+ *  @param[in] addr Start of the range
+ *  @param[in] size Size of the range, in bytes
+ *  @param[in] node Index of the node
+ *  @return `true` on success or if there is a single node, `false` if failed */
+bool numaBind(void* addr, size_t size, size_t node);
+
+/** Undo numaInterleave() and numaBind(), so that the pages of a memory range
+ *  follow the policy of the calling thread again. Already allocated pages
+ *  stay where they are
+ *  @param[in] addr Start of the range
+ *  @param[in] size Size of the range, in bytes
+ *  @return `true` on success or if there is a single node, `false` if failed */
+bool numaResetPlacement(void* addr, size_t size);
+
+/** @} */  // ingroup Parallel
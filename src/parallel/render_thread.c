@@ -0,0 +1,191 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Background render thread implementation */
+
+#include <string.h>
+#include "parallel/render_thread.h"
+#include "utils/defines.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Initial capacity of the command queue */
+#define INITIAL_QUEUE_CAPACITY 64
+
+/** Entry point of the render thread
+ *  @param[in] arg Pointer to the RenderThread
+ *  @return Always 0 */
+static int renderThreadMain(void* arg);
+
+/** Push a command to the back of the queue, growing it if needed.
+ *  Must be called with the lock held
+ *  @param[in] this Pointer to the render thread
+ *  @param[in] command The command to push */
+static void pushCommand(RenderThread* this, const RenderCommand* command);
+
+/** Get a reset snapshot arena, reusing a retired one if possible.
+ *  Must be called with the lock held
+ *  @param[in] this Pointer to the render thread
+ *  @return Pointer to the arena */
+static SRPArena* acquireSnapshotArena(RenderThread* this);
+
+RenderThread* newRenderThread(SRPContext* ctx)
+{
+	RenderThread* this = SRP_MALLOC(sizeof(RenderThread));
+	this->ctx = ctx;
+	mtx_init(&this->lock, mtx_plain);
+	cnd_init(&this->notEmpty);
+	cnd_init(&this->idle);
+	this->capacity = INITIAL_QUEUE_CAPACITY;
+	this->commands = SRP_MALLOC(sizeof(RenderCommand) * this->capacity);
+	this->head = 0;
+	this->count = 0;
+	this->busy = false;
+	this->stop = false;
+	this->nSnapshots = 0;
+	this->freeSnapshots = NULL;
+	this->nFreeSnapshots = 0;
+	this->snapshots = acquireSnapshotArena(this);
+	this->snapshotsUsed = false;
+	thrd_create(&this->thread, renderThreadMain, this);
+	return this;
+}
+
+void freeRenderThread(RenderThread* this)
+{
+	mtx_lock(&this->lock);
+	this->stop = true;
+	cnd_signal(&this->notEmpty);
+	mtx_unlock(&this->lock);
+	thrd_join(this->thread, NULL);
+
+	// All the retired arenas are back in the free list at this point
+	freeArena(this->snapshots);
+	for (size_t i = 0; i < this->nFreeSnapshots; i++)
+		freeArena(this->freeSnapshots[i]);
+	SRP_FREE(this->freeSnapshots);
+	mtx_destroy(&this->lock);
+	cnd_destroy(&this->notEmpty);
+	cnd_destroy(&this->idle);
+	SRP_FREE(this->commands);
+	SRP_FREE(this);
+}
+
+void renderThreadSubmitDraw(RenderThread* this, const DrawCommand* draw)
+{
+	RenderCommand command = {.type = RENDER_COMMAND_DRAW, .draw = *draw};
+	SRPShaderProgram* sp = &command.draw.sp;
+
+	mtx_lock(&this->lock);
+	if (sp->uniform != NULL && sp->uniformSize > 0)
+	{
+		// Nothing in flight references the snapshots, so they may be reused
+		if (this->count == 0 && !this->busy)
+			arenaReset(this->snapshots);
+
+		void* snapshot = arenaAlloc(this->snapshots, sp->uniformSize);
+		memcpy(snapshot, sp->uniform, sp->uniformSize);
+		sp->uniform = (SRPUniform*) snapshot;
+		this->snapshotsUsed = true;
+	}
+	pushCommand(this, &command);
+	mtx_unlock(&this->lock);
+}
+
+void renderThreadSubmitFence(RenderThread* this, SRPFence* fence)
+{
+	RenderCommand command = {.type = RENDER_COMMAND_FENCE, .fence = fence, .snapshots = NULL};
+	mtx_lock(&this->lock);
+	if (this->snapshotsUsed)
+	{
+		// Retire the snapshots to be reused after the fence is passed
+		command.snapshots = this->snapshots;
+		this->snapshots = acquireSnapshotArena(this);
+		this->snapshotsUsed = false;
+	}
+	pushCommand(this, &command);
+	mtx_unlock(&this->lock);
+}
+
+void renderThreadFinish(RenderThread* this)
+{
+	mtx_lock(&this->lock);
+	while (this->count > 0 || this->busy)
+		cnd_wait(&this->idle, &this->lock);
+	mtx_unlock(&this->lock);
+}
+
+static int renderThreadMain(void* arg)
+{
+	RenderThread* this = (RenderThread*) arg;
+
+	mtx_lock(&this->lock);
+	while (true)
+	{
+		while (this->count == 0 && !this->stop)
+			cnd_wait(&this->notEmpty, &this->lock);
+		if (this->count == 0)  // Stop requested and everything is executed
+			break;
+
+		RenderCommand command = this->commands[this->head];
+		this->head = (this->head + 1) % this->capacity;
+		this->count--;
+		this->busy = true;
+		mtx_unlock(&this->lock);
+
+		if (command.type == RENDER_COMMAND_DRAW)
+			executeDraw(this->ctx, &command.draw);
+
+		mtx_lock(&this->lock);
+		if (command.type == RENDER_COMMAND_FENCE)
+		{
+			if (command.snapshots != NULL)
+			{
+				arenaReset(command.snapshots);
+				this->freeSnapshots[this->nFreeSnapshots++] = command.snapshots;
+			}
+			fenceSignal(command.fence);
+		}
+		this->busy = false;
+		if (this->count == 0)
+			cnd_broadcast(&this->idle);
+	}
+	mtx_unlock(&this->lock);
+
+	return 0;
+}
+
+static void pushCommand(RenderThread* this, const RenderCommand* command)
+{
+	if (this->count == this->capacity)
+	{
+		// Unwrap the ring buffer into a twice as big one
+		RenderCommand* grown = SRP_MALLOC(sizeof(RenderCommand) * this->capacity * 2);
+		for (size_t i = 0; i < this->count; i++)
+			grown[i] = this->commands[(this->head + i) % this->capacity];
+		SRP_FREE(this->commands);
+		this->commands = grown;
+		this->capacity *= 2;
+		this->head = 0;
+	}
+
+	this->commands[(this->head + this->count) % this->capacity] = *command;
+	this->count++;
+	cnd_signal(&this->notEmpty);
+}
+
+static SRPArena* acquireSnapshotArena(RenderThread* this)
+{
+	if (this->nFreeSnapshots > 0)
+		return this->freeSnapshots[--this->nFreeSnapshots];
+
+	// Make sure every arena fits into the free list when it is retired
+	this->nSnapshots++;
+	this->freeSnapshots = SRP_REALLOC(this->freeSnapshots, sizeof(SRPArena*) * this->nSnapshots);
+	return newArena(SRP_DEFAULT_ARENA_CAPACITY);
+}
+
+/** @} */  // ingroup Parallel
@@ -0,0 +1,92 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Background render thread executing submitted commands in order */
+
+#pragma once
+
+#include <threads.h>
+#include "pipeline/draw.h"
+#include "core/fence_p.h"
+#include "memory/arena_p.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Type of a RenderCommand */
+typedef enum RenderCommandType
+{
+	RENDER_COMMAND_DRAW,  /**< Execute a draw call */
+	RENDER_COMMAND_FENCE  /**< Signal a fence */
+} RenderCommandType;
+
+/** A unit of work submitted to the RenderThread */
+typedef struct RenderCommand
+{
+	RenderCommandType type;  /**< Which of the union members is valid */
+	union {
+		/** The draw call, if `type == RENDER_COMMAND_DRAW` */
+		DrawCommand draw;
+		/** The fence and the arena holding uniform snapshots of the draw calls
+		 *  submitted before it (may be NULL), if `type == RENDER_COMMAND_FENCE` */
+		struct {
+			SRPFence* fence;
+			SRPArena* snapshots;
+		};
+	};
+} RenderCommand;
+
+/** Thread executing the commands of one context in submission order */
+typedef struct RenderThread
+{
+	SRPContext* ctx;          /**< The context whose resources are used */
+	thrd_t thread;            /**< The underlying thread */
+
+	/** Arena the uniform snapshots are copied to. Owned by the submitting
+	 *  thread and retired to the render thread with the next fence */
+	SRPArena* snapshots;
+	/** Whether anything was allocated in `snapshots` since it was retired */
+	bool snapshotsUsed;
+
+	mtx_t lock;               /**< Protects everything below */
+	cnd_t notEmpty;           /**< Signaled when a command is submitted */
+	cnd_t idle;               /**< Broadcasted when the queue gets drained */
+	RenderCommand* commands;  /**< Ring buffer of pending commands */
+	size_t capacity;          /**< Capacity of `commands` */
+	size_t head;              /**< Index of the oldest pending command */
+	size_t count;             /**< Amount of pending commands */
+	bool busy;                /**< Whether a command is being executed */
+	bool stop;                /**< Whether the thread should exit once drained */
+	SRPArena** freeSnapshots; /**< Reset snapshot arenas ready to be reused */
+	size_t nFreeSnapshots;    /**< Amount of arenas in `freeSnapshots` */
+	size_t nSnapshots;        /**< Amount of snapshot arenas ever created */
+} RenderThread;
+
+/** Create and start a render thread
+ *  @param[in] ctx The context to execute commands with. Its arena must not be
+ *                 used by anyone else while the thread is alive
+ *  @return Pointer to the render thread */
+RenderThread* newRenderThread(SRPContext* ctx);
+
+/** Execute all the pending commands, then stop and free the render thread
+ *  @param[in] this Pointer to the render thread, as returned from newRenderThread() */
+void freeRenderThread(RenderThread* this);
+
+/** Enqueue a draw call. If the shader program has `uniformSize` set, the
+ *  uniform is copied into storage that lives until the next fence is passed
+ *  @param[in] this Pointer to the render thread
+ *  @param[in] draw The draw call to copy into the queue */
+void renderThreadSubmitDraw(RenderThread* this, const DrawCommand* draw);
+
+/** Enqueue a fence that is signaled once all the previous commands are executed
+ *  @param[in] this Pointer to the render thread
+ *  @param[in] fence The fence to signal */
+void renderThreadSubmitFence(RenderThread* this, SRPFence* fence);
+
+/** Block until all the submitted commands are executed
+ *  @param[in] this Pointer to the render thread */
+void renderThreadFinish(RenderThread* this);
+
+/** @} */  // ingroup Parallel
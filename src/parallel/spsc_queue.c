@@ -0,0 +1,62 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Lock-free single-producer single-consumer queue implementation */
+
+#include <assert.h>
+#include <threads.h>
+#include "parallel/spsc_queue.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+void spscQueueInit(SPSCQueue* this, void** items, size_t capacity)
+{
+	assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+	this->items = items;
+	this->mask = capacity - 1;
+	atomic_init(&this->head, 0);
+	atomic_init(&this->tail, 0);
+}
+
+bool spscQueuePush(SPSCQueue* this, void* item)
+{
+	size_t tail = atomic_load_explicit(&this->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&this->head, memory_order_acquire);
+	if (tail - head > this->mask)  // Full
+		return false;
+
+	this->items[tail & this->mask] = item;
+	atomic_store_explicit(&this->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+bool spscQueuePop(SPSCQueue* this, void** item)
+{
+	size_t head = atomic_load_explicit(&this->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+	if (head == tail)  // Empty
+		return false;
+
+	*item = this->items[head & this->mask];
+	atomic_store_explicit(&this->head, head + 1, memory_order_release);
+	return true;
+}
+
+void spscQueuePushWait(SPSCQueue* this, void* item)
+{
+	while (!spscQueuePush(this, item))
+		thrd_yield();
+}
+
+void* spscQueuePopWait(SPSCQueue* this)
+{
+	void* item;
+	while (!spscQueuePop(this, &item))
+		thrd_yield();
+	return item;
+}
+
+/** @} */  // ingroup Parallel
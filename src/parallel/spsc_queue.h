@@ -0,0 +1,61 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Lock-free single-producer single-consumer queue */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Size of a cache line, used to keep the producer's and the consumer's
+ *  indices from sharing one */
+#define SPSC_CACHE_LINE 64
+
+/** Bounded lock-free queue of pointers with one producer and one consumer.
+ *  Both indices get a cache line of their own, also in arrays of queues, which
+ *  have to be allocated with SPSC_CACHE_LINE alignment */
+typedef struct SPSCQueue
+{
+	void** items;         /**< Ring buffer of the items */
+	size_t mask;          /**< `capacity - 1`, the capacity is a power of two */
+	/** Index of the next item to pop, written by the consumer */
+	_Alignas(SPSC_CACHE_LINE) atomic_size_t head;
+	/** Index of the next item to push, written by the producer */
+	_Alignas(SPSC_CACHE_LINE) atomic_size_t tail;
+} SPSCQueue;
+
+/** Initialize a queue
+ *  @param[out] this The queue to initialize
+ *  @param[in] items Storage for `capacity` items, owned by the caller
+ *  @param[in] capacity Maximal amount of queued items. Must be a power of two */
+void spscQueueInit(SPSCQueue* this, void** items, size_t capacity);
+
+/** Push an item. Must only be called by the producer
+ *  @param[in] this The queue
+ *  @param[in] item The item to push
+ *  @return `false` if the queue is full, `true` otherwise */
+bool spscQueuePush(SPSCQueue* this, void* item);
+
+/** Pop the oldest item. Must only be called by the consumer
+ *  @param[in] this The queue
+ *  @param[out] item The popped item
+ *  @return `false` if the queue is empty, `true` otherwise */
+bool spscQueuePop(SPSCQueue* this, void** item);
+
+/** Push an item, yielding the thread while the queue is full
+ *  @see spscQueuePush() */
+void spscQueuePushWait(SPSCQueue* this, void* item);
+
+/** Pop the oldest item, yielding the thread while the queue is empty
+ *  @see spscQueuePop()
+ *  @return The popped item */
+void* spscQueuePopWait(SPSCQueue* this);
+
+/** @} */  // ingroup Parallel
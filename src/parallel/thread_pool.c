@@ -0,0 +1,301 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Thread pool implementation */
+
+#include "parallel/thread_pool.h"
+#include "parallel/numa.h"
+#include "utils/defines.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Arguments of a worker thread */
+typedef struct WorkerArgs
+{
+	ThreadPool* pool;    /**< The pool the worker belongs to */
+	size_t threadIndex;  /**< Index of the worker, in [1, nThreads) */
+} WorkerArgs;
+
+/** Entry point of a worker thread
+ *  @param[in] arg Pointer to heap-allocated WorkerArgs, freed by the worker
+ *  @return Always 0 */
+static int workerMain(void* arg);
+
+/** Hand the current job over to the workers, take part in it and wait
+ *  until all the workers are done. Must be called with `submitLock` held
+ *  @param[in] this Pointer to the thread pool */
+static void runJob(ThreadPool* this);
+
+/** Claim and execute chunks of the current loop until none are left.
+ *  A ThreadPoolRunner
+ *  @param[in] this Pointer to the thread pool
+ *  @param[in] threadIndex Index of the executing thread */
+static void runChunks(ThreadPool* this, size_t threadIndex);
+
+/** Execute own tasks, then steal from other threads until no tasks are left.
+ *  A ThreadPoolRunner
+ *  @param[in] this Pointer to the thread pool
+ *  @param[in] threadIndex Index of the executing thread */
+static void runTasks(ThreadPool* this, size_t threadIndex);
+
+/** Execute the current ThreadFunc. A ThreadPoolRunner
+ *  @param[in] this Pointer to the thread pool
+ *  @param[in] threadIndex Index of the executing thread */
+static void runOnThread(ThreadPool* this, size_t threadIndex);
+
+/** Steal a task from any other thread
+ *  @param[in] this Pointer to the thread pool
+ *  @param[in] threadIndex Index of the stealing thread
+ *  @param[out] task The stolen task
+ *  @return `true` if a task was stolen, `false` if all the deques are empty */
+static bool stealTask(ThreadPool* this, size_t threadIndex, size_t* task);
+
+ThreadPool* newThreadPool(size_t nThreads, bool pin)
+{
+	ThreadPool* this = SRP_MALLOC(sizeof(ThreadPool));
+	this->nThreads = nThreads;
+	this->threadNodes = NULL;
+	if (pin)
+	{
+		const size_t nNodes = numaNodeCount();
+		this->threadNodes = SRP_MALLOC(sizeof(size_t) * nThreads);
+		for (size_t i = 0; i < nThreads; i++)
+			this->threadNodes[i] = numaPartitionNode(i, nThreads, nNodes);
+	}
+	mtx_init(&this->submitLock, mtx_plain);
+	mtx_init(&this->lock, mtx_plain);
+	cnd_init(&this->wake);
+	cnd_init(&this->done);
+	this->generation = 0;
+	this->nActive = 0;
+	this->stop = false;
+	this->runner = NULL;
+	this->data = NULL;
+	this->func = NULL;
+	this->count = 0;
+	this->grain = 1;
+	atomic_init(&this->next, 0);
+	this->taskFunc = NULL;
+	this->deques = SRP_MALLOC(sizeof(WorkDeque) * nThreads);
+	this->taskStorage = NULL;
+	this->taskCapacity = 0;
+	this->threadFunc = NULL;
+
+	this->workers = SRP_MALLOC(sizeof(thrd_t) * (nThreads - 1));
+	for (size_t i = 1; i < nThreads; i++)
+	{
+		WorkerArgs* args = SRP_MALLOC(sizeof(WorkerArgs));
+		*args = (WorkerArgs) {.pool = this, .threadIndex = i};
+		thrd_create(&this->workers[i-1], workerMain, args);
+	}
+	return this;
+}
+
+void freeThreadPool(ThreadPool* this)
+{
+	mtx_lock(&this->lock);
+	this->stop = true;
+	cnd_broadcast(&this->wake);
+	mtx_unlock(&this->lock);
+
+	for (size_t i = 1; i < this->nThreads; i++)
+		thrd_join(this->workers[i-1], NULL);
+
+	mtx_destroy(&this->submitLock);
+	mtx_destroy(&this->lock);
+	cnd_destroy(&this->wake);
+	cnd_destroy(&this->done);
+	SRP_FREE(this->taskStorage);
+	SRP_FREE(this->deques);
+	SRP_FREE(this->threadNodes);
+	SRP_FREE(this->workers);
+	SRP_FREE(this);
+}
+
+void threadPoolParallelFor(
+	ThreadPool* this, size_t count, size_t grain, ParallelForFunc func, void* data
+)
+{
+	if (count == 0)
+		return;
+	if (this == NULL || count <= grain)
+	{
+		func(data, 0, count, 0);
+		return;
+	}
+
+	mtx_lock(&this->submitLock);
+	this->runner = runChunks;
+	this->data = data;
+	this->func = func;
+	this->count = count;
+	this->grain = grain;
+	atomic_store(&this->next, 0);
+	runJob(this);
+	mtx_unlock(&this->submitLock);
+}
+
+void threadPoolRunTasks(
+	ThreadPool* this, size_t nTasks, const size_t* preferred, TaskFunc func, void* data
+)
+{
+	if (this == NULL || nTasks <= 1)
+	{
+		for (size_t i = 0; i < nTasks; i++)
+			func(data, i, 0);
+		return;
+	}
+
+	mtx_lock(&this->submitLock);
+
+	// Any thread may get all the tasks if they are dealt as preferred
+	const size_t perDeque = (preferred != NULL) ? \
+		nTasks : (nTasks + this->nThreads - 1) / this->nThreads;
+	const size_t capacity = perDeque * this->nThreads;
+	if (this->taskCapacity < capacity)
+	{
+		this->taskStorage = SRP_REALLOC(this->taskStorage, sizeof(size_t) * capacity);
+		this->taskCapacity = capacity;
+	}
+	for (size_t t = 0; t < this->nThreads; t++)
+		workDequeInit(&this->deques[t], this->taskStorage + t * perDeque, perDeque);
+
+	// The owner pops from the bottom, so push in reverse to have it
+	// start with its lowest-indexed task
+	for (size_t task = nTasks; task > 0; task--)
+	{
+		const size_t t = (preferred != NULL) ? preferred[task-1] : (task-1) % this->nThreads;
+		workDequePush(&this->deques[t], task-1);
+	}
+
+	this->runner = runTasks;
+	this->data = data;
+	this->taskFunc = func;
+	runJob(this);
+
+	mtx_unlock(&this->submitLock);
+}
+
+void threadPoolRunOnEach(ThreadPool* this, ThreadFunc func, void* data)
+{
+	if (this == NULL)
+	{
+		func(data, 0);
+		return;
+	}
+
+	mtx_lock(&this->submitLock);
+	this->runner = runOnThread;
+	this->data = data;
+	this->threadFunc = func;
+	runJob(this);
+	mtx_unlock(&this->submitLock);
+}
+
+size_t threadPoolSize(const ThreadPool* this)
+{
+	return (this == NULL) ? 1 : this->nThreads;
+}
+
+static int workerMain(void* arg)
+{
+	WorkerArgs args = *(WorkerArgs*) arg;
+	SRP_FREE(arg);
+	ThreadPool* this = args.pool;
+
+	if (this->threadNodes != NULL)
+		numaPinCurrentThread(this->threadNodes[args.threadIndex]);
+
+	size_t seenGeneration = 0;
+	mtx_lock(&this->lock);
+	while (true)
+	{
+		while (this->generation == seenGeneration && !this->stop)
+			cnd_wait(&this->wake, &this->lock);
+		if (this->stop)
+			break;
+		seenGeneration = this->generation;
+		mtx_unlock(&this->lock);
+
+		this->runner(this, args.threadIndex);
+
+		mtx_lock(&this->lock);
+		this->nActive--;
+		if (this->nActive == 0)
+			cnd_signal(&this->done);
+	}
+	mtx_unlock(&this->lock);
+
+	return 0;
+}
+
+static void runJob(ThreadPool* this)
+{
+	mtx_lock(&this->lock);
+	this->nActive = this->nThreads - 1;
+	this->generation++;
+	cnd_broadcast(&this->wake);
+	mtx_unlock(&this->lock);
+
+	this->runner(this, 0);
+
+	mtx_lock(&this->lock);
+	while (this->nActive > 0)
+		cnd_wait(&this->done, &this->lock);
+	mtx_unlock(&this->lock);
+}
+
+static void runChunks(ThreadPool* this, size_t threadIndex)
+{
+	while (true)
+	{
+		size_t begin = atomic_fetch_add(&this->next, this->grain);
+		if (begin >= this->count)
+			break;
+		size_t end = (begin + this->grain < this->count) ? begin + this->grain : this->count;
+		this->func(this->data, begin, end, threadIndex);
+	}
+}
+
+static void runTasks(ThreadPool* this, size_t threadIndex)
+{
+	size_t task;
+	while (true)
+	{
+		if (!workDequePop(&this->deques[threadIndex], &task) && \
+		    !stealTask(this, threadIndex, &task))
+			break;
+		this->taskFunc(this->data, task, threadIndex);
+	}
+}
+
+static void runOnThread(ThreadPool* this, size_t threadIndex)
+{
+	this->threadFunc(this->data, threadIndex);
+}
+
+static bool stealTask(ThreadPool* this, size_t threadIndex, size_t* task)
+{
+	// Tasks are never added while a job runs, so once every deque has been
+	// seen empty, there is nothing left to steal
+	bool retry = true;
+	while (retry)
+	{
+		retry = false;
+		for (size_t i = 1; i < this->nThreads; i++)
+		{
+			WorkDeque* victim = &this->deques[(threadIndex + i) % this->nThreads];
+			WorkDequeStealResult result = workDequeSteal(victim, task);
+			if (result == WORK_DEQUE_STOLEN)
+				return true;
+			if (result == WORK_DEQUE_RETRY)
+				retry = true;
+		}
+	}
+	return false;
+}
+
+/** @} */  // ingroup Parallel
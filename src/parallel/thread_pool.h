@@ -0,0 +1,137 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Pool of worker threads executing data-parallel loops */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include "parallel/work_deque.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Body of a parallel loop
+ *  @param[in] data User pointer passed to threadPoolParallelFor()
+ *  @param[in] begin First iteration of the chunk
+ *  @param[in] end One past the last iteration of the chunk
+ *  @param[in] threadIndex Index of the executing thread, in [0, nThreads) */
+typedef void (*ParallelForFunc)(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Body of a task executed by threadPoolRunTasks()
+ *  @param[in] data User pointer passed to threadPoolRunTasks()
+ *  @param[in] task Index of the task
+ *  @param[in] threadIndex Index of the executing thread, in [0, nThreads) */
+typedef void (*TaskFunc)(void* data, size_t task, size_t threadIndex);
+
+/** Body executed by every thread in threadPoolRunOnEach()
+ *  @param[in] data User pointer passed to threadPoolRunOnEach()
+ *  @param[in] threadIndex Index of the executing thread, in [0, nThreads) */
+typedef void (*ThreadFunc)(void* data, size_t threadIndex);
+
+struct ThreadPool;
+
+/** Work executed by every thread of the pool while a job is running */
+typedef void (*ThreadPoolRunner)(struct ThreadPool* pool, size_t threadIndex);
+
+/** Fixed set of worker threads. The thread submitting a job takes part
+ *  in it as well, so a pool of N threads has N-1 workers */
+typedef struct ThreadPool
+{
+	size_t nThreads;         /**< Amount of threads, including the caller */
+	thrd_t* workers;         /**< The `nThreads - 1` worker threads */
+	size_t* threadNodes;     /**< NUMA node every thread is pinned to, or NULL
+	                              if not pinned. The caller is never pinned, but
+	                              is considered to belong to its entry */
+
+	mtx_t submitLock;        /**< Serializes loops submitted from different threads */
+	mtx_t lock;              /**< Protects the fields below */
+	cnd_t wake;              /**< Broadcasted when a loop is started or on stop */
+	cnd_t done;              /**< Signaled when the last worker finishes a loop */
+	size_t generation;       /**< Incremented on every submitted loop */
+	size_t nActive;          /**< Amount of workers still executing the loop */
+	bool stop;               /**< Whether the workers should exit */
+
+	ThreadPoolRunner runner; /**< What the threads execute for the current job */
+	void* data;              /**< User pointer of the current job */
+
+	ParallelForFunc func;    /**< Body of the current loop */
+	size_t count;            /**< Amount of iterations of the current loop */
+	size_t grain;            /**< Amount of iterations claimed at once */
+	atomic_size_t next;      /**< First unclaimed iteration */
+
+	TaskFunc taskFunc;       /**< Body of the current tasks */
+	WorkDeque* deques;       /**< Per-thread deques of task indices */
+	size_t* taskStorage;     /**< Storage of the deques, reused between jobs */
+	size_t taskCapacity;     /**< Capacity of `taskStorage`, in tasks */
+
+	ThreadFunc threadFunc;   /**< Body of the current threadPoolRunOnEach() */
+} ThreadPool;
+
+/** Create a thread pool
+ *  @param[in] nThreads Amount of threads, including the calling one. Must be > 1
+ *  @param[in] pin Whether to pin the workers to NUMA nodes. The threads are
+ *                 split into contiguous groups, one per node (see
+ *                 numaPartitionNode()), and each worker is restricted to the
+ *                 CPUs of its node
+ *  @return Pointer to the thread pool */
+ThreadPool* newThreadPool(size_t nThreads, bool pin);
+
+/** Stop the workers and free the thread pool
+ *  @param[in] this Pointer to the thread pool, as returned from newThreadPool() */
+void freeThreadPool(ThreadPool* this);
+
+/** Execute `func` over [0, count) in chunks of `grain` iterations, distributing
+ *  the chunks over all the threads. Returns once all the iterations are done.
+ *  May be called concurrently from multiple threads, the loops are serialized
+ *  @param[in] this Pointer to the thread pool. If NULL, the loop is executed
+ *                  on the calling thread with `threadIndex` 0
+ *  @param[in] count Amount of iterations
+ *  @param[in] grain Amount of iterations claimed by a thread at once. Must be > 0
+ *  @param[in] func Body of the loop
+ *  @param[in] data User pointer passed to `func` */
+void threadPoolParallelFor(
+	ThreadPool* this, size_t count, size_t grain, ParallelForFunc func, void* data
+);
+
+/** Execute `func` for every task in [0, nTasks), balancing the load with
+ *  work stealing. The tasks are dealt to per-thread deques, round-robin or as
+ *  `preferred` says; every thread runs its own tasks in ascending order and,
+ *  once out of them, steals the highest-indexed remaining tasks of the other
+ *  threads. Tasks with lower indices therefore start earlier, so expensive
+ *  tasks should come first.
+ *  Returns once all the tasks are done. May be called concurrently from
+ *  multiple threads, the jobs are serialized
+ *  @param[in] this Pointer to the thread pool. If NULL, the tasks are executed
+ *                  in order on the calling thread with `threadIndex` 0
+ *  @param[in] nTasks Amount of tasks
+ *  @param[in] preferred Array of `nTasks` indices of the threads to initially
+ *                       give the tasks to, or NULL to deal them round-robin
+ *  @param[in] func Body of a task
+ *  @param[in] data User pointer passed to `func` */
+void threadPoolRunTasks(
+	ThreadPool* this, size_t nTasks, const size_t* preferred, TaskFunc func, void* data
+);
+
+/** Execute `func` exactly once on every thread of the pool, concurrently.
+ *  Unlike the other jobs, the threads may wait for each other inside `func`,
+ *  e.g. to form a producer/consumer pipeline. Returns once all the threads
+ *  are done. May be called concurrently from multiple threads, the jobs are
+ *  serialized
+ *  @param[in] this Pointer to the thread pool. If NULL, `func` is executed
+ *                  on the calling thread with `threadIndex` 0
+ *  @param[in] func The function to execute
+ *  @param[in] data User pointer passed to `func` */
+void threadPoolRunOnEach(ThreadPool* this, ThreadFunc func, void* data);
+
+/** Get the amount of threads taking part in loops of the pool
+ *  @param[in] this Pointer to the thread pool, may be NULL
+ *  @return Amount of threads, including the calling one */
+size_t threadPoolSize(const ThreadPool* this);
+
+/** @} */  // ingroup Parallel
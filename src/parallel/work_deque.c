@@ -0,0 +1,71 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Work-stealing deque implementation */
+
+#include <assert.h>
+#include "parallel/work_deque.h"
+
+/** @ingroup Parallel
+ *  @{ */
+
+void workDequeInit(WorkDeque* this, size_t* items, size_t capacity)
+{
+	this->items = items;
+	this->capacity = capacity;
+	atomic_init(&this->top, 0);
+	atomic_init(&this->bottom, 0);
+}
+
+void workDequePush(WorkDeque* this, size_t item)
+{
+	long b = atomic_load_explicit(&this->bottom, memory_order_relaxed);
+	assert((size_t) b < this->capacity);
+	this->items[b] = item;
+	atomic_store_explicit(&this->bottom, b + 1, memory_order_release);
+}
+
+bool workDequePop(WorkDeque* this, size_t* item)
+{
+	long b = atomic_load_explicit(&this->bottom, memory_order_relaxed) - 1;
+	atomic_store_explicit(&this->bottom, b, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	long t = atomic_load_explicit(&this->top, memory_order_relaxed);
+
+	if (t > b)  // Empty
+	{
+		atomic_store_explicit(&this->bottom, b + 1, memory_order_relaxed);
+		return false;
+	}
+
+	*item = this->items[b];
+	if (t == b)  // The last item, race against the thieves
+	{
+		bool won = atomic_compare_exchange_strong_explicit(
+			&this->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed
+		);
+		atomic_store_explicit(&this->bottom, b + 1, memory_order_relaxed);
+		return won;
+	}
+	return true;
+}
+
+WorkDequeStealResult workDequeSteal(WorkDeque* this, size_t* item)
+{
+	long t = atomic_load_explicit(&this->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	long b = atomic_load_explicit(&this->bottom, memory_order_acquire);
+
+	if (t >= b)
+		return WORK_DEQUE_EMPTY;
+
+	*item = this->items[t];
+	bool won = atomic_compare_exchange_strong_explicit(
+		&this->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed
+	);
+	return (won) ? WORK_DEQUE_STOLEN : WORK_DEQUE_RETRY;
+}
+
+/** @} */  // ingroup Parallel
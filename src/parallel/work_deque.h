@@ -0,0 +1,58 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Parallel
+ *  Work-stealing deque */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/** @ingroup Parallel
+ *  @{ */
+
+/** Result of workDequeSteal() */
+typedef enum WorkDequeStealResult
+{
+	WORK_DEQUE_STOLEN,  /**< An item was stolen */
+	WORK_DEQUE_EMPTY,   /**< The deque is empty */
+	WORK_DEQUE_RETRY    /**< Lost a race with another thread, the deque may still have items */
+} WorkDequeStealResult;
+
+/** Fixed-capacity Chase-Lev deque of task indices. The owner thread pushes
+ *  and pops at the bottom, other threads steal from the top */
+typedef struct WorkDeque
+{
+	size_t* items;         /**< Storage for the items */
+	size_t capacity;       /**< Maximal amount of items */
+	atomic_long top;       /**< Index of the oldest item, advanced by thieves */
+	atomic_long bottom;    /**< Index one past the newest item, owned by the owner */
+} WorkDeque;
+
+/** Initialize a deque
+ *  @param[out] this The deque to initialize
+ *  @param[in] items Storage for at least `capacity` items, owned by the caller
+ *  @param[in] capacity Maximal amount of items ever pushed before a reset */
+void workDequeInit(WorkDeque* this, size_t* items, size_t capacity);
+
+/** Push an item to the bottom. Must only be called by the owner
+ *  @param[in] this The deque
+ *  @param[in] item The item to push */
+void workDequePush(WorkDeque* this, size_t item);
+
+/** Pop the newest item from the bottom. Must only be called by the owner
+ *  @param[in] this The deque
+ *  @param[out] item The popped item
+ *  @return `true` if an item was popped, `false` if the deque is empty */
+bool workDequePop(WorkDeque* this, size_t* item);
+
+/** Steal the oldest item from the top. May be called by any thread
+ *  @param[in] this The deque
+ *  @param[out] item The stolen item
+ *  @return Whether the item was stolen, see WorkDequeStealResult */
+WorkDequeStealResult workDequeSteal(WorkDeque* this, size_t* item);
+
+/** @} */  // ingroup Parallel
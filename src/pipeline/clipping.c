@@ -39,23 +39,25 @@ static inline uint8_t computeClipCode(const SRPVertexShaderOut* v);
  *  @param[in] in Vertices of an input polygon
  *  @param[in] inCount Amount of vertices the input polygon has
  *  @param[in] plane The plane to clip against
- *  @param[in] sp The shader program being used
+ *  @param[in] pl The pipeline being used
+ *  @param[in] arena The arena to allocate new vertices' varyings in
  *  @param[out] out Vertices of a clipped polygon
  *  @return Amount of vertices the clipped polygon has */
 static size_t clipAgainstPlane(
     SRPVertexShaderOut* in, size_t inCount, ClipPlane plane,
-    const SRPShaderProgram* sp, SRPVertexShaderOut* out
+    const SRPPipeline* pl, SRPArena* arena, SRPVertexShaderOut* out
 );
 
 /** Create new vertex via interpolating between two existing ones
  *  @param[in] a First vertex
  *  @param[in] b Second vertex
  *  @param[in] t Interpolation parameter: 0 -> first vertex, 1 -> second vertex
- *  @param[in] sp The shader program being used
+ *  @param[in] pl The pipeline being used
+ *  @param[in] arena The arena to allocate the varyings in
  *  @param[in] out Interpolated vertex */ 
 static void interpolateVertex(
     const SRPVertexShaderOut* a, const SRPVertexShaderOut* b, float t,
-    const SRPShaderProgram* sp, SRPVertexShaderOut* out
+    const SRPPipeline* pl, SRPArena* arena, SRPVertexShaderOut* out
 );
 
 /** Calculate the distance from the vertex to the specified clip plane
@@ -65,7 +67,9 @@ static void interpolateVertex(
 static inline float planeDistance(const SRPVertexShaderOut* v, ClipPlane p);
 
 
-size_t clipTriangle(const SRPTriangle* in, const SRPShaderProgram* sp, SRPTriangle* out)
+size_t clipTriangle(
+    const SRPTriangle* in, const SRPPipeline* pl, SRPArena* arena, SRPTriangle* out
+)
 {
     uint8_t c0 = computeClipCode(&in->v[0]);
     uint8_t c1 = computeClipCode(&in->v[1]);
@@ -93,7 +97,7 @@ size_t clipTriangle(const SRPTriangle* in, const SRPShaderProgram* sp, SRPTriang
 
     for (int p = 0; p < PLANE_COUNT; p++)
     {
-        polyCount = clipAgainstPlane(src, polyCount, (ClipPlane) p, sp, dst);
+        polyCount = clipAgainstPlane(src, polyCount, (ClipPlane) p, pl, arena, dst);
         assert(polyCount <= 6);
 
         if (polyCount == 0)  // Fully clipped
@@ -136,7 +140,7 @@ static inline uint8_t computeClipCode(const SRPVertexShaderOut* v) {
     return code;
 }
 
-bool clipLine(SRPLine* line, const SRPShaderProgram* sp)
+bool clipLine(SRPLine* line, const SRPPipeline* pl, SRPArena* arena)
 {
     uint8_t c0 = computeClipCode(&line->v[0]);
     uint8_t c1 = computeClipCode(&line->v[1]);
@@ -175,9 +179,9 @@ bool clipLine(SRPLine* line, const SRPShaderProgram* sp)
     SRPVertexShaderOut A = line->v[0];
     SRPVertexShaderOut B = line->v[1];
     if (t0 > 0.)
-        interpolateVertex(&A, &B, t0, sp, &line->v[0]);
+        interpolateVertex(&A, &B, t0, pl, arena, &line->v[0]);
     if (t1 < 1.)
-        interpolateVertex(&A, &B, t1, sp, &line->v[1]);
+        interpolateVertex(&A, &B, t1, pl, arena, &line->v[1]);
 
     return false;
 }
@@ -198,7 +202,7 @@ bool clipPoint(SRPPoint* p)
 
 static size_t clipAgainstPlane(
     SRPVertexShaderOut* in, size_t inCount, ClipPlane plane,
-    const SRPShaderProgram* sp, SRPVertexShaderOut* out
+    const SRPPipeline* pl, SRPArena* arena, SRPVertexShaderOut* out
 )
 {
     if (inCount == 0)
@@ -226,7 +230,7 @@ static size_t clipAgainstPlane(
             if (ROUGHLY_ZERO(da - db))
                 continue;
             float t = da / (da - db);
-            interpolateVertex(current, next, t, sp, &out[outCount]);
+            interpolateVertex(current, next, t, pl, arena, &out[outCount]);
             outCount++;
 
             if (!currInside && nextInside)
@@ -243,18 +247,20 @@ static size_t clipAgainstPlane(
 
 static void interpolateVertex(
     const SRPVertexShaderOut* a, const SRPVertexShaderOut* b, float t,
-    const SRPShaderProgram* sp, SRPVertexShaderOut* out
+    const SRPPipeline* pl, SRPArena* arena, SRPVertexShaderOut* out
 )
 {
     for (int i = 0; i < 4; i++)
         out->clipPosition[i] = a->clipPosition[i] * (1-t) + b->clipPosition[i] * t;
 
-    void* pVarying = ARENA_ALLOC(sp->vs->varyingsSize);
+    out->pointSize = a->pointSize * (1-t) + b->pointSize * t;
+
+    void* pVarying = arenaAlloc(arena, pl->sp->vs->varyingsSize);
     out->varyings = pVarying;
 
     SRPVertexShaderOut vertices[2] = {*a, *b};  /** @todo this is disgusting */
 	const float weights[2] = {1-t, t};
-    interpolateAttributes(vertices, 2, weights, NULL, 0., sp, pVarying);
+    interpolateAttributes(vertices, 2, weights, NULL, 0., pl, pVarying);
 }
 
 static inline float planeDistance(const SRPVertexShaderOut* v, ClipPlane p)
@@ -10,22 +10,28 @@
 #include "raster/triangle.h"
 #include "raster/line.h"
 #include "raster/point.h"
+#include "core/pipeline_p.h"
+#include "memory/arena_p.h"
 
 /** @ingroup Clipping
  *  @{ */
 
 /** Clip the triangle using Sutherland-Hodgman algorithm
  *  @param[in] in The triangle to clip
- *  @param[in] sp The shader program being used
+ *  @param[in] pl The pipeline being used
+ *  @param[in] arena The arena to allocate new vertices' varyings in
  *  @param[out] out The returned array of triangles
  *  @return Amount of outputted triangles */
-size_t clipTriangle(const SRPTriangle* in, const SRPShaderProgram* sp, SRPTriangle* out);
+size_t clipTriangle(
+	const SRPTriangle* in, const SRPPipeline* pl, SRPArena* arena, SRPTriangle* out
+);
 
 /** Clip the line in-place using Liang-Barsky algorithm
  *  @param[in] line The line to clip
- *  @param[in] sp The shader program being used
+ *  @param[in] pl The pipeline being used
+ *  @param[in] arena The arena to allocate new vertices' varyings in
  *  @return `true` if clipped fully (nothing left), `false` if clipped partially */
-bool clipLine(SRPLine* line, const SRPShaderProgram* sp);
+bool clipLine(SRPLine* line, const SRPPipeline* pl, SRPArena* arena);
 
 /** Determine whether or not a point should be clipped
  *  @param[in] p Point to test
@@ -6,12 +6,17 @@
  *  Draw dispatch functions implementation */
 
 #include <assert.h>
+#include <string.h>
 #include "pipeline/draw.h"
 #include "raster/triangle.h"
+#include "pipeline/parallel_draw.h"
 #include "utils/message_callback_p.h"
-#include "srp/context.h"
+#include "core/context_p.h"
+#include "core/pipeline_p.h"
 #include "pipeline/primitive_assembly.h"
 #include "memory/arena_p.h"
+#include "parallel/render_thread.h"
+#include "raster/point_cloud.h"
 
 /** @ingroup Draw_dispatch
  *  @{ */
@@ -19,22 +24,25 @@
 /** Draw triangle-based primitives from either SRPIndexBuffer or SRPVertexBuffer
  *  @see drawBuffer() for parameter documentation */
 static void drawTriangles(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 );
 
 /** Draw line-based primitives from either SRPIndexBuffer or SRPVertexBuffer
  *  @see drawBuffer() for parameter documentation */
 static void drawLines(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 );
 
 /** Draw points from either SRPIndexBuffer or SRPVertexBuffer
  *  @see drawBuffer() for parameter documentation */
 static void drawPoints(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 );
 
 /** Check if the draw call tries to access out-of-bounds memory and
@@ -61,107 +69,208 @@ static bool isPrimitiveLine(SRPPrimitive primitive);
 static bool isPrimitivePoint(SRPPrimitive primitive);
 
 void drawBuffer(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
 	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
 )
 {
 	if (count == 0 || checkOOB(ib, vb, startIndex, count))
 		return;
 
-	if (isPrimitiveTriangle(primitive))
-		drawTriangles(ib, vb, fb, sp, primitive, startIndex, count);
-	else if (isPrimitiveLine(primitive))
-		drawLines(ib, vb, fb, sp, primitive, startIndex, count);
-	else if (isPrimitivePoint(primitive))
-		drawPoints(ib, vb, fb, sp, primitive, startIndex, count);
-	else
+	const SRPPipeline* bound = contextGetPipeline(ctx);
+	if (bound == NULL)  // Invalid state, already reported
+		return;
+
+	// The shader program passed to the draw call overrides the pipeline's one
+	if (sp == NULL)
+		sp = bound->sp;
+	if (sp == NULL)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"No shader program passed to the draw call or set in the bound pipeline\n"
+		);
+		return;
+	}
+
+	if (!isPrimitiveTriangle(primitive) && !isPrimitiveLine(primitive) && !isPrimitivePoint(primitive))
+	{
 		srpMessageCallbackHelper(
 			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
 			"Unknown primitive type: %i", primitive
 		);
+		return;
+	}
+
+	DrawCommand draw = {
+		.ib = ib, .vb = vb, .fb = fb,
+		.sp = *sp, .pl = *bound,
+		.primitive = primitive, .startIndex = startIndex, .count = count
+	};
+	if (ctx->renderThread != NULL)
+		renderThreadSubmitDraw(ctx->renderThread, &draw);
+	else
+		executeDraw(ctx, &draw);
+}
+
+void drawPointCloud(
+	SRPContext* ctx, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	const float transform[4][4], size_t startIndex, size_t count
+)
+{
+	if (count == 0 || checkOOB(NULL, vb, startIndex, count))
+		return;
+
+	if (vb->nBytesPerVertex < sizeof(SRPCloudPoint))
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Vertices are too small to hold SRPCloudPoint (%zu < %zu bytes)\n",
+			vb->nBytesPerVertex, sizeof(SRPCloudPoint)
+		);
+		return;
+	}
+
+	const SRPPipeline* bound = contextGetPipeline(ctx);
+	if (bound == NULL)  // Invalid state, already reported
+		return;
+
+	const SRPCompareOp op = bound->state.depth.compareOp;
+	if (op != SRP_COMPARE_LESS && op != SRP_COMPARE_LEQUAL &&
+	    op != SRP_COMPARE_GREATER && op != SRP_COMPARE_GEQUAL)
+	{
+		srpMessageCallbackHelper(
+			SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+			"Point clouds require an ordering depth compare operation (got %i)\n", op
+		);
+		return;
+	}
+
+	DrawCommand draw = {
+		.ib = NULL, .vb = vb, .fb = fb,
+		.sp = {0}, .pl = *bound,
+		.primitive = SRP_PRIM_POINTS, .startIndex = startIndex, .count = count,
+		.pointCloud = true
+	};
+	memcpy(draw.transform.data, transform, sizeof(draw.transform.data));
+	if (ctx->renderThread != NULL)
+		renderThreadSubmitDraw(ctx->renderThread, &draw);
+	else
+		executeDraw(ctx, &draw);
+}
+
+void executeDraw(SRPContext* ctx, DrawCommand* draw)
+{
+	SRPPipeline* pl = &draw->pl;
+	pl->sp = &draw->sp;
+
+	if (draw->pointCloud)
+	{
+		splatPointCloud(
+			draw->vb, draw->fb, pl, &draw->transform, draw->startIndex,
+			draw->count, ctx->arena, ctx->threadPool
+		);
+		arenaReset(ctx->arena);
+	}
+	else if (isPrimitiveTriangle(draw->primitive))
+		drawTriangles(ctx, draw->ib, draw->vb, draw->fb, pl, draw->primitive, draw->startIndex, draw->count);
+	else if (isPrimitiveLine(draw->primitive))
+		drawLines(ctx, draw->ib, draw->vb, draw->fb, pl, draw->primitive, draw->startIndex, draw->count);
+	else
+		drawPoints(ctx, draw->ib, draw->vb, draw->fb, pl, draw->primitive, draw->startIndex, draw->count);
 }
 
 static void drawTriangles(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 )
 {
-	if (srpContext.raster.cullFace == SRP_FACE_FRONT_AND_BACK)
+	if (pl->cullFront && pl->cullBack)
 		return;
 
+	const SRPPolygonMode polygonMode = pl->state.raster.polygonMode;
+	if (polygonMode == SRP_POLYGON_MODE_FILL && ctx->threadPool != NULL)
+	{
+		drawTrianglesParallel(ctx, ib, vb, fb, pl, primitive, startIndex, count);
+		return;
+	}
+
 	size_t outPrimitiveCount;
 	void* primitives;
 	bool success = assembleTrianglesGeneric(
-		ib, vb, fb, sp, primitive, startIndex, count,
+		ib, vb, fb, pl, ctx->arena, primitive, startIndex, count,
 		&outPrimitiveCount, &primitives
 	);
 	if (!success)
 		return;
 
+	if (polygonMode == SRP_POLYGON_MODE_POINT)
+	{
+		rasterizePoints((SRPPoint*) primitives, outPrimitiveCount, fb, pl);
+		arenaReset(ctx->arena);
+		return;
+	}
+
 	for (size_t i = 0; i < outPrimitiveCount; i++)
 	{
-		if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_FILL)
+		if (polygonMode == SRP_POLYGON_MODE_FILL)
 		{
-			void* interpolatedBuffer = ARENA_ALLOC(sp->vs->varyingsSize);
+			void* interpolatedBuffer = arenaAlloc(ctx->arena, pl->sp->vs->varyingsSize);
 			SRPTriangle* triangle = &((SRPTriangle*) primitives)[i];
-			rasterizeTriangle(triangle, fb, sp, interpolatedBuffer);
+			rasterizeTriangle(triangle, fb, pl, interpolatedBuffer);
 		}
-		else if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_LINE)
+		else if (polygonMode == SRP_POLYGON_MODE_LINE)
 		{
-			void* interpolatedBuffer = ARENA_ALLOC(sp->vs->varyingsSize);
+			void* interpolatedBuffer = arenaAlloc(ctx->arena, pl->sp->vs->varyingsSize);
 			SRPLine* line = &((SRPLine*) primitives)[i];
-			rasterizeLine(line, fb, sp, interpolatedBuffer);
-		}
-		else if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_POINT)
-		{
-			SRPPoint* point = &((SRPPoint*) primitives)[i];
-			rasterizePoint(point, fb, sp);
+			rasterizeLine(line, fb, pl, interpolatedBuffer);
 		}
 		else  // Should be handled at this point
 			assert(false);
 	}
 
-	ARENA_RESET();
+	arenaReset(ctx->arena);
 }
 
 static void drawLines(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 )
 {
 	size_t lineCount;
 	SRPLine* lines;
 	bool success = assembleLines(
-		ib, vb, fb, sp, primitive, startIndex, count,
+		ib, vb, fb, pl, ctx->arena, primitive, startIndex, count,
 		&lineCount, &lines
 	);
 	if (!success)
 		return;
 
-	void* interpolatedBuffer = ARENA_ALLOC(sp->vs->varyingsSize);
+	void* interpolatedBuffer = arenaAlloc(ctx->arena, pl->sp->vs->varyingsSize);
 	for (size_t i = 0; i < lineCount; i++)
-		rasterizeLine(&lines[i], fb, sp, interpolatedBuffer);
+		rasterizeLine(&lines[i], fb, pl, interpolatedBuffer);
 
-	ARENA_RESET();
+	arenaReset(ctx->arena);
 }
 
 static void drawPoints(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
 )
 {
 	size_t pointCount;
 	SRPPoint* points;
 	bool success = assemblePoints(
-		ib, vb, fb, sp, startIndex, count, &pointCount, &points
+		ib, vb, fb, pl, ctx->arena, startIndex, count, &pointCount, &points
 	);
 	if (!success)
 		return;
 
-	for (size_t i = 0; i < pointCount; i++)
-		rasterizePoint(&points[i], fb, sp);
+	rasterizePoints(points, pointCount, fb, pl);
 
-	ARENA_RESET();
+	arenaReset(ctx->arena);
 }
 
 static bool checkOOB(
@@ -8,18 +8,51 @@
 #pragma once
 
 #include "core/buffer_p.h"
+#include "core/context_p.h"
+#include "core/pipeline_p.h"
+#include "srp/mat.h"
 
 /** @ingroup Draw_dispatch
  *  @{ */
 
+/** Everything needed to execute a validated draw call. Holds copies of the
+ *  shader program and the pipeline, so the originals may change after the
+ *  draw call is submitted */
+typedef struct DrawCommand
+{
+	const SRPIndexBuffer* ib;   /**< Index buffer, or NULL if drawing vertex buffer */
+	const SRPVertexBuffer* vb;  /**< Vertex buffer */
+	const SRPFramebuffer* fb;   /**< Framebuffer to draw to */
+	SRPShaderProgram sp;        /**< Shader program to use */
+	SRPPipeline pl;             /**< Pipeline to use. Its `sp` is ignored */
+	SRPPrimitive primitive;     /**< Primitive type */
+	size_t startIndex;          /**< First stream index to draw */
+	size_t count;               /**< Number of stream indices to draw */
+	bool pointCloud;            /**< Whether this is a srpDrawPointCloud() call.
+	                                 If so, `ib` and `sp` are unused */
+	mat4 transform;             /**< Transform of the point cloud, if `pointCloud` */
+} DrawCommand;
+
 /** Draw either SRPIndexBuffer or SRPVertexBuffer.
  *  If `ib == NULL`, draws the vertex buffer, else draws index buffer.
  *  Created because vertex and index buffer drawing are very similar,
  *  with an intent to avoid code duplication
  *  @see srpDrawVertexBuffer() srpDrawIndexBuffer() for parameter documentation */
 void drawBuffer(
-	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
 	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count
 );
 
+/** Draw a point cloud
+ *  @see srpDrawPointCloud() for parameter documentation */
+void drawPointCloud(
+	SRPContext* ctx, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
+	const float transform[4][4], size_t startIndex, size_t count
+);
+
+/** Execute a draw call validated and recorded by drawBuffer() or drawPointCloud()
+ *  @param[in] ctx The context whose arena is used
+ *  @param[in] draw The draw call to execute */
+void executeDraw(SRPContext* ctx, DrawCommand* draw);
+
 /** @} */  // ingroup Draw_dispatch
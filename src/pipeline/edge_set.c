@@ -0,0 +1,61 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Primitive_assembly
+ *  Edge set implementation */
+
+#include <stdint.h>
+#include <string.h>
+#include "pipeline/edge_set.h"
+
+/** @ingroup Primitive_assembly
+ *  @{ */
+
+/** Hash a vertex index pair
+ *  @param[in] a,b The pair, the smaller index first
+ *  @return The hash */
+static inline size_t hashEdge(size_t a, size_t b);
+
+void edgeSetInit(EdgeSet* this, SRPArena* arena, size_t maxEdges)
+{
+	// At most half full, so that the probe sequences stay short
+	size_t capacity = 16;
+	while (capacity < 2 * maxEdges)
+		capacity *= 2;
+
+	this->slots = arenaAlloc(arena, sizeof(*this->slots) * capacity);
+	memset(this->slots, 0xFF, sizeof(*this->slots) * capacity);  // SIZE_MAX
+	this->mask = capacity - 1;
+}
+
+bool edgeSetInsert(EdgeSet* this, size_t a, size_t b)
+{
+	if (a > b)
+	{
+		size_t tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	for (size_t i = hashEdge(a, b) & this->mask; ; i = (i + 1) & this->mask)
+	{
+		size_t* slot = this->slots[i];
+		if (slot[0] == a && slot[1] == b)
+			return false;
+		if (slot[0] == SIZE_MAX)
+		{
+			slot[0] = a;
+			slot[1] = b;
+			return true;
+		}
+	}
+}
+
+static inline size_t hashEdge(size_t a, size_t b)
+{
+	uint64_t h = (uint64_t) a * 0x9E3779B97F4A7C15u ^ (uint64_t) b * 0xC2B2AE3D27D4EB4Fu;
+	return h ^ (h >> 32);
+}
+
+/** @} */  // ingroup Primitive_assembly
@@ -0,0 +1,38 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Primitive_assembly
+ *  Set of mesh edges, used to draw shared wireframe edges once */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "memory/arena_p.h"
+
+/** @ingroup Primitive_assembly
+ *  @{ */
+
+/** Open-addressing hash set of undirected edges, each identified by the
+ *  indices of its two vertices */
+typedef struct EdgeSet
+{
+	size_t (*slots)[2];  /**< Vertex index pairs, the smaller index first.
+	                          Empty slots hold SIZE_MAX */
+	size_t mask;         /**< `capacity - 1`, the capacity is a power of two */
+} EdgeSet;
+
+/** Initialize an empty set
+ *  @param[out] this The set to initialize
+ *  @param[in] arena The arena to allocate the slots in
+ *  @param[in] maxEdges Maximal amount of edges to be inserted */
+void edgeSetInit(EdgeSet* this, SRPArena* arena, size_t maxEdges);
+
+/** Insert an edge
+ *  @param[in] this The set
+ *  @param[in] a,b Indices of the edge's vertices, in any order
+ *  @return `true` if the edge was not in the set yet, `false` otherwise */
+bool edgeSetInsert(EdgeSet* this, size_t a, size_t b);
+
+/** @} */  // ingroup Primitive_assembly
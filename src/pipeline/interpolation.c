@@ -6,7 +6,6 @@
  *  Interpolation implementation */
 
 #include <string.h>
-#include "srp/context.h"
 #include "pipeline/interpolation.h"
 #include "utils/message_callback_p.h"
 #include "utils/voidptr.h"
@@ -32,8 +31,8 @@
  *  @see https://www.youtube.com/watch?v=F5X6S35SW2s */
 
 void interpolateDepthAndWTriangle(
-    SRPVertexShaderOut* vertices, const float* weights, const float* invW,
-    const SRPShaderProgram* sp, float* depth, float* reciprocalInterpolatedInvW
+    const SRPVertexShaderOut* vertices, const float* weights, const float* invW,
+    const SRPPipeline* pl, float* depth, float* reciprocalInterpolatedInvW
 )
 {
     *reciprocalInterpolatedInvW = 1 / (
@@ -47,8 +46,8 @@ void interpolateDepthAndWTriangle(
 }
 
 void interpolateDepthAndWLine(
-    SRPVertexShaderOut* vertices, const float* weights, const float* invW,
-    const SRPShaderProgram* sp, float* depth, float* reciprocalInterpolatedInvW
+    const SRPVertexShaderOut* vertices, const float* weights, const float* invW,
+    const SRPPipeline* pl, float* depth, float* reciprocalInterpolatedInvW
 )
 {
     *reciprocalInterpolatedInvW = 1 / (
@@ -91,9 +90,9 @@ do { \
 } while(0)
 
 void interpolateAttributes(
-    SRPVertexShaderOut* vertices, size_t nVertices, const float* weights,
+    const SRPVertexShaderOut* vertices, size_t nVertices, const float* weights,
     const float* invW, float reciprocalInterpolatedInvW, 
-    const SRPShaderProgram* sp, SRPInterpolated* pOutput
+    const SRPPipeline* pl, SRPInterpolated* pOutput
 )
 {
 	// vertices[i].varyings =
@@ -104,12 +103,12 @@ void interpolateAttributes(
 
     void* interpolatedVoid = pOutput;
     size_t attrOffsetBytes = 0;
-    const size_t provokingVertex = \
-        (srpContext.provokingVertexMode == SRP_PROVOKING_VERTEX_FIRST) ? 0 : nVertices-1;
+    const SRPVertexShader* vs = pl->sp->vs;
+    const size_t provokingVertex = (pl->provokingFirst) ? 0 : nVertices-1;
 
-    for (size_t attrI = 0; attrI < sp->vs->nVaryings; attrI++)
+    for (size_t attrI = 0; attrI < vs->nVaryings; attrI++)
     {
-        SRPVaryingInfo* attr = &sp->vs->varyingsInfo[attrI];
+        SRPVaryingInfo* attr = &vs->varyingsInfo[attrI];
         bool perspective = attr->interpolationMode == SRP_INTERPOLATION_MODE_PERSPECTIVE;
         bool affine      = attr->interpolationMode == SRP_INTERPOLATION_MODE_AFFINE;
         
@@ -162,4 +161,118 @@ void interpolateAttributes(
     }
 }
 
+size_t linearVaryingsMaxCount(const SRPPipeline* pl)
+{
+    return pl->sp->vs->varyingsSize / sizeof(float);
+}
+
+/** Prepare the elements of a floating point attribute @see linearVaryingsInit */
+#define LINEAR_FLOATING(Type) \
+do { \
+    elemSize = sizeof(Type); \
+    const Type* A0 = (const Type*) ADD_VOID_PTR(vertices[0].varyings, offset); \
+    const Type* A1 = (const Type*) ADD_VOID_PTR(vertices[1].varyings, offset); \
+    for (size_t elemI = 0; elemI < attr->nItems; elemI++) \
+    { \
+        if (!perspective && !affine) \
+        { \
+            ((Type*) ADD_VOID_PTR(pOutput, offset))[elemI] = \
+                (pl->provokingFirst) ? A0[elemI] : A1[elemI]; \
+            continue; \
+        } \
+        const double v0 = (perspective) ? A0[elemI] * invW[0] : A0[elemI]; \
+        const double v1 = (perspective) ? A1[elemI] * invW[1] : A1[elemI]; \
+        varyings[count++] = (LinearVarying) { \
+            .offset = offset + elemI * sizeof(Type), \
+            .isDouble = sizeof(Type) == sizeof(double), \
+            .perspective = perspective, \
+            .base = v0, \
+            .slope = v1 - v0 \
+        }; \
+    } \
+} while (0)
+
+/** Copy an integer attribute of the provoking vertex @see linearVaryingsInit */
+#define LINEAR_INTEGER(Type) \
+do { \
+    elemSize = sizeof(Type); \
+    memcpy( \
+        ADD_VOID_PTR(pOutput, offset), \
+        ADD_VOID_PTR(vertices[(pl->provokingFirst) ? 0 : 1].varyings, offset), \
+        elemSize * attr->nItems \
+    ); \
+} while (0)
+
+size_t linearVaryingsInit(
+    const SRPVertexShaderOut* vertices, const float* invW, const SRPPipeline* pl,
+    LinearVarying* varyings, SRPInterpolated* pOutput
+)
+{
+    const SRPVertexShader* vs = pl->sp->vs;
+    size_t count = 0;
+    size_t offset = 0;
+
+    for (size_t attrI = 0; attrI < vs->nVaryings; attrI++)
+    {
+        SRPVaryingInfo* attr = &vs->varyingsInfo[attrI];
+        const bool perspective = attr->interpolationMode == SRP_INTERPOLATION_MODE_PERSPECTIVE;
+        const bool affine      = attr->interpolationMode == SRP_INTERPOLATION_MODE_AFFINE;
+        size_t elemSize = 0;
+
+        switch (attr->type)
+        {
+        case SRP_FLOAT:
+            LINEAR_FLOATING(float); break;
+        case SRP_DOUBLE:
+            LINEAR_FLOATING(double); break;
+
+        case SRP_INT8:
+            LINEAR_INTEGER(int8_t); break;
+        case SRP_INT16:
+            LINEAR_INTEGER(int16_t); break;
+        case SRP_INT32:
+            LINEAR_INTEGER(int32_t); break;
+        case SRP_INT64:
+            LINEAR_INTEGER(int64_t); break;
+        case SRP_UINT8:
+            LINEAR_INTEGER(uint8_t); break;
+        case SRP_UINT16:
+            LINEAR_INTEGER(uint16_t); break;
+        case SRP_UINT32:
+            LINEAR_INTEGER(uint32_t); break;
+        case SRP_UINT64:
+            LINEAR_INTEGER(uint64_t); break;
+
+        default:
+            srpMessageCallbackHelper(
+                SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
+                "Unexpected type (%i)", attr->type
+            );
+        }
+
+        offset += elemSize * attr->nItems;
+    }
+    return count;
+}
+
+void linearVaryingsEvaluate(
+    const LinearVarying* varyings, size_t count, float t,
+    float reciprocalInterpolatedInvW, SRPInterpolated* pOutput
+)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const LinearVarying* v = &varyings[i];
+        double value = v->base + v->slope * t;
+        if (v->perspective)
+            value *= reciprocalInterpolatedInvW;
+
+        void* dst = ADD_VOID_PTR(pOutput, v->offset);
+        if (v->isDouble)
+            *(double*) dst = value;
+        else
+            *(float*) dst = value;
+    }
+}
+
 /** @} */  // ingroup Interpolation
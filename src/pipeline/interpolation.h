@@ -9,6 +9,7 @@
 
 #include "srp/shaders.h"
 #include "srp/vec.h"
+#include "core/pipeline_p.h"
 
 /** @ingroup Interpolation
  *  @{ */
@@ -17,26 +18,72 @@
  *  @param[in] vertices Array of vertices
  *  @param[in] weights Array of barycentric coordinates
  *  @param[in] invW Array of inverseW values for each corresponding vertex
- *  @param[in] sp The SRPShaderProgram being used
+ *  @param[in] pl The pipeline being used
  *  @param[out] depth Where interpolated depth will be stored
  *  @param[out] reciprocalInterpolatedInvW Where the reciprocal of interpolated
  *                                         inverse W_clip will be stored */
 void interpolateDepthAndWTriangle(
-    SRPVertexShaderOut* vertices, const float* weights, const float* invW,
-    const SRPShaderProgram* sp, float* depth, float* reciprocalInterpolatedInvW
+    const SRPVertexShaderOut* vertices, const float* weights, const float* invW,
+    const SRPPipeline* pl, float* depth, float* reciprocalInterpolatedInvW
 );
 
 /** Interpolate the depth and inverse W values inside the line
  *  @param[in] vertices Array of vertices
  *  @param[in] weights Array of barycentric coordinates
  *  @param[in] invW Array of inverseW values for each corresponding vertex
- *  @param[in] sp The SRPShaderProgram being used
+ *  @param[in] pl The pipeline being used
  *  @param[out] depth Where interpolated depth will be stored
  *  @param[out] reciprocalInterpolatedInvW Where the reciprocal of interpolated
  *                                         inverse W_clip will be stored */
 void interpolateDepthAndWLine(
-    SRPVertexShaderOut* vertices, const float* weights, const float* invW,
-    const SRPShaderProgram* sp, float* depth, float* reciprocalInterpolatedInvW
+    const SRPVertexShaderOut* vertices, const float* weights, const float* invW,
+    const SRPPipeline* pl, float* depth, float* reciprocalInterpolatedInvW
+);
+
+/** One floating point varying element of a line, expressed as a linear
+ *  function of the interpolation parameter along it
+ *  @see linearVaryingsInit() */
+typedef struct LinearVarying
+{
+    size_t offset;     /**< Offset of the element in the interpolated buffer, in bytes */
+    bool isDouble;     /**< Whether the element is `double` (`float` otherwise) */
+    bool perspective;  /**< Whether the value is to be divided by interpolated 1/W */
+    double base;       /**< Value at the 0th vertex (multiplied by its 1/W if `perspective`) */
+    double slope;      /**< Change of the value from the 0th vertex to the 1st */
+} LinearVarying;
+
+/** Get the maximum amount of LinearVarying elements linearVaryingsInit()
+ *  may produce for a pipeline
+ *  @param[in] pl The pipeline being used
+ *  @return The upper bound */
+size_t linearVaryingsMaxCount(const SRPPipeline* pl);
+
+/** Prepare the attributes of a line for evaluation at many points, so that
+ *  each point costs one multiply-add per element. Flat-interpolated and
+ *  integer attributes do not change along the line and are written to
+ *  `pOutput` right away, for good
+ *  @param[in] vertices The two vertices of the line
+ *  @param[in] invW Array of inverseW values for each corresponding vertex
+ *  @param[in] pl The pipeline being used
+ *  @param[out] varyings Where the prepared elements will be stored. Must hold
+ *                       at least linearVaryingsMaxCount() of them
+ *  @param[out] pOutput The interpolated buffer linearVaryingsEvaluate() will write to
+ *  @return Amount of prepared elements */
+size_t linearVaryingsInit(
+    const SRPVertexShaderOut* vertices, const float* invW, const SRPPipeline* pl,
+    LinearVarying* varyings, SRPInterpolated* pOutput
+);
+
+/** Evaluate the prepared attributes of a line at a point
+ *  @param[in] varyings The elements, as prepared by linearVaryingsInit()
+ *  @param[in] count Amount of elements
+ *  @param[in] t Interpolation parameter (0 -> 0th vertex; 1 -> 1st vertex)
+ *  @param[in] reciprocalInterpolatedInvW The reciprocal of interpolated inverse W_clip
+ *  @param[out] pOutput Interpolated vertex attributes. Only the elements
+ *                      that vary along the line are written */
+void linearVaryingsEvaluate(
+    const LinearVarying* varyings, size_t count, float t,
+    float reciprocalInterpolatedInvW, SRPInterpolated* pOutput
 );
 
 /** Interpolate the attributes inside the primitive
@@ -45,12 +92,12 @@ void interpolateDepthAndWLine(
  *  @param[in] weights Array of barycentric coordinates
  *  @param[in] invW Array of inverseW values for each corresponding vertex
  *  @param[in] reciprocalInterpolatedInvW The reciprocal of interpolated inverse W_clip
- *  @param[in] sp The SRPShaderProgram being used
+ *  @param[in] pl The pipeline being used
  *  @param[out] pOutput Interpolated vertex attributes */
 void interpolateAttributes(
-    SRPVertexShaderOut* vertices, size_t nVertices, const float* weights,
+    const SRPVertexShaderOut* vertices, size_t nVertices, const float* weights,
     const float* invW, float reciprocalInterpolatedInvW, 
-    const SRPShaderProgram* sp, SRPInterpolated* pOutput
+    const SRPPipeline* pl, SRPInterpolated* pOutput
 );
 
 /** @} */  // ingroup Interpolation
@@ -0,0 +1,244 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Draw_dispatch
+ *  Multithreaded draw dispatch implementation */
+
+#include <assert.h>
+#include "pipeline/parallel_draw.h"
+#include "pipeline/primitive_assembly.h"
+#include "parallel/thread_pool.h"
+#include "parallel/spsc_queue.h"
+#include "raster/tile.h"
+#include "memory/arena_p.h"
+#include "math/utils.h"
+
+/** @ingroup Draw_dispatch
+ *  @{ */
+
+/** Set-up triangles passed from the frontend to the backend */
+typedef struct TriangleBatch
+{
+	const SRPTriangle* triangles;  /**< The triangles */
+	size_t count;                  /**< Amount of triangles */
+} TriangleBatch;
+
+/** Shared state of a pipelined draw */
+typedef struct PipelinedDraw
+{
+	TriangleAssembler* assembler;  /**< Used by the frontend only */
+	SPSCQueue* queues;             /**< Queue of TriangleBatch of every backend thread */
+	size_t nBackend;               /**< Amount of backend threads */
+	void** interpolatedBuffers;    /**< Varying buffer of every backend thread */
+	const SRPFramebuffer* fb;      /**< The framebuffer to draw to */
+	const SRPPipeline* pl;         /**< The pipeline to use */
+} PipelinedDraw;
+
+/** Shared state of a draw with parallel geometry processing */
+typedef struct ParallelGeometry
+{
+	const TriangleAssembler* whole;  /**< Assembler of the whole draw, not run */
+	TileBins* bins;                  /**< Bins with one row per thread, one slice per task */
+	size_t sliceSize;                /**< Amount of stream triangles in a slice */
+	SRPArena** arenas;               /**< Arena of every thread */
+	SRPTriangle** sliceTriangles;    /**< Assembled triangles of every slice */
+	size_t* sliceCounts;             /**< Amount of triangles of every slice */
+	size_t* sliceFirstIDs;           /**< Primitive ID of the first triangle of every slice */
+} ParallelGeometry;
+
+/** Draw with parallel geometry processing
+ *  @param[in] ctx The context
+ *  @param[in] whole Assembler of the whole draw, not run yet
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use */
+static void drawParallelGeometry(
+	SRPContext* ctx, const TriangleAssembler* whole,
+	const SRPFramebuffer* fb, const SRPPipeline* pl
+);
+
+/** Assemble one slice and append its triangles to the calling thread's row of
+ *  bins. A TaskFunc */
+static void assembleSlice(void* data, size_t slice, size_t threadIndex);
+
+/** Offset the primitive IDs of slices, which start from 0, by the amount of
+ *  triangles in all the previous slices. A ParallelForFunc */
+static void fixSlicePrimitiveIDs(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Entry point of every thread of a pipelined draw. Thread 0 runs the
+ *  frontend, the rest run the backend. A ThreadFunc */
+static void pipelineThread(void* data, size_t threadIndex);
+
+/** Assemble all the batches and hand them to every backend thread,
+ *  then signal the end of the draw with a NULL batch
+ *  @param[in] draw The pipelined draw */
+static void runFrontend(PipelinedDraw* draw);
+
+/** Rasterize the batches in the order of their submission until the end
+ *  of the draw, covering only the tiles owned by the calling thread
+ *  @param[in] draw The pipelined draw
+ *  @param[in] backendIndex Index of the calling thread among the backend ones */
+static void runBackend(PipelinedDraw* draw, size_t backendIndex);
+
+void drawTrianglesParallel(
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
+)
+{
+	assert(ctx->threadPool != NULL);
+
+	TriangleAssembler assembler;
+	if (!triangleAssemblerInit(&assembler, ib, vb, fb, pl, ctx->arena, primitive, startIndex, count))
+		return;
+
+	const size_t nThreads = threadPoolSize(ctx->threadPool);
+	if (assembler.nTriangles <= PIPELINE_BATCH_SIZE)
+	{
+		void* primitives;
+		size_t nTriangles = triangleAssemblerRun(&assembler, assembler.nTriangles, &primitives);
+		const SRPTriangle* triangles = primitives;
+
+		TileBins bins;
+		tileBinsInit(&bins, ctx->arena, fb, 1, 1);
+		for (size_t i = 0; i < nTriangles; i++)
+			tileBinsAppend(&bins, 0, 0, &triangles[i], ctx->arena);
+		rasterizeTrianglesTiled(&bins, fb, pl, ctx->arena, ctx->threadPool);
+		arenaReset(ctx->arena);
+		return;
+	}
+	if (assembler.nTriangles >= nThreads * PARALLEL_GEOMETRY_MIN_TRIANGLES)
+	{
+		drawParallelGeometry(ctx, &assembler, fb, pl);
+		return;
+	}
+
+	const size_t nBackend = nThreads - 1;
+	PipelinedDraw draw = {
+		.assembler = &assembler,
+		.queues = arenaAllocAligned(ctx->arena, sizeof(SPSCQueue) * nBackend, SPSC_CACHE_LINE),
+		.nBackend = nBackend,
+		.interpolatedBuffers = arenaAlloc(ctx->arena, sizeof(void*) * nBackend),
+		.fb = fb,
+		.pl = pl
+	};
+	for (size_t i = 0; i < nBackend; i++)
+	{
+		void** storage = arenaAlloc(ctx->arena, sizeof(void*) * PIPELINE_QUEUE_CAPACITY);
+		spscQueueInit(&draw.queues[i], storage, PIPELINE_QUEUE_CAPACITY);
+		draw.interpolatedBuffers[i] = arenaAlloc(ctx->arena, pl->sp->vs->varyingsSize);
+	}
+
+	threadPoolRunOnEach(ctx->threadPool, pipelineThread, &draw);
+	arenaReset(ctx->arena);
+}
+
+static void drawParallelGeometry(
+	SRPContext* ctx, const TriangleAssembler* whole,
+	const SRPFramebuffer* fb, const SRPPipeline* pl
+)
+{
+	const size_t nThreads = threadPoolSize(ctx->threadPool);
+	const size_t nSlices = nThreads * PARALLEL_GEOMETRY_SLICES_PER_THREAD;
+
+	TileBins bins;
+	tileBinsInit(&bins, ctx->arena, fb, nThreads, nSlices);
+	ParallelGeometry job = {
+		.whole = whole,
+		.bins = &bins,
+		.sliceSize = (whole->nTriangles + nSlices - 1) / nSlices,
+		.arenas = ctx->threadArenas,
+		.sliceTriangles = arenaAlloc(ctx->arena, sizeof(SRPTriangle*) * nSlices),
+		.sliceCounts = arenaAlloc(ctx->arena, sizeof(size_t) * nSlices),
+		.sliceFirstIDs = arenaAlloc(ctx->arena, sizeof(size_t) * nSlices)
+	};
+	threadPoolRunTasks(ctx->threadPool, nSlices, NULL, assembleSlice, &job);
+
+	for (size_t i = 0, id = 0; i < nSlices; i++)
+	{
+		job.sliceFirstIDs[i] = id;
+		id += job.sliceCounts[i];
+	}
+	threadPoolParallelFor(ctx->threadPool, nSlices, 1, fixSlicePrimitiveIDs, &job);
+
+	rasterizeTrianglesTiled(&bins, fb, pl, ctx->arena, ctx->threadPool);
+
+	for (size_t i = 0; i < nThreads; i++)
+		arenaReset(ctx->threadArenas[i]);
+	arenaReset(ctx->arena);
+}
+
+static void assembleSlice(void* data, size_t slice, size_t threadIndex)
+{
+	ParallelGeometry* job = (ParallelGeometry*) data;
+	SRPArena* arena = job->arenas[threadIndex];
+
+	const size_t first = slice * job->sliceSize;
+	const size_t count = (first < job->whole->nTriangles) ? \
+		MIN(job->sliceSize, job->whole->nTriangles - first) : 0;
+
+	TriangleAssembler assembler;
+	triangleAssemblerSlice(&assembler, job->whole, arena, first, count);
+	void* primitives;
+	const size_t nTriangles = triangleAssemblerRun(&assembler, count, &primitives);
+	SRPTriangle* triangles = primitives;
+
+	for (size_t i = 0; i < nTriangles; i++)
+		tileBinsAppend(job->bins, threadIndex, slice, &triangles[i], arena);
+
+	job->sliceTriangles[slice] = triangles;
+	job->sliceCounts[slice] = nTriangles;
+}
+
+static void fixSlicePrimitiveIDs(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	ParallelGeometry* job = (ParallelGeometry*) data;
+	for (size_t slice = begin; slice < end; slice++)
+		for (size_t i = 0; i < job->sliceCounts[slice]; i++)
+			job->sliceTriangles[slice][i].id += job->sliceFirstIDs[slice];
+}
+
+static void pipelineThread(void* data, size_t threadIndex)
+{
+	PipelinedDraw* draw = (PipelinedDraw*) data;
+	if (threadIndex == 0)
+		runFrontend(draw);
+	else
+		runBackend(draw, threadIndex - 1);
+}
+
+static void runFrontend(PipelinedDraw* draw)
+{
+	TriangleAssembler* assembler = draw->assembler;
+	while (assembler->next < assembler->end)
+	{
+		// Only the frontend allocates from the arena while the draw runs
+		TriangleBatch* batch = arenaAlloc(assembler->arena, sizeof(TriangleBatch));
+		void* triangles;
+		batch->count = triangleAssemblerRun(assembler, PIPELINE_BATCH_SIZE, &triangles);
+		batch->triangles = triangles;
+		if (batch->count == 0)  // Everything was culled or clipped away
+			continue;
+
+		for (size_t i = 0; i < draw->nBackend; i++)
+			spscQueuePushWait(&draw->queues[i], batch);
+	}
+
+	for (size_t i = 0; i < draw->nBackend; i++)
+		spscQueuePushWait(&draw->queues[i], NULL);
+}
+
+static void runBackend(PipelinedDraw* draw, size_t backendIndex)
+{
+	SPSCQueue* queue = &draw->queues[backendIndex];
+	const TriangleBatch* batch;
+	while ((batch = spscQueuePopWait(queue)) != NULL)
+	{
+		rasterizeTrianglesOwnedTiles(
+			batch->triangles, batch->count, draw->fb, draw->pl,
+			backendIndex, draw->nBackend, draw->interpolatedBuffers[backendIndex]
+		);
+	}
+}
+
+/** @} */  // ingroup Draw_dispatch
@@ -0,0 +1,52 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Draw_dispatch
+ *  Multithreaded draw dispatch */
+
+#pragma once
+
+#include "core/buffer_p.h"
+#include "core/context_p.h"
+#include "core/pipeline_p.h"
+
+/** @ingroup Draw_dispatch
+ *  @{ */
+
+/** Amount of stream triangles the frontend assembles at once */
+#define PIPELINE_BATCH_SIZE 256
+
+/** Maximal amount of batches the frontend may run ahead of a backend thread.
+ *  Must be a power of two */
+#define PIPELINE_QUEUE_CAPACITY 16
+
+/** Draws with at least this many stream triangles per thread are considered
+ *  geometry-bound and have their geometry processed on all the threads */
+#define PARALLEL_GEOMETRY_MIN_TRIANGLES (8 * PIPELINE_BATCH_SIZE)
+
+/** Amount of slices per thread the triangles are split into when processing
+ *  geometry on all the threads. More slices balance the load better */
+#define PARALLEL_GEOMETRY_SLICES_PER_THREAD 4
+
+/** Draw filled triangles on the context's thread pool, choosing between:
+ *  - Draws that fit into one batch are assembled on the calling thread and
+ *    rasterized in tiles on all the threads (see rasterizeTrianglesTiled())
+ *  - Geometry-bound draws (see PARALLEL_GEOMETRY_MIN_TRIANGLES) are split
+ *    into slices of consecutive triangles, assembled and binned concurrently
+ *    into TileBins, each slice on one thread with its own arena, then
+ *    rasterized in tiles on all the threads
+ *  - Other draws are pipelined: the calling thread assembles, clips and sets
+ *    up the triangles batch by batch (the frontend), while the other threads
+ *    rasterize the previous batches (the backend), each in its own set of
+ *    tiles. The frontend and the backend threads are connected by lock-free
+ *    single-producer single-consumer queues
+ *  Must only be called with `ctx->threadPool != NULL`
+ *  @see drawBuffer() for parameter documentation */
+void drawTrianglesParallel(
+	SRPContext* ctx, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPPrimitive primitive,
+	size_t startIndex, size_t count
+);
+
+/** @} */  // ingroup Draw_dispatch
@@ -5,6 +5,7 @@
  *  @ingroup Primitive_assembly
  *  Primitive assembly implementation */
 
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include "pipeline/primitive_assembly.h"
@@ -12,7 +13,6 @@
 #include "pipeline/topology.h"
 #include "pipeline/clipping.h"
 #include "utils/message_callback_p.h"
-#include "srp/context.h"
 #include "memory/arena_p.h"
 #include "utils/voidptr.h"
 
@@ -27,77 +27,170 @@ static void warnOnExcessVertexCount(
 	SRPPrimitive prim, size_t startIndex, size_t vertexCount
 );
 
+/** Find which vertex of the unclipped triangle a vertex of a clipped one is
+ *  @param[in] v The vertex of the clipped triangle
+ *  @param[in] unclipped The triangle before clipping
+ *  @param[in] vertexIndices Indices of the unclipped triangle's vertices
+ *  @return Index of the vertex, or SIZE_MAX if it was created by clipping */
+static size_t originalVertexIndex(
+	const SRPVertexShaderOut* v, const SRPTriangle* unclipped, const size_t* vertexIndices
+);
+
 /** Calculate constants for triangle assembly
+ *  @param[in] polygonMode The polygon mode being used
  *  @param[out] nOutPrimitivesPerClippedTriangle How many primitives end up from a clipped triangle
  *  @param[out] sizeOutPrimitive The size of an output primitive (in bytes) */
 static void resolvePolygonModeOutput(
-	size_t* nOutPrimitivesPerClippedTriangle, size_t* sizeOutPrimitive
+	SRPPolygonMode polygonMode, size_t* nOutPrimitivesPerClippedTriangle,
+	size_t* sizeOutPrimitive
 );
 
 bool assembleTrianglesGeneric(
     const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-    const SRPShaderProgram* sp, SRPPrimitive prim, size_t startIndex, size_t vertexCount,
+    const SRPPipeline* pl, SRPArena* arena, SRPPrimitive prim, size_t startIndex, size_t vertexCount,
     size_t* outCount, void** outPrimitives
 )
 {
-    warnOnExcessVertexCount(ib, vb, prim, startIndex, vertexCount);
-    size_t nUnclipped = computeTriangleCount(vertexCount, prim);
-    if (nUnclipped == 0)
+    TriangleAssembler assembler;
+    if (!triangleAssemblerInit(&assembler, ib, vb, fb, pl, arena, prim, startIndex, vertexCount))
     {
         *outCount = 0;
         *outPrimitives = NULL;
         return false;
     }
 
-    VertexCache cache;
-    allocateVertexCache(&cache, ib, startIndex, vertexCount, sp->vs->varyingsSize);
+    *outCount = triangleAssemblerRun(&assembler, assembler.end, outPrimitives);
+    return true;
+}
+
+bool triangleAssemblerInit(
+	TriangleAssembler* this, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPArena* arena,
+	SRPPrimitive prim, size_t startIndex, size_t vertexCount
+)
+{
+	warnOnExcessVertexCount(ib, vb, prim, startIndex, vertexCount);
+	size_t nUnclipped = computeTriangleCount(vertexCount, prim);
+	if (nUnclipped == 0)
+		return false;
+
+	*this = (TriangleAssembler) {
+		.ib = ib, .vb = vb, .fb = fb, .pl = pl, .arena = arena,
+		.prim = prim, .startIndex = startIndex,
+		.nTriangles = nUnclipped, .next = 0, .end = nUnclipped, .primitiveID = 0,
+		.cache = {.entries = NULL},
+		.edges = {.slots = NULL}
+	};
+	return true;
+}
+
+void triangleAssemblerSlice(
+	TriangleAssembler* this, const TriangleAssembler* whole, SRPArena* arena,
+	size_t first, size_t count
+)
+{
+	*this = *whole;
+	this->arena = arena;
+	this->next = first;
+	this->end = first + count;
+	this->primitiveID = 0;
+	this->cache.entries = NULL;
+	this->edges.slots = NULL;
+}
+
+size_t triangleAssemblerRun(TriangleAssembler* this, size_t maxTriangles, void** outPrimitives)
+{
+	const SRPIndexBuffer* ib = this->ib;
+	const SRPPipeline* pl = this->pl;
+	const SRPFramebuffer* fb = this->fb;
+	const size_t begin = this->next;
+	const size_t end = (this->end - begin < maxTriangles) ? this->end : begin + maxTriangles;
+	this->next = end;
+	if (begin == end)
+	{
+		*outPrimitives = NULL;
+		return 0;
+	}
+
+	if (this->cache.entries == NULL)  // Cover all the vertices still to assemble
+	{
+		size_t streamStart, streamCount;
+		resolveTriangleStreamRange(
+			this->startIndex, begin, this->end - begin, this->prim, &streamStart, &streamCount
+		);
+		allocateVertexCache(
+			&this->cache, this->arena, ib, streamStart, streamCount, pl->sp->vs->varyingsSize
+		);
+	}
+
+	const SRPPolygonMode polygonMode = pl->state.raster.polygonMode;
+	const bool dedupEdges = polygonMode == SRP_POLYGON_MODE_LINE && pl->state.raster.dedupEdges;
+	if (dedupEdges && this->edges.slots == NULL)
+		edgeSetInit(&this->edges, this->arena, 3 * (this->end - begin));
 
 	size_t nOutPrimitivesPerClippedTriangle, sizeOutPrimitive;
-	resolvePolygonModeOutput(&nOutPrimitivesPerClippedTriangle, &sizeOutPrimitive);
+	resolvePolygonModeOutput(polygonMode, &nOutPrimitivesPerClippedTriangle, &sizeOutPrimitive);
 
     // Worst case: each triangle becomes clipped triangles
     SRPTriangle clipped[4];
-    size_t maxTotal = nUnclipped * 4 * nOutPrimitivesPerClippedTriangle;
-    void* buffer = ARENA_ALLOC(maxTotal * sizeOutPrimitive);
+    size_t maxTotal = (end - begin) * 4 * nOutPrimitivesPerClippedTriangle;
+    void* buffer = arenaAlloc(this->arena, maxTotal * sizeOutPrimitive);
     void* cur = buffer;
 
-    size_t primitiveID = 0;
-    for (size_t k = 0; k < nUnclipped; k++)
+    const size_t firstPrimitiveID = this->primitiveID;
+    size_t primitiveID = firstPrimitiveID;
+    for (size_t k = begin; k < end; k++)
     {
         SRPTriangle unclipped;
 
         size_t streamIndices[3];
-        resolveTriangleTopology(startIndex, k, prim, streamIndices);
+        resolveTriangleTopology(this->startIndex, k, this->prim, streamIndices);
 
+        size_t vertexIndices[3];
         for (uint8_t i = 0; i < 3; i++)
         {
-            size_t vertexIndex = (ib) ? indexIndexBuffer(ib, streamIndices[i]) : streamIndices[i];
-            unclipped.v[i] = *vertexCacheFetch(&cache, vertexIndex, vb, sp);
+            vertexIndices[i] = (ib) ? indexIndexBuffer(ib, streamIndices[i]) : streamIndices[i];
+            unclipped.v[i] = *vertexCacheFetch(&this->cache, vertexIndices[i], this->vb, pl->sp);
         }
 
-        size_t nClipped = clipTriangle(&unclipped, sp, clipped);
+        size_t nClipped = clipTriangle(&unclipped, pl, this->arena, clipped);
 
         for (size_t i = 0; i < nClipped; i++)
         {
-			if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_FILL)
+			if (polygonMode == SRP_POLYGON_MODE_FILL)
 			{
 				SRPTriangle* dst = (SRPTriangle*) cur;
 				*dst = clipped[i];
 
-				if (!setupTriangle(dst, fb))
+				if (!setupTriangle(dst, fb, pl))
 					continue;
 
 				dst->id = primitiveID;
 				primitiveID++;
-				cur = dst + 1;
+				if (!triangleIsEmpty(dst))
+					cur = dst + 1;
 			}
-			else if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_LINE)
+			else if (polygonMode == SRP_POLYGON_MODE_LINE)
 			{
 				SRPLine* dst = (SRPLine*) cur;
 				for (uint8_t j = 0; j < 3; j++)
 				{
-					dst->v[0] = clipped[i].v[j];
-					dst->v[1] = clipped[i].v[(j + 1) % 3];
+					const SRPVertexShaderOut* a = &clipped[i].v[j];
+					const SRPVertexShaderOut* b = &clipped[i].v[(j + 1) % 3];
+
+					// Edges between the mesh's own vertices may be shared by
+					// neighbouring triangles. Those created by clipping are not
+					if (dedupEdges)
+					{
+						size_t indexA = originalVertexIndex(a, &unclipped, vertexIndices);
+						size_t indexB = originalVertexIndex(b, &unclipped, vertexIndices);
+						if (indexA != SIZE_MAX && indexB != SIZE_MAX && \
+						    !edgeSetInsert(&this->edges, indexA, indexB))
+							continue;
+					}
+
+					dst->v[0] = *a;
+					dst->v[1] = *b;
 
 					setupLine(dst, fb);
 					dst->id = primitiveID;
@@ -106,13 +199,13 @@ bool assembleTrianglesGeneric(
 				}
 				cur = dst;
 			}
-			else if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_POINT)
+			else if (polygonMode == SRP_POLYGON_MODE_POINT)
 			{
 				SRPPoint* dst = (SRPPoint*) cur;
 				for (uint8_t j = 0; j < 3; j++)
 				{
 					dst->v = clipped[i].v[j];
-					setupPoint(dst);
+					setupPoint(dst, fb);
 					dst->id = primitiveID;
 					primitiveID++;
 					dst++;
@@ -122,21 +215,19 @@ bool assembleTrianglesGeneric(
 			else
 				srpMessageCallbackHelper(
 					SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
-					"Unexpected srpContext.raster.polygonMode (%i)",
-					srpContext.raster.polygonMode
+					"Unexpected polygon mode (%i)", polygonMode
 				);
         }
     }
 
-    *outCount = primitiveID;
+    this->primitiveID = primitiveID;
     *outPrimitives = buffer;
-
-    return true;
+    return primitiveID - firstPrimitiveID;
 }
 
 bool assembleLines(
 	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive prim, size_t startIndex, size_t vertexCount,
+	const SRPPipeline* pl, SRPArena* arena, SRPPrimitive prim, size_t startIndex, size_t vertexCount,
 	size_t* outLineCount, SRPLine** outLines
 )
 {
@@ -146,8 +237,8 @@ bool assembleLines(
 		return false;
 
 	VertexCache cache;
-	SRPLine* lines = ARENA_ALLOC(sizeof(SRPLine) * nLines);
-	allocateVertexCache(&cache, ib, startIndex, vertexCount, sp->vs->varyingsSize);
+	SRPLine* lines = arenaAlloc(arena, sizeof(SRPLine) * nLines);
+	allocateVertexCache(&cache, arena, ib, startIndex, vertexCount, pl->sp->vs->varyingsSize);
 
 	size_t primitiveID = 0;
 	for (size_t k = 0; k < nLines; k += 1)
@@ -160,10 +251,10 @@ bool assembleLines(
 		for (uint8_t i = 0; i < 2; i++)
 		{
 			size_t vertexIndex = (ib) ? indexIndexBuffer(ib, streamIndices[i]) : streamIndices[i];
-			line->v[i] = *vertexCacheFetch(&cache, vertexIndex, vb, sp);
+			line->v[i] = *vertexCacheFetch(&cache, vertexIndex, vb, pl->sp);
 		}
 
-		if (clipLine(line, sp))  // Fully clipped
+		if (clipLine(line, pl, arena))  // Fully clipped
 			continue;
 
 		setupLine(line, fb);
@@ -195,21 +286,37 @@ static void warnOnExcessVertexCount(
 		);
 }
 
+static size_t originalVertexIndex(
+	const SRPVertexShaderOut* v, const SRPTriangle* unclipped, const size_t* vertexIndices
+)
+{
+	// Clipping copies the vertices it keeps, along with their varyings
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		const SRPVertexShaderOut* u = &unclipped->v[i];
+		if (v->varyings == u->varyings && \
+		    memcmp(v->clipPosition, u->clipPosition, sizeof(v->clipPosition)) == 0)
+			return vertexIndices[i];
+	}
+	return SIZE_MAX;
+}
+
 static void resolvePolygonModeOutput(
-	size_t* nOutPrimitivesPerClippedTriangle, size_t* sizeOutPrimitive
+	SRPPolygonMode polygonMode, size_t* nOutPrimitivesPerClippedTriangle,
+	size_t* sizeOutPrimitive
 )
 {
-	if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_FILL)
+	if (polygonMode == SRP_POLYGON_MODE_FILL)
 	{
 		*nOutPrimitivesPerClippedTriangle = 1;
 		*sizeOutPrimitive = sizeof(SRPTriangle);
 	}
-	else if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_LINE)
+	else if (polygonMode == SRP_POLYGON_MODE_LINE)
 	{
 		*nOutPrimitivesPerClippedTriangle = 3;
 		*sizeOutPrimitive = sizeof(SRPLine);
 	}
-	else if (srpContext.raster.polygonMode == SRP_POLYGON_MODE_POINT)
+	else if (polygonMode == SRP_POLYGON_MODE_POINT)
 	{
 		*nOutPrimitivesPerClippedTriangle = 3;
 		*sizeOutPrimitive = sizeof(SRPPoint);
@@ -220,16 +327,15 @@ static void resolvePolygonModeOutput(
 
 bool assemblePoints(
 	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, size_t startIndex, size_t count,
+	const SRPPipeline* pl, SRPArena* arena, size_t startIndex, size_t count,
 	size_t* outPointCount, SRPPoint** outPoints
 )
 {
-	if (srpContext.raster.pointSize <= 0.)
-		return false;
-
 	const size_t nPoints = count;
-	SRPPoint* points = ARENA_ALLOC(sizeof(SRPPoint) * nPoints);
-	void* varyingBlock = ARENA_ALLOC(sp->vs->varyingsSize * nPoints);
+	SRPPoint* points = arenaAlloc(arena, sizeof(SRPPoint) * nPoints);
+
+	VertexCache cache;
+	allocateVertexCache(&cache, arena, ib, startIndex, count, pl->sp->vs->varyingsSize);
 
 	size_t primitiveID = 0;
 	for (size_t k = 0; k < nPoints; k++)
@@ -237,12 +343,12 @@ bool assemblePoints(
 		SRPPoint* p = &points[primitiveID];
 
 		size_t vertexIndex = (ib) ? indexIndexBuffer(ib, startIndex+k) : startIndex+k;
-		processVertex(vertexIndex, varyingBlock, k, vb, sp, &p->v);
+		p->v = *vertexCacheFetch(&cache, vertexIndex, vb, pl->sp);
 
 		if (clipPoint(p))
 			continue;
 
-		setupPoint(p);
+		setupPoint(p, fb);
 
 		p->id = primitiveID;
 		primitiveID++;
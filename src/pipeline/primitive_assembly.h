@@ -12,20 +12,80 @@
 #include "raster/point.h"
 #include "srp/shaders.h"
 #include "core/buffer_p.h"
+#include "core/pipeline_p.h"
+#include "memory/arena_p.h"
+#include "pipeline/vertex_processing.h"
+#include "pipeline/edge_set.h"
 
 /** @ingroup Primitive_assembly
  *  @{ */
 
+/** State of an incremental triangle assembly, allowing to assemble the
+ *  triangles of a draw call in batches. The post-VS cache and the primitive
+ *  IDs carry over from one batch to the next. An assembler may also cover
+ *  only a slice of the draw call, see triangleAssemblerSlice() */
+typedef struct TriangleAssembler {
+	const SRPIndexBuffer* ib;   /**< The index buffer, or `NULL` */
+	const SRPVertexBuffer* vb;  /**< The vertex buffer */
+	const SRPFramebuffer* fb;   /**< The framebuffer to draw to */
+	const SRPPipeline* pl;      /**< The pipeline to use */
+	SRPArena* arena;            /**< The arena to allocate the primitives in */
+	SRPPrimitive prim;          /**< Primitive type */
+	size_t startIndex;          /**< First stream index */
+	size_t nTriangles;          /**< Amount of triangles in the stream, before clipping */
+	size_t next;                /**< Next triangle of the stream to assemble */
+	size_t end;                 /**< One past the last triangle to assemble */
+	size_t primitiveID;         /**< ID of the next output primitive */
+	VertexCache cache;          /**< Post-VS cache shared by all the batches.
+	                                 Allocated on the first triangleAssemblerRun() */
+	EdgeSet edges;              /**< Wireframe edges emitted so far, if shared
+	                                 edges are drawn once (see SRPRasterState).
+	                                 Allocated on the first triangleAssemblerRun() */
+} TriangleAssembler;
+
+/** Start an incremental triangle assembly
+ *  @param[out] this The assembler to initialize
+ *  @see assembleTrianglesGeneric() for the rest of the parameters
+ *  @returns `false` if there are no triangles to assemble, `true` otherwise */
+bool triangleAssemblerInit(
+	TriangleAssembler* this, const SRPIndexBuffer* ib, const SRPVertexBuffer* vb,
+	const SRPFramebuffer* fb, const SRPPipeline* pl, SRPArena* arena,
+	SRPPrimitive prim, size_t startIndex, size_t vertexCount
+);
+
+/** Create an assembler for a slice of the triangles of another one. The
+ *  slice has its own post-VS cache, covering only the vertices it uses, so
+ *  slices may be assembled concurrently. Its primitive IDs start from 0
+ *  @param[out] this The assembler to initialize
+ *  @param[in] whole The assembler of the whole draw call, not run yet
+ *  @param[in] arena The arena to allocate the slice's memory in
+ *  @param[in] first First stream triangle of the slice
+ *  @param[in] count Amount of stream triangles in the slice */
+void triangleAssemblerSlice(
+	TriangleAssembler* this, const TriangleAssembler* whole, SRPArena* arena,
+	size_t first, size_t count
+);
+
+/** Assemble the next batch of triangles, converting them to lines or points
+ *  according to the set polygon mode. Uses memory from the assembler's arena
+ *  @param[in] this The assembler
+ *  @param[in] maxTriangles Maximal amount of stream triangles to consume
+ *  @param[out] outPrimitives Pointer to the array of assembled primitives
+ *  @returns Amount of assembled primitives. Once the stream is exhausted,
+ * 			 `this->next == this->end` */
+size_t triangleAssemblerRun(TriangleAssembler* this, size_t maxTriangles, void** outPrimitives);
+
 /** Call the vertex shader and assemble triangles from vertex or index buffer,
  *  possibly converting them to lines or points according to the set polygon mode.
  *  If `ib == NULL`, assembles from vertex buffer, else from index buffer.
- *  Uses memory from SRPArena, so the returned triangles are valid until the
+ *  Uses memory from `arena`, so the returned triangles are valid until the
  *  next call to arenaReset().
  *  @param[in] ib Pointer to index buffer, or `NULL` if assembling from vertex buffer
  *  @param[in] vb Pointer to vertex buffer
  *  @param[in] fb Pointer to the framebuffer to draw to (needed for NDC to
  * 				  screen-space conversion)
- *  @param[in] sp Pointer to the shader program to use
+ *  @param[in] pl Pointer to the pipeline to use
+ *  @param[in] arena The arena to allocate the primitives in
  *  @param[in] prim Primitive type (one of SRP_PRIM_TRIANGLES,
  * 					SRP_PRIM_TRIANGLE_STRIP or SRP_PRIM_TRIANGLE_FAN)
  *  @param[in] startIndex First stream index to assemble
@@ -36,19 +96,20 @@
  * 			 `*outCount` and `*outPrimitives` are 0 and NULL */
 bool assembleTrianglesGeneric(
     const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-    const SRPShaderProgram* sp, SRPPrimitive prim, size_t startIndex, size_t vertexCount,
+    const SRPPipeline* pl, SRPArena* arena, SRPPrimitive prim, size_t startIndex, size_t vertexCount,
     size_t* outCount, void** outPrimitives
 );
 
 /** Call the vertex shader and assemble lines from vertex or index buffer.
  *  If `ib == NULL`, assembles from vertex buffer, else from index buffer.
- *  Uses memory from SRPArena, so the returned points are valid until the
+ *  Uses memory from `arena`, so the returned points are valid until the
  *  next call to arenaReset().
  *  @param[in] ib Pointer to index buffer, or `NULL` if assembling from vertex buffer
  *  @param[in] vb Pointer to vertex buffer
  *  @param[in] fb Pointer to the framebuffer to draw to (needed for NDC to
  * 				  screen-space conversion)
- *  @param[in] sp Pointer to the shader program to use
+ *  @param[in] pl Pointer to the pipeline to use
+ *  @param[in] arena The arena to allocate the primitives in
  *  @param[in] primitive Primitive type (one of SRP_PRIM_LINES, SRP_PRIM_LINE_STRIP
  * 						 or SRP_PRIM_LINE_LOOP)
  *  @param[in] startIndex First stream index to assemble
@@ -59,19 +120,20 @@ bool assembleTrianglesGeneric(
  * 			`*outLineCount` and `*outLines` are undefined */
 bool assembleLines(
 	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, SRPPrimitive primitive, size_t startIndex, size_t count,
+	const SRPPipeline* pl, SRPArena* arena, SRPPrimitive primitive, size_t startIndex, size_t count,
 	size_t* outLineCount, SRPLine** outLines
 );
 
 /** Call the vertex shader and assemble points from vertex or index buffer.
  *  If `ib == NULL`, assembles from vertex buffer, else from index buffer.
- *  Uses memory from SRPArena, so the returned points are valid until the
+ *  Uses memory from `arena`, so the returned points are valid until the
  *  next call to arenaReset().
  *  @param[in] ib Pointer to index buffer, or `NULL` if assembling from vertex buffer
  *  @param[in] vb Pointer to vertex buffer
  *  @param[in] fb Pointer to the framebuffer to draw to (needed for NDC to
  * 				  screen-space conversion)
- *  @param[in] sp Pointer to the shader program to use
+ *  @param[in] pl Pointer to the pipeline to use
+ *  @param[in] arena The arena to allocate the primitives in
  *  @param[in] startIndex First stream index to assemble
  *  @param[in] count Number of stream indices to assemble
  *  @param[out] outPointCount Amount of assembled points
@@ -80,7 +142,7 @@ bool assembleLines(
  * 			`*outPointCount` and `*outPoints` are undefined */
 bool assemblePoints(
 	const SRPIndexBuffer* ib, const SRPVertexBuffer* vb, const SRPFramebuffer* fb,
-	const SRPShaderProgram* sp, size_t startIndex, size_t count,
+	const SRPPipeline* pl, SRPArena* arena, size_t startIndex, size_t count,
 	size_t* outPointCount, SRPPoint** outPoints
 );
 
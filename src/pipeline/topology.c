@@ -47,6 +47,31 @@ void resolveTriangleTopology(size_t base, size_t rawTriIdx, SRPPrimitive prim, s
 		abort();
 }
 
+void resolveTriangleStreamRange(
+	size_t base, size_t first, size_t count, SRPPrimitive prim,
+	size_t* outStart, size_t* outCount
+)
+{
+	if (prim == SRP_PRIM_TRIANGLES)
+	{
+		*outStart = base + first * 3;
+		*outCount = count * 3;
+	}
+	else if (prim == SRP_PRIM_TRIANGLE_STRIP)
+	{
+		*outStart = base + first;
+		*outCount = count + 2;
+	}
+	else if (prim == SRP_PRIM_TRIANGLE_FAN)
+	{
+		// Every triangle of a fan shares the base vertex
+		*outStart = base;
+		*outCount = first + count + 2;
+	}
+	else
+		abort();
+}
+
 size_t computeLineCount(size_t vertexCount, SRPPrimitive prim)
 {
 	if (prim == SRP_PRIM_LINES)
@@ -29,6 +29,18 @@ void resolveTriangleTopology(
 	size_t base, size_t rawTriIdx, SRPPrimitive prim, size_t* out
 );
 
+/** Determine the range of stream indices a range of triangles is made of
+ *  @param[in] base Base stream index
+ *  @param[in] first Index of the first triangle, as in resolveTriangleTopology()
+ *  @param[in] count Amount of triangles. Must be > 0
+ *  @param[in] prim Primitive type
+ *  @param[out] outStart First stream index of the range
+ *  @param[out] outCount Amount of stream indices in the range */
+void resolveTriangleStreamRange(
+	size_t base, size_t first, size_t count, SRPPrimitive prim,
+	size_t* outStart, size_t* outCount
+);
+
 /** Deduce the number of lines to assemble based on the number of vertices
  *  and primitive type
  *  @param[in] vertexCount Number of vertices
@@ -21,7 +21,7 @@ static void computeMinMaxVI(
 );
 
 void allocateVertexCache(
-	VertexCache* cache, const SRPIndexBuffer* ib, size_t startIndex,
+	VertexCache* cache, SRPArena* arena, const SRPIndexBuffer* ib, size_t startIndex,
 	size_t vertexCount, size_t varyingSize
 )
 {
@@ -31,8 +31,8 @@ void allocateVertexCache(
 	// Setting all cache to zero before using it (calloc)
 	cache->baseVertex = minVI;
 	cache->size = maxVI - minVI + 1;
-	cache->entries = ARENA_CALLOC(sizeof(VertexCacheEntry) * cache->size);
-	cache->varyingBlock = ARENA_ALLOC(varyingSize * cache->size);
+	cache->entries = arenaCalloc(arena, sizeof(VertexCacheEntry) * cache->size);
+	cache->varyingBlock = arenaAlloc(arena, varyingSize * cache->size);
 }
 
 SRPVertexShaderOut* vertexCacheFetch(
@@ -67,7 +67,8 @@ void processVertex(
 	};
 	*outV = (SRPVertexShaderOut) {
 		.clipPosition = {0},
-		.varyings = pVarying
+		.varyings = pVarying,
+		.pointSize = 0
 	};
 
 	sp->vs->shader(&vsIn, outV);
@@ -9,6 +9,7 @@
 
 #include "srp/shaders.h"
 #include "core/buffer_p.h"
+#include "memory/arena_p.h"
 
 /** @ingroup Vertex_processing
  *  @{ */
@@ -31,12 +32,13 @@ typedef struct VertexCache {
 
 /** Initialize / allocate vertex cache
  *  @param[in] cache Pointer to the cache
+ *  @param[in] arena The arena to allocate the cache in
  *  @param[in] ib The SRPIndexBuffer being used
  *  @param[in] startIndex First stream index
  *  @param[in] vertexCount How many vertices from the `ib` you want to process
  *  @param[in] varyingSize The size of varying vertex parameters, in bytes */
 void allocateVertexCache(
-	VertexCache* cache, const SRPIndexBuffer* ib, size_t startIndex,
+	VertexCache* cache, SRPArena* arena, const SRPIndexBuffer* ib, size_t startIndex,
 	size_t vertexCount, size_t varyingSize
 );
 
@@ -6,95 +6,112 @@
  *  Fragment emission implementation */
 
 #include <math.h>
+#include <string.h>
 #include <assert.h>
 #include "raster/fragment.h"
-#include "srp/context.h"
 #include "core/color_p.h"
 #include "math/utils.h"
-#include "utils/message_callback_p.h"
 
 /** @ingroup Rasterization
  *  @{ */
 
-/** Perform a scissor test, respecting the user-set runtime options
+/** Perform a scissor test against the pipeline's precomputed scissor box
+ *  @param[in] pl The pipeline to use
  *  @param[in] x,y Window-space position of the currently processed fragment
  *  @return `true` if scissor test passes, `false` otherwise */
-static inline bool scissorTest(size_t x, size_t y);
+static inline bool scissorTest(const SRPPipeline* pl, size_t x, size_t y);
 
 /** Perform an initial stage of the stencil test and potentially apply fail
- *  operation to the stencil value. Checks if the stencil test is enabled.
+ *  operation to the stencil value. Does not check if the stencil test is enabled.
  *  @param[in] stencil Pointer to the current stencil value
  *  @param[in] s Pointer to the stencil state to use */ 
-static inline bool stencilTest(uint8_t* stencil, const SRPStencilFaceState* s);
+static inline bool stencilTest(uint8_t* stencil, const PipelineStencilFace* s);
 
-/** Compare two masked stencil values with a certain operation
- *  @param[in] ref The reference stencil value
- *  @param[in] stored The stored stencil value
- *  @param[in] mask The mask to use with both values
- *  @param[in] op Operation to compare with */
-static inline bool stencilCompare(uint8_t ref, uint8_t stored, uint8_t mask, SRPCompareOp op);
-
-/** Apply a "stencil test failed" operation to a stencil value
- *  @param[in] stencil Pointer to the current stencil value
- *  @param[in] s Pointer to the stencil state to use */ 
-static inline void stencilFailOp(uint8_t* stencil, const SRPStencilFaceState* s);
-
-/** Apply a "stencil test passed, depth test failed" operation to a stencil value
+/** Apply a stencil operation to a stencil value, respecting the write mask
  *  @param[in] stencil Pointer to the current stencil value
- *  @param[in] s Pointer to the stencil state to use */ 
-static inline void stencilDepthFailOp(uint8_t* stencil, const SRPStencilFaceState* s);
-
-/** Apply a "stencil and depth tests passed" operation to a stencil value
- *  @param[in] stencil Pointer to the current stencil value
- *  @param[in] s Pointer to the stencil state to use */ 
-static inline void stencilPassOp(uint8_t* stencil, const SRPStencilFaceState* s);
-
-/** Apply an operation to a stencil value */
-static inline uint8_t applyStencilOp(SRPStencilOp op, uint8_t stored, uint8_t ref);
-
-/** Perform a depth test, respecting the user-set compare operation and
- *  whether or not the test is enabled
- *  @param[in] incoming The depth value of the currently processed fragment
- *  @param[in] stored The depth value stored in the depth buffer
- *  @return `true` if depth test passes, `false` otherwise */
-static inline bool depthTest(float incoming, float stored);
+ *  @param[in] s Pointer to the stencil state to use
+ *  @param[in] op The operation to apply (one of `s`'s operations) */
+static inline void stencilApplyOp(
+    uint8_t* stencil, const PipelineStencilFace* s, StencilOpFunc op
+);
+
+/** Write a color to color attachments 1 and above, blending it with the
+ *  stored one by coverage
+ *  @param[in] fb The framebuffer to write to
+ *  @param[in] index Index of the pixel, `y * width + x`
+ *  @param[in] colors Colors to write, SRPFragmentShaderOut.extraColors
+ *  @param[in] coverage Fraction of the pixel covered by the primitive */
+static inline void writeExtraColors(
+    const SRPFramebuffer* fb, size_t index,
+    float colors[SRP_MAX_COLOR_ATTACHMENTS - 1][4], float coverage
+);
+
+/** Shared implementation of emitFragment() and emitFragmentCoverage()
+ *  @see emitFragmentCoverage() */
+static inline void processFragment(
+    const SRPFramebuffer* fb, const SRPPipeline* pl,
+    int x, int y, SRPFragmentShaderIn* fsIn, float coverage
+);
 
 
 void emitFragment(
-    const SRPFramebuffer* fb, const SRPShaderProgram* sp,
+    const SRPFramebuffer* fb, const SRPPipeline* pl,
     int x, int y, SRPFragmentShaderIn* fsIn
 )
+{
+    processFragment(fb, pl, x, y, fsIn, 1);
+}
+
+void emitFragmentCoverage(
+    const SRPFramebuffer* fb, const SRPPipeline* pl,
+    int x, int y, SRPFragmentShaderIn* fsIn, float coverage
+)
+{
+    processFragment(fb, pl, x, y, fsIn, coverage);
+}
+
+static inline void processFragment(
+    const SRPFramebuffer* fb, const SRPPipeline* pl,
+    int x, int y, SRPFragmentShaderIn* fsIn, float coverage
+)
 {
     assert(x >= 0 && x < fb->width);
     assert(y >= 0 && y < fb->height);
 
-    if (!scissorTest(x, y))
+    if (!scissorTest(pl, x, y))
         return;
 
-    uint32_t* pColor; float* pDepth; uint8_t* pStencil;
+    void* pColor; float* pDepth; uint8_t* pStencil;
     framebufferGetPointers(fb, x, y, &pColor, &pDepth, &pStencil);
     
+    const SRPShaderProgram* sp = pl->sp;
     const bool earlyDepthTest = !sp->fs->mayOverwriteDepth;
-    const bool stencilTestEnabled = srpContext.stencil.enabled;
-    const SRPStencilFaceState* stencilState = \
-        (fsIn->frontFacing) ? &srpContext.stencil.front : &srpContext.stencil.back;
+    const bool stencilTestEnabled = pl->stencilEnabled;
+    const PipelineStencilFace* stencilState = &pl->stencil[(fsIn->frontFacing) ? 0 : 1];
     const float storedDepth = *pDepth;
     float depth = fsIn->fragCoord[2];
 
-    if (!stencilTest(pStencil, stencilState))
+    if (stencilTestEnabled && !stencilTest(pStencil, stencilState))
         return;
 
     if (earlyDepthTest)
     {
-        if (!depthTest(depth, storedDepth))
+        if (!pl->depthTest(depth, storedDepth))
         {
             if (stencilTestEnabled)
-                stencilDepthFailOp(pStencil, stencilState);
+                stencilApplyOp(pStencil, stencilState, stencilState->dfailOp);
             return;
         }
     }
 
-    SRPFragmentShaderOut fsOut = { .color = {0}, .fragDepth = NAN };
+    // Extra colors are only zeroed when they are used, so that single
+    // attachment framebuffers do not pay for them on every fragment
+    SRPFragmentShaderOut fsOut;
+    memset(fsOut.color, 0, sizeof(fsOut.color));
+    fsOut.fragDepth = NAN;
+    fsOut.packedColor = 0;
+    if (fb->nColorAttachments > 1)
+        memset(fsOut.extraColors, 0, sizeof(fsOut.extraColors));
     sp->fs->shader(fsIn, &fsOut);
 
     if (!earlyDepthTest)
@@ -102,146 +119,89 @@ void emitFragment(
         if (!isnan(fsOut.fragDepth))
             depth = fsOut.fragDepth;
         
-        if (!depthTest(depth, storedDepth))
+        if (!pl->depthTest(depth, storedDepth))
         {
             if (stencilTestEnabled)
-                stencilDepthFailOp(pStencil, stencilState);
+                stencilApplyOp(pStencil, stencilState, stencilState->dfailOp);
             return;
         }
     }
 
     if (stencilTestEnabled)
-        stencilPassOp(pStencil, stencilState);
+        stencilApplyOp(pStencil, stencilState, stencilState->passOp);
 
     // If this is failed, this is the problem of library code
     // Not a direct check because of floating point imprecisions
     assert(ROUGHLY_GREATER_OR_EQUAL(depth, -1) && ROUGHLY_LESS_OR_EQUAL(depth, 1));
 
-    *pColor = colorPack(fsOut.color);
+    const SRPColorFormat format = fb->colorFormat;
+    if (coverage < 1)
+    {
+        float stored[4];
+        colorRead(format, pColor, stored);
+        if (sp->fs->writesPackedColor)
+            colorUnpack(fsOut.packedColor, fsOut.color);
+        for (uint8_t i = 0; i < 4; i++)
+            fsOut.color[i] = fsOut.color[i] * coverage + stored[i] * (1 - coverage);
+        colorWrite(format, pColor, fsOut.color);
+    }
+    else if (sp->fs->writesPackedColor)
+        colorWritePacked(format, pColor, fsOut.packedColor);
+    else
+        colorWrite(format, pColor, fsOut.color);
+
+    if (fb->nColorAttachments > 1)
+        writeExtraColors(fb, y * fb->width + x, fsOut.extraColors, coverage);
 
-    // Cannot write when not testing (mimicking OpenGL behaviour)
-    if (srpContext.depth.testEnable && srpContext.depth.writeEnable)
+    if (pl->depthWrite)
         *pDepth = depth;
 }
 
-static inline bool scissorTest(size_t x, size_t y)
+static inline void writeExtraColors(
+    const SRPFramebuffer* fb, size_t index,
+    float colors[SRP_MAX_COLOR_ATTACHMENTS - 1][4], float coverage
+)
 {
-    if (!srpContext.scissor.enabled)  // Always pass when disabled
-        return true;
-
-    const size_t x0 = srpContext.scissor.x;
-    const size_t x1 = srpContext.scissor.x + srpContext.scissor.width;
-    const size_t y0 = srpContext.scissor.y;
-    const size_t y1 = srpContext.scissor.y + srpContext.scissor.height;
-
-    if (x < x0 || x >= x1 || y < y0 || y >= y1)
-        return false;
-    return true;
+    for (size_t a = 0; a + 1 < fb->nColorAttachments; a++)
+    {
+        const SRPColorFormat format = fb->extraColorFormat[a];
+        void* pColor = framebufferExtraPixel(fb, a, index);
+        if (coverage < 1)
+        {
+            float stored[4];
+            colorRead(format, pColor, stored);
+            for (uint8_t i = 0; i < 4; i++)
+                colors[a][i] = colors[a][i] * coverage + stored[i] * (1 - coverage);
+        }
+        colorWrite(format, pColor, colors[a]);
+    }
 }
 
-static inline bool stencilTest(uint8_t* stencil, const SRPStencilFaceState* s)
+static inline bool scissorTest(const SRPPipeline* pl, size_t x, size_t y)
 {
-    if (!srpContext.stencil.enabled)
-        return true;
+    return x >= pl->scissorMinX && x < pl->scissorMaxX &&
+           y >= pl->scissorMinY && y < pl->scissorMaxY;
+}
 
-    bool passed = stencilCompare(s->ref, *stencil, s->mask, s->func);
+static inline bool stencilTest(uint8_t* stencil, const PipelineStencilFace* s)
+{
+    bool passed = s->compare(s->maskedRef, *stencil & s->mask);
     if (!passed)
     {
-        stencilFailOp(stencil, s);
+        stencilApplyOp(stencil, s, s->sfailOp);
         return false;
     }
     return true;
 }
 
-static inline bool stencilCompare(uint8_t ref, uint8_t stored, uint8_t mask, SRPCompareOp op)
-{
-    uint8_t lhs = ref & mask;
-    uint8_t rhs = stored & mask;
-
-    switch (op)
-    {
-        case SRP_COMPARE_NEVER:    return false;
-        case SRP_COMPARE_ALWAYS:   return true;
-        case SRP_COMPARE_LESS:     return lhs <  rhs;
-        case SRP_COMPARE_LEQUAL:   return lhs <= rhs;
-        case SRP_COMPARE_GREATER:  return lhs >  rhs;
-        case SRP_COMPARE_GEQUAL:   return lhs >= rhs;
-        case SRP_COMPARE_EQUAL:    return lhs == rhs;
-        case SRP_COMPARE_NOTEQUAL: return lhs != rhs;
-        default:
-            srpMessageCallbackHelper(
-                SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
-                "Unknown stencil operation (%i), fallback to SRP_COMPARE_NEVER", op
-            );
-            return false;
-    }
-}
-
-static inline void stencilFailOp(uint8_t* stencil, const SRPStencilFaceState* s)
+static inline void stencilApplyOp(
+    uint8_t* stencil, const PipelineStencilFace* s, StencilOpFunc op
+)
 {
     const uint8_t mask = s->writeMask;
     const uint8_t current = *stencil;
-    uint8_t val = applyStencilOp(s->sfailOp, *stencil, s->ref);
+    uint8_t val = op(current, s->ref);
     *stencil = (current & ~mask) | (val & mask);  // Only modify masked bits
 }
 
-static inline void stencilDepthFailOp(uint8_t* stencil, const SRPStencilFaceState* s)
-{
-    const uint8_t mask = s->writeMask;
-    const uint8_t current = *stencil;
-    uint8_t val = applyStencilOp(s->dfailOp, *stencil, s->ref);
-    *stencil = (current & ~mask) | (val & mask);
-}
-
-static inline void stencilPassOp(uint8_t* stencil, const SRPStencilFaceState* s)
-{
-    const uint8_t mask = s->writeMask;
-    const uint8_t current = *stencil;
-    uint8_t val = applyStencilOp(s->passOp, *stencil, s->ref);
-    *stencil = (current & ~mask) | (val & mask);
-}
-
-static inline uint8_t applyStencilOp(SRPStencilOp op, uint8_t stored, uint8_t ref)
-{
-    switch (op)
-    {
-        case SRP_STENCIL_KEEP:      return stored;
-        case SRP_STENCIL_ZERO:      return 0;
-        case SRP_STENCIL_REPLACE:   return ref;
-        case SRP_STENCIL_INCR:      return (stored < 255) ? stored + 1 : 255;
-        case SRP_STENCIL_INCR_WRAP: return stored + 1;
-        case SRP_STENCIL_DECR:      return (stored > 0) ? stored - 1 : 0;
-        case SRP_STENCIL_DECR_WRAP: return stored - 1;
-        case SRP_STENCIL_INVERT:    return ~stored;
-        default:
-            srpMessageCallbackHelper(
-                SRP_MESSAGE_ERROR, SRP_MESSAGE_SEVERITY_HIGH, __func__,
-                "Unknown stencil operation (%i), fallback to SRP_STENCIL_KEEP", op
-            );
-            return stored;
-    }
-}
-
-static inline bool depthTest(float incoming, float stored)
-{
-    const SRPDepthState* depth = &srpContext.depth;
-
-    if (!depth->testEnable)  // Always pass when disabled
-        return true;
-
-    switch (depth->compareOp)
-    {
-        case SRP_COMPARE_NEVER:    return false;
-        case SRP_COMPARE_ALWAYS:   return true;
-        case SRP_COMPARE_LESS:     return incoming <  stored;
-        case SRP_COMPARE_LEQUAL:   return incoming <= stored;
-        case SRP_COMPARE_GREATER:  return incoming >  stored;
-        case SRP_COMPARE_GEQUAL:   return incoming >= stored;
-        case SRP_COMPARE_EQUAL:    return incoming == stored;
-        case SRP_COMPARE_NOTEQUAL: return incoming != stored;
-    }
-
-    return false;
-}
-
 /** @} */  // ingroup Rasterization
@@ -9,19 +9,32 @@
 
 #include "core/framebuffer_p.h"
 #include "srp/shaders.h"
+#include "core/pipeline_p.h"
 
 /** @ingroup Rasterization
  *  @{ */
 
 /** Perform (early) depth check, run fragment shader, and draw a pixel
  *  @param[in] fb The framebuffer to use
- *  @param[in] sp The shader program to use
+ *  @param[in] pl The pipeline to use
  *  @param[in] x,y Coordinates of the pixel
  *  @param[in] fsIn Fragment shader input
 */
 void emitFragment(
-    const SRPFramebuffer* fb, const SRPShaderProgram* sp,
+    const SRPFramebuffer* fb, const SRPPipeline* pl,
     int x, int y, SRPFragmentShaderIn* fsIn
 );
 
+/** Same as emitFragment(), but for a fragment only partially covering its
+ *  pixel: the shaded color is blended over the stored one by the coverage
+ *  @param[in] fb The framebuffer to use
+ *  @param[in] pl The pipeline to use
+ *  @param[in] x,y Coordinates of the pixel
+ *  @param[in] fsIn Fragment shader input
+ *  @param[in] coverage Covered part of the pixel, in (0, 1] */
+void emitFragmentCoverage(
+    const SRPFramebuffer* fb, const SRPPipeline* pl,
+    int x, int y, SRPFragmentShaderIn* fsIn, float coverage
+);
+
 /** @} */  // ingroup Rasterization
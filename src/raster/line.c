@@ -6,93 +6,340 @@
  *  Line rasterization implementation */
 
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "raster/line.h"
 #include "raster/fragment.h"
+#include "core/framebuffer_p.h"
 #include "pipeline/interpolation.h"
 #include "pipeline/vertex_processing.h"
-#include "srp/context.h"
+#include "math/utils.h"
 #include "utils/voidptr.h"
 #include "utils/message_callback_p.h"
 
 /** @ingroup Rasterization
  *  @{ */
 
-/** Interpolate the fragment position and vertex variables inside the line.
- *  @param[in] line Line to interpolate data for
+/** Amount of fractional bits of the fixed-point screen-space coordinates
+ *  lines are rasterized in */
+#define LINE_SUBPIXEL_BITS 8
+/** One pixel in the fixed-point coordinates */
+#define LINE_ONE (1 << LINE_SUBPIXEL_BITS)
+/** Half a pixel in the fixed-point coordinates */
+#define LINE_HALF (LINE_ONE / 2)
+
+/** Divide and round towards negative infinity
+ *  @param[in] a The dividend
+ *  @param[in] b The divisor, must be positive
+ *  @return floor(a / b) */
+static inline int64_t floorDiv(int64_t a, int64_t b);
+
+/** Check if a fixed-point point lies inside the diamond of a pixel, i.e.
+ *  `|x - cx| + |y - cy| < 0.5` where (cx, cy) is the pixel's center
+ *  @param[in] x,y The point
+ *  @param[in] px,py The pixel
+ *  @return Whether or not the point is inside the diamond */
+static inline bool insideDiamond(int64_t x, int64_t y, int64_t px, int64_t py);
+
+/** Rasterize an antialiased line as a rectangle of the line's width,
+ *  producing the pixels it covers with their coverage
+ *  @param[in] line The line
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] varyings The line's varyings, as prepared by linearVaryingsInit()
+ *  @param[in] nVaryings Amount of `varyings`
+ *  @param[in] interpolatedBuffer @see rasterizeLine() */
+static void rasterizeLineSmooth(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	const LinearVarying* varyings, size_t nVaryings, void* interpolatedBuffer
+);
+
+/** Produce the run of pixels of a wide aliased line at one sample: `width`
+ *  pixels along the minor axis, centered on the sampled pixel
+ *  @param[in] line The line
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] xMajor Whether X is the major axis
+ *  @param[in] a,b The sampled pixel, along the major and the minor axis
+ *  @param[in] width Line width, in pixels
+ *  @param[in] t Interpolation parameter (0 -> 0th vertex; 1 -> 1st vertex)
+ *  @param[in] varyings The line's varyings, as prepared by linearVaryingsInit()
+ *  @param[in] nVaryings Amount of `varyings`
+ *  @param[in] interpolatedBuffer @see rasterizeLine() */
+static void shadeLineRun(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	bool xMajor, int64_t a, int64_t b, int64_t width, float t,
+	const LinearVarying* varyings, size_t nVaryings, void* interpolatedBuffer
+);
+
+/** Interpolate the data of a fragment of the line, run the fragment shader
+ *  on it and write the result. Fragments outside the framebuffer are dropped
+ *  @param[in] line The line
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] x,y The pixel
  *  @param[in] t Interpolation parameter (0 -> 0th vertex; 1 -> 1st vertex)
- *  @param[in] sp A pointer to shader program to use
- *  @param[out] pInterpolatedBuffer A pointer to the buffer where interpolated
- *              variables will appear. Must be big enough to hold all of them
- *  @param[out] depth Fragment depth
- *  @param[out] recIntInvW Reciprocal of interpolated inverse Wclip */
-static void lineInterpolateData(
-	SRPLine* line, float t, const SRPShaderProgram* restrict sp,
-	SRPInterpolated* pInterpolatedBuffer, float* depth, float* recIntInvW
+ *  @param[in] coverage Covered part of the pixel, 1 for aliased lines
+ *  @param[in] varyings The line's varyings, as prepared by linearVaryingsInit()
+ *  @param[in] nVaryings Amount of `varyings`
+ *  @param[in] interpolatedBuffer @see rasterizeLine() */
+static void shadeLinePixel(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	int64_t x, int64_t y, float t, float coverage,
+	const LinearVarying* varyings, size_t nVaryings, void* interpolatedBuffer
+);
+
+/** Add the bounding box of the pixels a line may cover to the damage of the
+ *  framebuffer, see framebufferAddDamage() */
+static void addLineDamage(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl
 );
 
 void rasterizeLine(
 	SRPLine* line, const SRPFramebuffer* fb,
-	const SRPShaderProgram* restrict sp, void* interpolatedBuffer
+	const SRPPipeline* restrict pl, void* interpolatedBuffer
+)
+{
+	const size_t maxVaryings = linearVaryingsMaxCount(pl);
+	LinearVarying varyings[(maxVaryings > 0) ? maxVaryings : 1];
+	const size_t nVaryings = linearVaryingsInit(
+		line->v, line->invW, pl, varyings, interpolatedBuffer
+	);
+	addLineDamage(line, fb, pl);
+
+	if (pl->state.raster.lineSmooth)
+	{
+		rasterizeLineSmooth(line, fb, pl, varyings, nVaryings, interpolatedBuffer);
+		return;
+	}
+
+	const vec3* ss = line->ss;  // alias
+	const int64_t x0 = llroundf(ss[0].x * LINE_ONE), y0 = llroundf(ss[0].y * LINE_ONE);
+	const int64_t x1 = llroundf(ss[1].x * LINE_ONE), y1 = llroundf(ss[1].y * LINE_ONE);
+
+	// Diamond-exit rule: a pixel is produced if the line exits its diamond.
+	// A line that starts and ends inside one diamond never exits it
+	const int64_t px0 = floorDiv(x0, LINE_ONE), py0 = floorDiv(y0, LINE_ONE);
+	const int64_t px1 = floorDiv(x1, LINE_ONE), py1 = floorDiv(y1, LINE_ONE);
+	const bool startInside = insideDiamond(x0, y0, px0, py0);
+	const bool endInside = insideDiamond(x1, y1, px1, py1);
+	if (startInside && px0 == px1 && py0 == py1 && endInside)
+		return;
+
+	// Walk the major axis (A), sampling the line at pixel centers of A in
+	// [a0, a1), and find the pixel of the minor axis (B) at each of them
+	const bool xMajor = llabs(x1 - x0) >= llabs(y1 - y0);
+	const int64_t a0 = (xMajor) ? x0 : y0, b0 = (xMajor) ? y0 : x0;
+	const int64_t a1 = (xMajor) ? x1 : y1, b1 = (xMajor) ? y1 : x1;
+	const int64_t da = a1 - a0, db = b1 - b0;
+	const int64_t s = (da > 0) ? 1 : -1;
+	const int64_t D = llabs(da);
+
+	// First sampled pixel along A and amount of samples
+	int64_t first, n;
+	if (s > 0)
+	{
+		first = -floorDiv(-(a0 - LINE_HALF), LINE_ONE);
+		n = -floorDiv(-(a1 - LINE_HALF), LINE_ONE) - first;
+	}
+	else
+	{
+		first = floorDiv(a0 - LINE_HALF, LINE_ONE);
+		n = first - floorDiv(a1 - LINE_HALF, LINE_ONE);
+	}
+	n = MAX(n, 0);
+
+	// B of the sample k is floor(N_k / Q), N_k = N_0 + k * 256 * db.
+	// Stepped as quotient and remainder, so that no division is left
+	const int64_t Q = D * LINE_ONE;
+	const int64_t centerA = first * LINE_ONE + LINE_HALF;
+	const int64_t N0 = b0 * D + s * (centerA - a0) * db;
+	int64_t b = floorDiv(N0, Q);
+	int64_t r = N0 - b * Q;
+	const int64_t inc = LINE_ONE * db;
+	const int64_t bStep = floorDiv(inc, Q);
+	const int64_t rStep = inc - bStep * Q;
+
+	// The last sample is not produced if the line ends inside its diamond
+	if (n > 0 && endInside)
+	{
+		const int64_t lastA = first + s * (n - 1);
+		const int64_t lastB = floorDiv(N0 + (n - 1) * inc, Q);
+		const int64_t lastX = (xMajor) ? lastA : lastB;
+		const int64_t lastY = (xMajor) ? lastB : lastA;
+		if (lastX == px1 && lastY == py1)
+			n--;
+	}
+
+	const int64_t width = MAX(llroundf(pl->state.raster.lineWidth), 1);
+
+	// The start pixel is exited, but it is not sampled if the line starts
+	// past its center
+	const int64_t firstX = (xMajor) ? first : b;
+	const int64_t firstY = (xMajor) ? b : first;
+	if (startInside && (n == 0 || firstX != px0 || firstY != py0))
+	{
+		shadeLineRun(
+			line, fb, pl, xMajor, (xMajor) ? px0 : py0, (xMajor) ? py0 : px0,
+			width, 0, varyings, nVaryings, interpolatedBuffer
+		);
+	}
+
+	const float t0 = (float) (s * (centerA - a0)) / D;
+	const float dt = (float) LINE_ONE / D;
+	for (int64_t k = 0; k < n; k++)
+	{
+		const int64_t a = first + s * k;
+		const float t = t0 + dt * k;
+		shadeLineRun(
+			line, fb, pl, xMajor, a, b, width, t, varyings, nVaryings, interpolatedBuffer
+		);
+
+		b += bStep;
+		r += rStep;
+		if (r >= Q)
+		{
+			r -= Q;
+			b++;
+		}
+	}
+}
+
+static void addLineDamage(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl
 )
 {
-    const vec3* ss = line->ss;  // alias
-
-    float dx = ss[1].x - ss[0].x;
-    float dy = ss[1].y - ss[0].y;
-
-    int steps = (int) ceil(fmax(fabs(dx), fabs(dy)));
-	if (steps == 0)
-		steps = 1;
-
-    float xInc = dx / steps;
-    float yInc = dy / steps;
-    float tInc = 1. / steps;
-
-    float x = ss[0].x;
-    float y = ss[0].y;
-    float t = 0.;
-
-    for (int i = 0; i <= steps; i++)
-    {
-        int px = (int) round(x);
-        int py = (int) round(y);
-
-        float depth, recIntInvW;
-        lineInterpolateData(line, t, sp, interpolatedBuffer, &depth, &recIntInvW);
-
-        SRPFragmentShaderIn fsIn = {
-            .uniform = sp->uniform,
-            .varyings = interpolatedBuffer,
-            .fragCoord = { px + 0.5, py + 0.5, depth, recIntInvW },
-            .frontFacing = true,
-            .primitiveID = line->id,
-        };
-        emitFragment(fb, sp, px, py, &fsIn);
-
-        x += xInc;
-        y += yInc;
-        t += tInc;
-    }
+	// Pixels of both wide and smooth lines are at most `lineWidth / 2 + 1`
+	// pixels away from the line along the minor axis, which is up to sqrt(2)
+	// times that in any direction
+	const vec3* ss = line->ss;  // alias
+	const float margin = pl->state.raster.lineWidth + 2;
+	const float width = fb->width, height = fb->height;
+	framebufferAddDamage(
+		fb,
+		CLAMP(0, width, floorf(MIN(ss[0].x, ss[1].x) - margin)),
+		CLAMP(0, height, floorf(MIN(ss[0].y, ss[1].y) - margin)),
+		CLAMP(0, width, ceilf(MAX(ss[0].x, ss[1].x) + margin)),
+		CLAMP(0, height, ceilf(MAX(ss[0].y, ss[1].y) + margin))
+	);
 }
 
-void setupLine(SRPLine* line, const SRPFramebuffer* fb) 
+void setupLine(SRPLine* line, const SRPFramebuffer* fb)
 {
-	for (uint8_t i = 0; i < 3; i++)
+	for (uint8_t i = 0; i < 2; i++)
 		applyPerspectiveDivide(&line->v[i], &line->invW[i]);
 
-    for (uint8_t i = 0; i < 2; i++)
-        framebufferNDCToScreenSpace(fb, line->v[i].ndcPosition, (float*) &line->ss[i]);
+	for (uint8_t i = 0; i < 2; i++)
+		framebufferNDCToScreenSpace(fb, line->v[i].ndcPosition, (float*) &line->ss[i]);
+}
+
+static void rasterizeLineSmooth(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	const LinearVarying* varyings, size_t nVaryings, void* interpolatedBuffer
+)
+{
+	const vec3* ss = line->ss;  // alias
+	const float dx = ss[1].x - ss[0].x, dy = ss[1].y - ss[0].y;
+	const float length = sqrtf(dx * dx + dy * dy);
+	if (length == 0)
+		return;
+	const float ux = dx / length, uy = dy / length;
+
+	// Pixel centers farther than this from the line are not covered at all
+	const float reach = pl->state.raster.lineWidth / 2 + 0.5;
+
+	// Walk the major axis (A) along the whole rectangle and visit the pixels
+	// of the minor axis (B) the rectangle may cover there
+	const bool xMajor = fabsf(dx) >= fabsf(dy);
+	const float a0 = (xMajor) ? ss[0].x : ss[0].y, a1 = (xMajor) ? ss[1].x : ss[1].y;
+	const float b0 = (xMajor) ? ss[0].y : ss[0].x;
+	const float slope = ((xMajor) ? dy : dx) / (a1 - a0);
+	const float extent = reach * length / fabsf(a1 - a0);
+
+	const int64_t aFirst = floorf(MIN(a0, a1) - reach);
+	const int64_t aLast = floorf(MAX(a0, a1) + reach);
+	for (int64_t a = aFirst; a <= aLast; a++)
+	{
+		const float center = b0 + (a + 0.5 - a0) * slope;
+		const int64_t bLast = floorf(center + extent);
+		for (int64_t b = floorf(center - extent); b <= bLast; b++)
+		{
+			const int64_t x = (xMajor) ? a : b, y = (xMajor) ? b : a;
+			const float cx = x + 0.5 - ss[0].x, cy = y + 0.5 - ss[0].y;
+			const float along = cx * ux + cy * uy;
+			const float across = fabsf(cx * uy - cy * ux);
+
+			// Approximate area of the pixel inside the rectangle, including
+			// its flat ends
+			const float coverage = \
+				CLAMP(0, 1, reach - across) *
+				CLAMP(0, 1, along + 0.5) *
+				CLAMP(0, 1, length - along + 0.5);
+			if (coverage <= 0)
+				continue;
+
+			shadeLinePixel(
+				line, fb, pl, x, y, along / length, coverage,
+				varyings, nVaryings, interpolatedBuffer
+			);
+		}
+	}
 }
 
-static void lineInterpolateData(
-	SRPLine* line, float t, const SRPShaderProgram* restrict sp,
-	SRPInterpolated* pInterpolatedBuffer, float* depth, float* recIntInvW
+static void shadeLineRun(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	bool xMajor, int64_t a, int64_t b, int64_t width, float t,
+	const LinearVarying* varyings, size_t nVaryings, void* interpolatedBuffer
 )
 {
+	for (int64_t minor = b - (width - 1) / 2; minor <= b + width / 2; minor++)
+	{
+		shadeLinePixel(
+			line, fb, pl, (xMajor) ? a : minor, (xMajor) ? minor : a, t, 1,
+			varyings, nVaryings, interpolatedBuffer
+		);
+	}
+}
+
+static inline int64_t floorDiv(int64_t a, int64_t b)
+{
+	const int64_t q = a / b;
+	return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+static inline bool insideDiamond(int64_t x, int64_t y, int64_t px, int64_t py)
+{
+	const int64_t cx = px * LINE_ONE + LINE_HALF, cy = py * LINE_ONE + LINE_HALF;
+	return llabs(x - cx) + llabs(y - cy) < LINE_HALF;
+}
+
+static void shadeLinePixel(
+	const SRPLine* line, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	int64_t x, int64_t y, float t, float coverage,
+	const LinearVarying* varyings, size_t nVaryings, void* interpolatedBuffer
+)
+{
+	// Clipped lines may touch the far edges of the framebuffer
+	if (x < 0 || y < 0 || x >= (int64_t) fb->width || y >= (int64_t) fb->height)
+		return;
+
+	t = CLAMP(0, 1, t);
 	const float weights[2] = {1-t, t};
-	interpolateDepthAndWLine(line->v, weights, line->invW, sp, depth, recIntInvW);
-	interpolateAttributes(line->v, 2, weights, line->invW, *recIntInvW, sp, pInterpolatedBuffer);
+	float depth, recIntInvW;
+	interpolateDepthAndWLine(line->v, weights, line->invW, pl, &depth, &recIntInvW);
+	linearVaryingsEvaluate(varyings, nVaryings, t, recIntInvW, interpolatedBuffer);
+
+	SRPFragmentShaderIn fsIn = {
+		.uniform = pl->sp->uniform,
+		.varyings = interpolatedBuffer,
+		.fragCoord = { x + 0.5, y + 0.5, depth, recIntInvW },
+		.frontFacing = true,
+		.primitiveID = line->id,
+	};
+	if (coverage < 1)
+		emitFragmentCoverage(fb, pl, x, y, &fsIn, coverage);
+	else
+		emitFragment(fb, pl, x, y, &fsIn);
 }
 
 /** @} */  // ingroup Rasterization
@@ -10,6 +10,7 @@
 #include "core/framebuffer_p.h"
 #include "srp/shaders.h"
 #include "srp/vec.h"
+#include "core/pipeline_p.h"
 
 /** @ingroup Rasterization
  *  @{ */
@@ -22,16 +23,17 @@ typedef struct SRPLine {
 	size_t id;                /**< ID of the primitive, starting from 0 */
 } SRPLine;
 
-/** Rasterize a point
+/** Rasterize a line, following the diamond-exit rule: a pixel is produced
+ *  if the line exits the diamond `|x - cx| + |y - cy| < 0.5` around its center
  *  @param[in] line Pointer to the line to draw
  *  @param[in] fb The framebuffer to draw to
- *  @param[in] sp The shader program to use
+ *  @param[in] pl The pipeline to use
  *  @param[in] interpolatedBuffer Pointer to a temporary buffer where varyings 
  * 			   for each fragment will be stored. Must be big enough to hold all
  * 			   interpolated attributes for ONE vertex. */
 void rasterizeLine(
 	SRPLine* line, const SRPFramebuffer* fb,
-	const SRPShaderProgram* restrict sp, void* interpolatedBuffer
+	const SRPPipeline* restrict pl, void* interpolatedBuffer
 );
 
 /** Setup line for rasterization, performing perspective divide and
@@ -8,113 +8,90 @@
 #include <math.h>
 #include "raster/point.h"
 #include "raster/fragment.h"
+#include "core/framebuffer_p.h"
 #include "pipeline/vertex_processing.h"
-#include "srp/context.h"
 #include "srp/color.h"
 #include "math/utils.h"
 
 /** @ingroup Rasterization
  *  @{ */
 
-/** Given screen-space point position, compute its math and raster boundaries.
- *  @param[in] ss Screen-space point position
- *  @param[in] pointSize Point size, in pixels
- *  @param[in] fb Pointer to the framebuffer, used to clip partially-OOB points
- *  @param[out] outMinBP,outMaxBP Bounding points representing mathematical boundaries 
- *  @param[out] outMinX,outMaxX,outMinY,outMaxY Raster boundaries
- *  @return `true` if point is fully OOB, `false` otherwise
- */
-static bool computeMathAndRasterBoundaries(
-    vec3 ss, float pointSize, const SRPFramebuffer* fb, vec2* outMinBP, vec2* outMaxBP,
-    int* outMinX, int* outMaxX, int* outMinY, int* outMaxY
+/** Compute the range of pixels whose centers are inside `[min, min + size)`
+ *  on one axis, clamped to `[0, limit)`
+ *  @param[in] min Lower boundary of the point on the axis
+ *  @param[in] size Size of the point
+ *  @param[in] limit Size of the framebuffer on the axis
+ *  @param[out] outFirst,outEnd First covered pixel and the one after the last
+ *  @return `true` if any pixel is covered, `false` otherwise */
+static bool pointPixelRange(
+    float min, float size, int limit, int* outFirst, int* outEnd
 );
 
-void rasterizePoint(
-    SRPPoint* point, const SRPFramebuffer* fb,
-    const SRPShaderProgram* restrict sp
+void rasterizePoints(
+    const SRPPoint* points, size_t count, const SRPFramebuffer* fb,
+    const SRPPipeline* restrict pl
 )
 {
-    const float pointSize = srpContext.raster.pointSize;
-    vec3 ss;
-    vec2 minBP, maxBP;
-    int minX, maxX, minY, maxY;
+    const float defaultSize = pl->state.raster.pointSize;
+    const int width = fb->width, height = fb->height;
+    SRPUniform* uniform = pl->sp->uniform;
 
-    framebufferNDCToScreenSpace(fb, point->v.ndcPosition, (float*) &ss);
-    bool success = computeMathAndRasterBoundaries(
-        ss, pointSize, fb, &minBP, &maxBP, &minX, &maxX, &minY, &maxY
-    );
-
-    if (!success)
-        return;
-
-    for (int y = minY; y <= maxY; y++)
+    for (size_t i = 0; i < count; i++)
     {
-        for (int x = minX; x <= maxX; x++)
+        const SRPPoint* p = &points[i];
+        const float size = (p->v.pointSize > 0) ? p->v.pointSize : defaultSize;
+        const float minX = p->ss.x - size * 0.5;
+        const float minY = p->ss.y - size * 0.5;
+
+        int x0, x1, y0, y1;
+        if (!pointPixelRange(minX, size, width, &x0, &x1) ||
+            !pointPixelRange(minY, size, height, &y0, &y1))
+            continue;
+        framebufferAddDamage(fb, x0, y0, x1, y1);
+
+        const float invSize = 1. / size;
+        for (int y = y0; y < y1; y++)
         {
-            // Pixel center
-            const float px = x + 0.5;
             const float py = y + 0.5;
-
-            // Square coverage test
-            if (px < minBP.x || px >= maxBP.x || py < minBP.y || py >= maxBP.y)
-                continue;
-
-            // No need to interpolate anything, just redirect outputs from
-            // vertex shader to fragment shader
-            SRPFragmentShaderIn fsIn = {
-                .uniform = sp->uniform,
-                .varyings = (SRPInterpolated*) point->v.varyings,
-                .fragCoord = {px, py, point->v.ndcPosition[2], point->v.ndcPosition[3]},
-                .frontFacing = true,
-                .primitiveID = point->id,
-            };
-            emitFragment(fb, sp, x, y, &fsIn);
+            for (int x = x0; x < x1; x++)
+            {
+                const float px = x + 0.5;
+
+                // No need to interpolate anything, just redirect outputs from
+                // vertex shader to fragment shader
+                SRPFragmentShaderIn fsIn = {
+                    .uniform = uniform,
+                    .varyings = (SRPInterpolated*) p->v.varyings,
+                    .fragCoord = {px, py, p->v.ndcPosition[2], p->v.ndcPosition[3]},
+                    .frontFacing = true,
+                    .primitiveID = p->id,
+                    .pointCoord = {(px - minX) * invSize, (py - minY) * invSize}
+                };
+                emitFragment(fb, pl, x, y, &fsIn);
+            }
         }
     }
 }
 
-void setupPoint(SRPPoint* p)
+void setupPoint(SRPPoint* p, const SRPFramebuffer* fb)
 {
     applyPerspectiveDivide(&p->v, NULL);
+    framebufferNDCToScreenSpace(fb, p->v.ndcPosition, (float*) &p->ss);
 }
 
-static bool computeMathAndRasterBoundaries(
-    vec3 ss, float pointSize, const SRPFramebuffer* fb, vec2* outMinBP, vec2* outMaxBP,
-    int* outMinX, int* outMaxX, int* outMinY, int* outMaxY
+static bool pointPixelRange(
+    float min, float size, int limit, int* outFirst, int* outEnd
 )
 {
-    float halfSize = pointSize * 0.5;
-
-    vec2 minBP = VEC2(
-        ss.x - halfSize,
-        ss.y - halfSize
-    );
-    vec2 maxBP = VEC2(
-        ss.x + halfSize,
-        ss.y + halfSize
-    );
-
-    // Convert to integer pixel bounds
-    int minX = (int) floor(minBP.x);
-    int maxX = (int) floor(maxBP.x);
-    int minY = (int) floor(minBP.y);
-    int maxY = (int) floor(maxBP.y);
-
-    if (maxX < 0 || maxY < 0 || minX >= (int) fb->width || minY >= (int) fb->height)
+    // Pixel `i` is covered if `min <= i + 0.5 < min + size`
+    const float first = ceilf(min - 0.5);
+    const float end = ceilf(min + size - 0.5);
+    if (end <= 0 || first >= limit)
         return false;
 
-    if (minX < 0) minX = 0;
-    if (minY < 0) minY = 0;
-    if (maxX >= (int) fb->width)  maxX = fb->width - 1;
-    if (maxY >= (int) fb->height) maxY = fb->height - 1;
-
-    *outMinBP = minBP;
-    *outMaxBP = maxBP;
-    *outMinX = minX;
-    *outMaxX = maxX;
-    *outMinY = minY;
-    *outMaxY = maxY;
-    return true;
+    *outFirst = MAX(first, 0);
+    *outEnd = MIN(end, limit);
+    return *outFirst < *outEnd;
 }
 
 /** @} */  // ingroup Rasterization
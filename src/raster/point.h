@@ -10,6 +10,7 @@
 #include "core/framebuffer_p.h"
 #include "srp/shaders.h"
 #include "srp/vec.h"
+#include "core/pipeline_p.h"
 
 /** @ingroup Rasterization
  *  @{ */
@@ -17,21 +18,27 @@
 /** Point primitive. Stores data needed for its rasterization */
 typedef struct SRPPoint {
 	SRPVertexShaderOut v;  /**< Output of the vertex shader */
+	vec3 ss;               /**< Position in screen-space */
 	size_t id;             /**< ID of the primitive, starting from 0 */
 } SRPPoint;
 
-/** Rasterize a point
- *  @param[in] point Pointer to the point to draw
+/** Rasterize a batch of points. A point covers the pixels whose centers are
+ *  inside the square of its size around it. Everything that does not depend
+ *  on the point is resolved once per batch
+ *  @param[in] points The points to draw, already set up
+ *  @param[in] count Amount of points
  *  @param[in] fb The framebuffer to draw to
- *  @param[in] sp The shader program to use */
-void rasterizePoint(
-	SRPPoint* point, const SRPFramebuffer* fb,
-	const SRPShaderProgram* restrict sp
+ *  @param[in] pl The pipeline to use */
+void rasterizePoints(
+	const SRPPoint* points, size_t count, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl
 );
 
-/** Perform perspective divide on a point. Created to be structurally similar
- *  to setupTriangle(), setupLine()
- *  @param[in] p Point to setup */
-void setupPoint(SRPPoint* p);
+/** Setup point for rasterization, performing perspective divide and
+ *  NDC to screen-space conversion. Created to be structurally similar to
+ *  setupTriangle(), setupLine()
+ *  @param[in] p Point to setup. Its `v` field is required to be filled
+ *  @param[in] fb The framebuffer to use for NDC to screen-space conversion */
+void setupPoint(SRPPoint* p, const SRPFramebuffer* fb);
 
 /** @} */  // ingroup Rasterization
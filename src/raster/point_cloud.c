@@ -0,0 +1,184 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Rasterization
+ *  Point cloud splatting implementation */
+
+#include <math.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "raster/point_cloud.h"
+#include "core/buffer_p.h"
+#include "core/framebuffer_p.h"
+#include "core/color_p.h"
+#include "math/utils.h"
+
+/** @ingroup Rasterization
+ *  @{ */
+
+/** Amount of points a thread claims at once */
+#define SPLAT_GRAIN 4096
+/** Amount of pixels a thread seeds or resolves at once */
+#define RESOLVE_GRAIN 16384
+
+/** Shared state of a splatting job */
+typedef struct SplatJob
+{
+	const SRPVertexBuffer* vb;   /**< The points */
+	size_t startIndex;           /**< First point to draw */
+	const SRPFramebuffer* fb;    /**< The framebuffer to draw to */
+	const mat4* transform;       /**< Model to clip space transform */
+	const SRPPipeline* pl;       /**< Scissor box and depth state */
+	_Atomic uint64_t* words;     /**< Depth and color of every pixel */
+	bool largestWins;            /**< Whether the largest depth is the nearest */
+	bool depthTest;              /**< Whether to test against `fb` depth */
+	bool depthWrite;             /**< Whether to write the winners' depth */
+} SplatJob;
+
+/** Map depth to an unsigned integer that is the smallest for the nearest depth
+ *  @param[in] depth The depth
+ *  @param[in] largestWins Whether the largest depth is the nearest one
+ *  @return The key */
+static inline uint32_t depthToKey(float depth, bool largestWins);
+
+/** Inverse of depthToKey() */
+static inline float keyToDepth(uint32_t key, bool largestWins);
+
+/** The word a pixel starts with: the framebuffer's depth and color, so that
+ *  they compete with the points as if they were one, or the farthest possible
+ *  word if the depth test is disabled */
+static inline uint64_t seedWord(const SplatJob* job, size_t pixel);
+
+/** Fill the words from the framebuffer. A ParallelForFunc */
+static void seedWords(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Transform the points and write them into the words. A ParallelForFunc */
+static void splatPoints(void* data, size_t begin, size_t end, size_t threadIndex);
+
+/** Write the pixels some point won back to the framebuffer. A ParallelForFunc */
+static void resolveWords(void* data, size_t begin, size_t end, size_t threadIndex);
+
+void splatPointCloud(
+	const SRPVertexBuffer* vb, const SRPFramebuffer* fb, const SRPPipeline* pl,
+	const mat4* transform, size_t startIndex, size_t count, SRPArena* arena,
+	ThreadPool* pool
+)
+{
+	const SRPCompareOp op = pl->state.depth.compareOp;
+	SplatJob job = {
+		.vb = vb,
+		.startIndex = startIndex,
+		.fb = fb,
+		.transform = transform,
+		.pl = pl,
+		.words = arenaAlloc(arena, sizeof(_Atomic uint64_t) * fb->size),
+		.largestWins = (op == SRP_COMPARE_GREATER || op == SRP_COMPARE_GEQUAL),
+		.depthTest = pl->state.depth.testEnable,
+		.depthWrite = pl->depthWrite
+	};
+
+	threadPoolParallelFor(pool, fb->size, RESOLVE_GRAIN, seedWords, &job);
+	threadPoolParallelFor(pool, count, SPLAT_GRAIN, splatPoints, &job);
+	threadPoolParallelFor(pool, fb->size, RESOLVE_GRAIN, resolveWords, &job);
+}
+
+static inline uint32_t depthToKey(float depth, bool largestWins)
+{
+	uint32_t bits;
+	memcpy(&bits, &depth, sizeof(bits));
+	// Flip negative floats entirely and positive ones' sign bit, so that the
+	// integers compare as the floats do
+	bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+	return (largestWins) ? ~bits : bits;
+}
+
+static inline float keyToDepth(uint32_t key, bool largestWins)
+{
+	uint32_t bits = (largestWins) ? ~key : key;
+	bits = (bits & 0x80000000u) ? bits & 0x7FFFFFFFu : ~bits;
+	float depth;
+	memcpy(&depth, &bits, sizeof(depth));
+	return depth;
+}
+
+static inline uint64_t seedWord(const SplatJob* job, size_t pixel)
+{
+	if (!job->depthTest)
+		return UINT64_MAX;
+	const uint32_t key = depthToKey(job->fb->depth[pixel], job->largestWins);
+	const uint32_t color = colorReadPacked(job->fb->colorFormat, framebufferPixel(job->fb, pixel));
+	return ((uint64_t) key << 32) | color;
+}
+
+static void seedWords(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	(void) threadIndex;
+	const SplatJob* job = (const SplatJob*) data;
+	for (size_t i = begin; i < end; i++)
+		atomic_init(&job->words[i], seedWord(job, i));
+}
+
+static void splatPoints(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	(void) threadIndex;
+	const SplatJob* job = (const SplatJob*) data;
+	const SRPFramebuffer* fb = job->fb;
+	const SRPPipeline* pl = job->pl;
+	size_t minX = SIZE_MAX, minY = SIZE_MAX, maxX = 0, maxY = 0;
+
+	for (size_t i = begin; i < end; i++)
+	{
+		const SRPCloudPoint* p = (const SRPCloudPoint*) \
+			indexVertexBuffer(job->vb, job->startIndex + i);
+		const vec4 clip = mat4MultiplyVec4(
+			job->transform, VEC4(p->position[0], p->position[1], p->position[2], 1)
+		);
+
+		// Same volume as clipPoint(); also drops NaNs
+		if (!(clip.w > 0) || !(fabsf(clip.x) <= clip.w) ||
+		    !(fabsf(clip.y) <= clip.w) || !(fabsf(clip.z) <= clip.w))
+			continue;
+
+		const float invW = 1. / clip.w;
+		const float ndc[3] = {clip.x * invW, clip.y * invW, clip.z * invW};
+		float ss[3];
+		framebufferNDCToScreenSpace(fb, ndc, ss);
+
+		// The right and bottom edges of NDC map exactly onto the framebuffer's
+		const size_t x = MIN((size_t) ss[0], fb->width - 1);
+		const size_t y = MIN((size_t) ss[1], fb->height - 1);
+		if (x < pl->scissorMinX || x >= pl->scissorMaxX || y < pl->scissorMinY || y >= pl->scissorMaxY)
+			continue;
+		const uint64_t word = \
+			((uint64_t) depthToKey(ndc[2], job->largestWins) << 32) | p->color;
+		minX = MIN(minX, x);
+		minY = MIN(minY, y);
+		maxX = MAX(maxX, x + 1);
+		maxY = MAX(maxY, y + 1);
+
+		// Most points lose to an already written one
+		atomicStoreMin(&job->words[y * fb->width + x], word);
+	}
+
+	// Merged once per chunk rather than per point
+	framebufferAddDamage(fb, minX, minY, maxX, maxY);
+}
+
+static void resolveWords(void* data, size_t begin, size_t end, size_t threadIndex)
+{
+	(void) threadIndex;
+	const SplatJob* job = (const SplatJob*) data;
+	for (size_t i = begin; i < end; i++)
+	{
+		const uint64_t word = atomic_load_explicit(&job->words[i], memory_order_relaxed);
+		if (word >= seedWord(job, i))
+			continue;
+
+		colorWritePacked(job->fb->colorFormat, framebufferPixel(job->fb, i), (uint32_t) word);
+		if (job->depthWrite)
+			job->fb->depth[i] = keyToDepth(word >> 32, job->largestWins);
+	}
+}
+
+/** @} */  // ingroup Rasterization
@@ -0,0 +1,40 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Rasterization
+ *  Order-independent point cloud splatting */
+
+#pragma once
+
+#include "srp/buffer.h"
+#include "srp/mat.h"
+#include "core/pipeline_p.h"
+#include "memory/arena_p.h"
+#include "parallel/thread_pool.h"
+
+/** @ingroup Rasterization
+ *  @{ */
+
+/** Splat a point cloud into the framebuffer. Every pixel is a 64-bit word
+ *  holding the depth of the nearest point in its high half (remapped so that
+ *  the nearest one is the smallest) and its color in the low one. Points are
+ *  written with an atomic minimum, so threads may splat any of them
+ *  concurrently and the result does not depend on the order. The words are
+ *  seeded from the framebuffer and resolved back into it afterwards
+ *  @param[in] vb The vertex buffer holding SRPCloudPoint-s
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline whose depth state to use
+ *  @param[in] transform Matrix transforming the points to clip space
+ *  @param[in] startIndex First point to draw
+ *  @param[in] count Amount of points to draw
+ *  @param[in] arena The arena to allocate the words in
+ *  @param[in] pool The thread pool to splat on, may be NULL
+ *  @see srpDrawPointCloud() */
+void splatPointCloud(
+	const SRPVertexBuffer* vb, const SRPFramebuffer* fb, const SRPPipeline* pl,
+	const mat4* transform, size_t startIndex, size_t count, SRPArena* arena,
+	ThreadPool* pool
+);
+
+/** @} */  // ingroup Rasterization
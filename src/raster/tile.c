@@ -0,0 +1,204 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Rasterization
+ *  Tiled multithreaded triangle rasterization implementation */
+
+#include <stdlib.h>
+#include <string.h>
+#include "raster/tile.h"
+#include "core/framebuffer_p.h"
+#include "math/utils.h"
+#include "parallel/numa.h"
+
+/** @ingroup Rasterization
+ *  @{ */
+
+/** A non-empty screen tile scheduled for rasterization */
+typedef struct Tile
+{
+	size_t index;     /**< Index of the tile in TileBins */
+	size_t count;     /**< Amount of triangles in all the rows of the tile */
+} Tile;
+
+/** Shared state of a tiled rasterization job */
+typedef struct TiledJob
+{
+	const TileBins* bins;          /**< The binned triangles */
+	const Tile* tiles;             /**< Non-empty tiles, the most populated first */
+	const SRPFramebuffer* fb;      /**< The framebuffer to draw to */
+	const SRPPipeline* pl;         /**< The pipeline to use */
+	void** interpolatedBuffers;    /**< Varying buffer of every thread */
+	const TileBinChunk** runs;     /**< `nSlices` first chunks of every thread's slice runs */
+} TiledJob;
+
+/** Rasterize all the triangles of one tile. A TaskFunc */
+static void rasterizeTile(void* data, size_t task, size_t threadIndex);
+
+/** Choose the thread to initially give every tile to: one of the threads
+ *  pinned to the NUMA node holding the tile's memory, round-robin among them
+ *  @param[in] bins The bins the tiles belong to
+ *  @param[in] tiles The scheduled tiles
+ *  @param[in] nTiles Amount of scheduled tiles
+ *  @param[in] fb The framebuffer the tiles belong to
+ *  @param[in] pool The thread pool to rasterize on
+ *  @param[in] arena The arena to allocate the result in
+ *  @return Array of `nTiles` thread indices, or NULL if either the framebuffer
+ *          is not partitioned between nodes or the threads are not pinned */
+static size_t* preferLocalThreads(
+	const TileBins* bins, const Tile* tiles, size_t nTiles,
+	const SRPFramebuffer* fb, const ThreadPool* pool, SRPArena* arena
+);
+
+/** Order tiles by the amount of triangles, descending. A qsort() comparator */
+static int compareTiles(const void* a, const void* b);
+
+void rasterizeTrianglesTiled(
+	const TileBins* bins, const SRPFramebuffer* fb, const SRPPipeline* pl,
+	SRPArena* arena, ThreadPool* pool
+)
+{
+	// Drop the empty tiles and start with the most expensive ones, so that
+	// the big tiles do not end up being the tail of the frame
+	Tile* tiles = arenaAlloc(arena, sizeof(Tile) * bins->nTiles);
+	size_t nNonEmpty = 0;
+	for (size_t i = 0; i < bins->nTiles; i++)
+	{
+		size_t count = 0;
+		for (size_t r = 0; r < bins->nRows; r++)
+			count += tileBinsGet(bins, r, i)->count;
+		if (count > 0)
+			tiles[nNonEmpty++] = (Tile) {.index = i, .count = count};
+	}
+	if (nNonEmpty == 0)
+		return;
+	qsort(tiles, nNonEmpty, sizeof(Tile), compareTiles);
+
+	const size_t nThreads = threadPoolSize(pool);
+	void** interpolatedBuffers = arenaAlloc(arena, sizeof(void*) * nThreads);
+	for (size_t i = 0; i < nThreads; i++)
+		interpolatedBuffers[i] = arenaAlloc(arena, pl->sp->vs->varyingsSize);
+
+	TiledJob job = {
+		.bins = bins,
+		.tiles = tiles,
+		.fb = fb,
+		.pl = pl,
+		.interpolatedBuffers = interpolatedBuffers,
+		.runs = arenaAlloc(arena, sizeof(TileBinChunk*) * bins->nSlices * nThreads)
+	};
+	const size_t* preferred = preferLocalThreads(bins, tiles, nNonEmpty, fb, pool, arena);
+	threadPoolRunTasks(pool, nNonEmpty, preferred, rasterizeTile, &job);
+}
+
+void rasterizeTrianglesOwnedTiles(
+	const SRPTriangle* triangles, size_t count, const SRPFramebuffer* fb,
+	const SRPPipeline* pl, size_t owner, size_t nOwners, void* interpolatedBuffer
+)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const SRPTriangle* tri = &triangles[i];
+		size_t tx0, ty0, tx1, ty1;
+		if (!triangleTileRange(tri, &tx0, &ty0, &tx1, &ty1))
+			continue;
+
+		for (size_t ty = ty0; ty < ty1; ty++)
+		{
+			// First tile of the row owned by this thread
+			size_t tx = tx0 + (owner + nOwners - (tx0 + ty) % nOwners) % nOwners;
+			for (; tx < tx1; tx += nOwners)
+			{
+				const size_t x = tx * TILE_SIZE, y = ty * TILE_SIZE;
+				rasterizeTriangleRect(
+					tri, fb, pl, x, y, MIN(x + TILE_SIZE, fb->width),
+					MIN(y + TILE_SIZE, fb->height), interpolatedBuffer
+				);
+			}
+		}
+	}
+}
+
+static void rasterizeTile(void* data, size_t task, size_t threadIndex)
+{
+	const TiledJob* job = (const TiledJob*) data;
+	const TileBins* bins = job->bins;
+	const size_t tile = job->tiles[task].index;
+	const size_t x0 = (tile % bins->nTilesX) * TILE_SIZE;
+	const size_t y0 = (tile / bins->nTilesX) * TILE_SIZE;
+	const size_t x1 = MIN(x0 + TILE_SIZE, job->fb->width);
+	const size_t y1 = MIN(y0 + TILE_SIZE, job->fb->height);
+
+	// Every slice was binned by one thread in one go, so its chunks are one
+	// run in that thread's row. Find where the runs start
+	const TileBinChunk** runs = job->runs + threadIndex * bins->nSlices;
+	memset(runs, 0, sizeof(TileBinChunk*) * bins->nSlices);
+	for (size_t r = 0; r < bins->nRows; r++)
+	{
+		const TileBinChunk* previous = NULL;
+		const TileBinChunk* chunk = tileBinsGet(bins, r, tile)->head;
+		for (; chunk != NULL; previous = chunk, chunk = chunk->next)
+			if (previous == NULL || chunk->slice != previous->slice)
+				runs[chunk->slice] = chunk;
+	}
+
+	// Slices hold consecutive triangles, so this is the submission order
+	for (size_t s = 0; s < bins->nSlices; s++)
+	{
+		const TileBinChunk* chunk = runs[s];
+		for (; chunk != NULL && chunk->slice == s; chunk = chunk->next)
+		{
+			for (size_t i = 0; i < chunk->count; i++)
+			{
+				rasterizeTriangleRect(
+					chunk->triangles[i], job->fb, job->pl, x0, y0, x1, y1,
+					job->interpolatedBuffers[threadIndex]
+				);
+			}
+		}
+	}
+}
+
+static size_t* preferLocalThreads(
+	const TileBins* bins, const Tile* tiles, size_t nTiles,
+	const SRPFramebuffer* fb, const ThreadPool* pool, SRPArena* arena
+)
+{
+	if (pool == NULL || pool->threadNodes == NULL ||
+	    fb->numaPlacement != SRP_NUMA_PLACEMENT_PARTITION)
+		return NULL;
+
+	const size_t nNodes = numaNodeCount();
+	const size_t nThreads = threadPoolSize(pool);
+	size_t* preferred = arenaAlloc(arena, sizeof(size_t) * nTiles);
+	size_t* next = arenaCalloc(arena, sizeof(size_t) * nNodes);  // Per-node cursor
+	for (size_t i = 0; i < nTiles; i++)
+	{
+		const size_t ty = tiles[i].index / bins->nTilesX;
+		const size_t node = numaPartitionNode(ty, bins->nTilesY, nNodes);
+
+		size_t t = next[node], tried = 0;
+		while (pool->threadNodes[t] != node && tried < nThreads)
+		{
+			t = (t + 1) % nThreads;
+			tried++;
+		}
+		// More nodes than threads: nobody is local to this one
+		preferred[i] = (tried < nThreads) ? t : i % nThreads;
+		next[node] = (t + 1) % nThreads;
+	}
+	return preferred;
+}
+
+static int compareTiles(const void* a, const void* b)
+{
+	const Tile* ta = (const Tile*) a;
+	const Tile* tb = (const Tile*) b;
+	if (ta->count != tb->count)
+		return (ta->count > tb->count) ? -1 : 1;
+	// Keep the order deterministic for tiles of equal cost
+	return (ta->index > tb->index) - (ta->index < tb->index);
+}
+
+/** @} */  // ingroup Rasterization
@@ -0,0 +1,52 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Rasterization
+ *  Tiled multithreaded triangle rasterization */
+
+#pragma once
+
+#include "srp/framebuffer.h"
+#include "core/pipeline_p.h"
+#include "memory/arena_p.h"
+#include "parallel/thread_pool.h"
+#include "raster/triangle.h"
+#include "raster/tile_bins.h"
+
+/** @ingroup Rasterization
+ *  @{ */
+
+/** Rasterize binned triangles, distributing the tiles over the threads of a
+ *  pool. Each tile is owned by exactly one thread and processes its triangles
+ *  in submission order, so the result is the same as when rasterizing them
+ *  one by one. Tiles are scheduled from the most to the least populated one,
+ *  idle threads steal tiles from the busy ones
+ *  @param[in] bins The binned triangles, already set up
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] arena The arena to allocate the schedule and the varying buffers in
+ *  @param[in] pool The thread pool to rasterize on. If NULL, the tiles are
+ *                  rasterized on the calling thread */
+void rasterizeTrianglesTiled(
+	const TileBins* bins, const SRPFramebuffer* fb, const SRPPipeline* pl,
+	SRPArena* arena, ThreadPool* pool
+);
+
+/** Rasterize the parts of triangles that fall into the tiles owned by one
+ *  thread. Tile (tx, ty) is owned by thread `(tx + ty) % nOwners`, which
+ *  spreads the screen evenly and lets threads rasterize the same triangles
+ *  concurrently without synchronization
+ *  @param[in] triangles The triangles to draw, already set up
+ *  @param[in] count Amount of triangles
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] owner Index of the calling thread, in [0, nOwners)
+ *  @param[in] nOwners Amount of threads the tiles are split between
+ *  @param[in] interpolatedBuffer @see rasterizeTriangle() */
+void rasterizeTrianglesOwnedTiles(
+	const SRPTriangle* triangles, size_t count, const SRPFramebuffer* fb,
+	const SRPPipeline* pl, size_t owner, size_t nOwners, void* interpolatedBuffer
+);
+
+/** @} */  // ingroup Rasterization
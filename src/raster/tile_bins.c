@@ -0,0 +1,79 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Rasterization
+ *  Per-tile bins of triangles implementation */
+
+#include "raster/tile_bins.h"
+#include "core/framebuffer_p.h"
+
+/** @ingroup Rasterization
+ *  @{ */
+
+void tileBinsInit(
+	TileBins* this, SRPArena* arena, const SRPFramebuffer* fb, size_t nRows, size_t nSlices
+)
+{
+	this->nTilesX = (fb->width + TILE_SIZE - 1) / TILE_SIZE;
+	this->nTilesY = (fb->height + TILE_SIZE - 1) / TILE_SIZE;
+	this->nTiles = this->nTilesX * this->nTilesY;
+	this->nRows = nRows;
+	this->nSlices = nSlices;
+	this->bins = arenaCalloc(arena, sizeof(TileBin) * this->nTiles * nRows);
+}
+
+void tileBinsAppend(
+	TileBins* this, size_t row, size_t slice, const SRPTriangle* tri, SRPArena* arena
+)
+{
+	size_t tx0, ty0, tx1, ty1;
+	if (!triangleTileRange(tri, &tx0, &ty0, &tx1, &ty1))
+		return;
+
+	TileBin* bins = &this->bins[row * this->nTiles];
+	for (size_t ty = ty0; ty < ty1; ty++)
+	{
+		for (size_t tx = tx0; tx < tx1; tx++)
+		{
+			TileBin* bin = &bins[ty * this->nTilesX + tx];
+			if (bin->tail == NULL || bin->tail->count == TILE_BIN_CHUNK_SIZE ||
+			    bin->tail->slice != slice)
+			{
+				TileBinChunk* chunk = arenaAlloc(arena, sizeof(TileBinChunk));
+				chunk->next = NULL;
+				chunk->slice = slice;
+				chunk->count = 0;
+				if (bin->tail == NULL)
+					bin->head = chunk;
+				else
+					bin->tail->next = chunk;
+				bin->tail = chunk;
+			}
+			bin->tail->triangles[bin->tail->count++] = tri;
+			bin->count++;
+		}
+	}
+}
+
+const TileBin* tileBinsGet(const TileBins* this, size_t row, size_t tile)
+{
+	return &this->bins[row * this->nTiles + tile];
+}
+
+bool triangleTileRange(
+	const SRPTriangle* tri, size_t* tx0, size_t* ty0, size_t* tx1, size_t* ty1
+)
+{
+	// Fully scissored-out triangles have an inverted bounding box
+	if (tri->maxBP.x <= tri->minBP.x || tri->maxBP.y <= tri->minBP.y)
+		return false;
+
+	*tx0 = (size_t) tri->minBP.x / TILE_SIZE;
+	*ty0 = (size_t) tri->minBP.y / TILE_SIZE;
+	*tx1 = ((size_t) tri->maxBP.x + TILE_SIZE - 1) / TILE_SIZE;
+	*ty1 = ((size_t) tri->maxBP.y + TILE_SIZE - 1) / TILE_SIZE;
+	return true;
+}
+
+/** @} */  // ingroup Rasterization
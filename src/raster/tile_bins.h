@@ -0,0 +1,96 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Rasterization
+ *  Per-tile bins of triangles */
+
+#pragma once
+
+#include "srp/framebuffer.h"
+#include "memory/arena_p.h"
+#include "raster/triangle.h"
+
+/** @ingroup Rasterization
+ *  @{ */
+
+/** Side of a square screen tile, in pixels */
+#define TILE_SIZE 64
+
+/** Amount of triangles stored in one TileBinChunk */
+#define TILE_BIN_CHUNK_SIZE 32
+
+/** Fixed-size block of a bin's linked list. Holds triangles of one slice */
+typedef struct TileBinChunk
+{
+	struct TileBinChunk* next;                         /**< Next chunk, or NULL */
+	size_t slice;                                      /**< Slice of the triangles */
+	size_t count;                                      /**< Amount of used entries */
+	const SRPTriangle* triangles[TILE_BIN_CHUNK_SIZE]; /**< The triangles */
+} TileBinChunk;
+
+/** Triangles binned by one thread overlapping one tile. The chunks of every
+ *  slice form one run, in submission order; the runs are in the order the
+ *  thread binned the slices in */
+typedef struct TileBin
+{
+	TileBinChunk* head;  /**< First chunk, or NULL if the bin is empty */
+	TileBinChunk* tail;  /**< Chunk being appended to */
+	size_t count;        /**< Amount of triangles in the bin */
+} TileBin;
+
+/** Bins of triangles for every screen tile of TILE_SIZE pixels. The triangles
+ *  are split into consecutive slices, binned by the threads one slice at a
+ *  time. Every thread has its own row of bins: it only touches that row and
+ *  allocates chunks from its own arena, so slices are binned concurrently
+ *  without any synchronization. Reading a tile's chunks slice by slice, over
+ *  all the rows, yields its triangles in submission order */
+typedef struct TileBins
+{
+	size_t nTilesX;  /**< Amount of tile columns */
+	size_t nTilesY;  /**< Amount of tile rows */
+	size_t nTiles;   /**< Total amount of tiles */
+	size_t nRows;    /**< Amount of rows, one per binning thread */
+	size_t nSlices;  /**< Amount of slices */
+	TileBin* bins;   /**< `nRows` rows of `nTiles` bins each */
+} TileBins;
+
+/** Initialize empty bins covering a framebuffer
+ *  @param[out] this The bins to initialize
+ *  @param[in] arena The arena to allocate the bins in
+ *  @param[in] fb The framebuffer the triangles are drawn to
+ *  @param[in] nRows Amount of threads binning the triangles
+ *  @param[in] nSlices Amount of slices the triangles are split into */
+void tileBinsInit(
+	TileBins* this, SRPArena* arena, const SRPFramebuffer* fb, size_t nRows, size_t nSlices
+);
+
+/** Append a triangle to the bins of all the tiles its bounding box overlaps.
+ *  May be called concurrently for different rows. A row must be given the
+ *  triangles of a slice without any other slice's in between
+ *  @param[in] this The bins
+ *  @param[in] row The row to append to, i.e. the index of the calling thread
+ *  @param[in] slice The slice the triangle belongs to
+ *  @param[in] tri The triangle, must stay valid until the bins are used
+ *  @param[in] arena The arena to allocate new chunks in, owned by the caller */
+void tileBinsAppend(
+	TileBins* this, size_t row, size_t slice, const SRPTriangle* tri, SRPArena* arena
+);
+
+/** Get the bin of a tile in a row
+ *  @param[in] this The bins
+ *  @param[in] row Index of the row
+ *  @param[in] tile Index of the tile, `ty * nTilesX + tx`
+ *  @return Pointer to the bin */
+const TileBin* tileBinsGet(const TileBins* this, size_t row, size_t tile);
+
+/** Get the range of tiles a triangle's bounding box overlaps
+ *  @param[in] tri The triangle
+ *  @param[out] tx0,ty0 First overlapped tile, inclusive
+ *  @param[out] tx1,ty1 Last overlapped tile, exclusive
+ *  @return `false` if the bounding box is empty, `true` otherwise */
+bool triangleTileRange(
+	const SRPTriangle* tri, size_t* tx0, size_t* ty0, size_t* tx1, size_t* ty1
+);
+
+/** @} */  // ingroup Rasterization
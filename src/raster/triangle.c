@@ -8,7 +8,6 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
-#include "srp/context.h"
 #include "srp/vertex.h"
 #include "srp/shaders.h"
 #include "srp/color.h"
@@ -25,6 +24,20 @@
 /** @ingroup Rasterization
  *  @{ */
 
+/** Bounding box size (in pixels, along both axes) up to which triangles
+ *  have their covered pixel centers resolved in setupTriangle(), see
+ *  setupSmallTriangle() */
+#define SMALL_TRIANGLE_SIZE 2
+
+/** Relative slack of the conservative reject in setupSmallTriangle(). A
+ *  pixel center farther than that outside of an edge is not covered whatever
+ *  the rounding of its barycentric coordinates is */
+#define SMALL_TRIANGLE_SLACK 1e-4
+
+/** Bounding box width (in pixels) from which triangles are rasterized in
+ *  spans, see rasterizeTriangleSpans() */
+#define SPAN_TRIANGLE_MIN_WIDTH 16
+
 /** Get a parallelogram's signed area. The two vectors define a parallelogram.
  *  Used for barycentric coordinates' initialization in calculateBarycentrics() */
 static float signedAreaParallelogram(
@@ -33,10 +46,13 @@ static float signedAreaParallelogram(
 
 /** Determine if a triangle should be culled (back-face culling)
  *  @param[in] tri Triangle to check. Must have its `p_ndc` field initialized.
+ *  @param[in] pl The pipeline to use
  *  @param[out] isCCW Whether or not the triangle's vertices are in counter-clockwise order
  *  @param[out] isFrontFacing Whether or not the triangle is front facing 
  *  @return Whether or not the triangle should be culled */
-static bool shouldCullTriangle(const SRPTriangle* tri, bool* isCCW, bool* isFrontFacing);
+static bool shouldCullTriangle(
+	const SRPTriangle* tri, const SRPPipeline* pl, bool* isCCW, bool* isFrontFacing
+);
 
 /** Change the winding order of a triangle.
  *  @param[in] tri Triangle to change the winding order of. Must have its `v`,
@@ -51,6 +67,17 @@ static void triangleChangeWinding(SRPTriangle* tri);
  *  @param[in] point Point to calculate barycentric coordinates for (screen-space) */
 static void calculateBarycentrics(SRPTriangle* tri, float areaX2, vec2 point);
 
+/** Resolve which of the (up to 4) pixel centers of a small triangle's
+ *  bounding box are covered, evaluating unnormalized edge functions at them.
+ *  Centers clearly outside of an edge are rejected before any division,
+ *  barycentric coordinates are calculated only for the rest and the
+ *  top-left rule is applied to them, like rasterizeTriangleRect() does
+ *  @param[in] tri Triangle to set up. Must have its `ss`, `edge`, `edgeTL`,
+ *                 `minBP` and `maxBP` fields initialized. Its `smallCoverage`
+ *                 and `smallLambda` fields are filled
+ *  @param[in] areaX2 The triangle's area multiplied by 2 */
+static void setupSmallTriangle(SRPTriangle* tri, float areaX2);
+
 /** Check if a triangle's edge is flat top or left. Assumes counter-clockwise
  *  vertex order!
  *  @param[in] edge A pointer to an edge vector (pointing from one vertex
@@ -58,59 +85,229 @@ static void calculateBarycentrics(SRPTriangle* tri, float areaX2, vec2 point);
  *  @return Whether or not this edge is flat top or left */
 static bool isEdgeFlatTopOrLeft(const vec3* restrict edge);
 
+/** Rasterize the part of a triangle inside a screen-space rectangle row by
+ *  row, finding the span of covered pixels of every row from its edges and
+ *  visiting only them. Produces exactly the same fragments as the per-pixel
+ *  traversal of rasterizeTriangleRect()
+ *  @see rasterizeTriangleRect() */
+static void rasterizeTriangleSpans(
+	const SRPTriangle* tri, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl, size_t x0, size_t y0, size_t x1, size_t y1,
+	void* interpolatedBuffer
+);
+
+/** Find where the coverage of a row of pixels by one edge of a triangle
+ *  changes. The coverage of an edge is monotonic along a row, so it is
+ *  estimated analytically, then settled with the exact per-pixel test
+ *  @param[in] tri The triangle. Its `dldx[i]` must not be zero
+ *  @param[in] lambdaRow Barycentric coordinates at the `minBP.x` pixel of the row
+ *  @param[in] i Index of the barycentric coordinate (edge) to check
+ *  @param[in] lo,hi The range of pixels to search in, `hi` is exclusive
+ *  @return If the coordinate grows along X, the first covered pixel,
+ *          otherwise the first uncovered one; `hi` if there is none */
+static size_t edgeSpanBound(
+	const SRPTriangle* tri, const float* lambdaRow, uint8_t i, size_t lo, size_t hi
+);
+
+/** Evaluate one barycentric coordinate of a pixel of a row. Every traversal
+ *  uses this, so they agree on the coverage exactly
+ *  @param[in] tri The triangle
+ *  @param[in] lambdaRow Barycentric coordinates at the `minBP.x` pixel of the row
+ *  @param[in] i Index of the barycentric coordinate
+ *  @param[in] x Pixel of the row
+ *  @return The barycentric coordinate */
+static inline float rowLambda(
+	const SRPTriangle* tri, const float* lambdaRow, uint8_t i, size_t x
+);
+
+/** Check one edge of the triangle against a barycentric coordinate of a
+ *  pixel, applying the top-left rasterization rule
+ *  @param[in] tri The triangle
+ *  @param[in] lambda The barycentric coordinate of the pixel
+ *  @param[in] i Index of the barycentric coordinate
+ *  @return Whether or not the pixel is on the inner side of the edge */
+static inline bool edgeCovers(const SRPTriangle* tri, float lambda, uint8_t i);
+
+/** Interpolate the data of a covered pixel, run the fragment shader on it and
+ *  write the result
+ *  @param[in] tri The triangle
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] x,y The pixel
+ *  @param[in] lambda Barycentric coordinates of the pixel
+ *  @param[in] interpolatedBuffer @see rasterizeTriangle() */
+static inline void shadeTrianglePixel(
+	const SRPTriangle* tri, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	size_t x, size_t y, const float* lambda, void* interpolatedBuffer
+);
+
 /** Interpolate the fragment position and vertex variables inside the triangle.
  *  @param[in] tri Triangle to interpolate data for
- *  @param[in] sp A pointer to shader program to use
+ *  @param[in] lambda Barycentric coordinates of the fragment
+ *  @param[in] pl A pointer to the pipeline to use
  *  @param[out] pInterpolatedBuffer A pointer to the buffer where interpolated
  *              variables will appear. Must be big enough to hold all of them
  *  @param[out] depth Fragment depth
  *  @param[out] recIntInvW Reciprocal of interpolated inverse Wclip */
 static void triangleInterpolateData(
-	SRPTriangle* tri, const SRPShaderProgram* restrict sp,
+	const SRPTriangle* tri, const float* lambda, const SRPPipeline* restrict pl,
 	SRPInterpolated* pInterpolatedBuffer, float* depth, float* recIntInvW
 );
 
 void rasterizeTriangle(
-	SRPTriangle* tri, const SRPFramebuffer* fb,
-	const SRPShaderProgram* restrict sp, void* interpolatedBuffer
+	const SRPTriangle* tri, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl, void* interpolatedBuffer
+)
+{
+	rasterizeTriangleRect(
+		tri, fb, pl, tri->minBP.x, tri->minBP.y, tri->maxBP.x, tri->maxBP.y,
+		interpolatedBuffer
+	);
+}
+
+void rasterizeTriangleRect(
+	const SRPTriangle* tri, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl, size_t x0, size_t y0, size_t x1, size_t y1,
+	void* interpolatedBuffer
 )
 {
-	for (size_t y = tri->minBP.y; y < tri->maxBP.y; y += 1)
+	const size_t minX = tri->minBP.x, minY = tri->minBP.y;
+	x0 = MAX(x0, minX);
+	y0 = MAX(y0, minY);
+	x1 = MIN(x1, (size_t) tri->maxBP.x);
+	y1 = MIN(y1, (size_t) tri->maxBP.y);
+	framebufferAddDamage(fb, x0, y0, x1, y1);
+
+	if (tri->isSmall)
+	{
+		for (uint8_t b = 0; b < 4; b++)
+		{
+			const size_t x = minX + (b & 1), y = minY + (b >> 1);
+			if (!(tri->smallCoverage & (1 << b)) || x < x0 || x >= x1 || y < y0 || y >= y1)
+				continue;
+			shadeTrianglePixel(tri, fb, pl, x, y, tri->smallLambda[b], interpolatedBuffer);
+		}
+		return;
+	}
+
+	// Big triangles leave much of their bounding box uncovered
+	if (tri->maxBP.x - tri->minBP.x >= SPAN_TRIANGLE_MIN_WIDTH)
+	{
+		rasterizeTriangleSpans(tri, fb, pl, x0, y0, x1, y1, interpolatedBuffer);
+		return;
+	}
+
+	for (size_t y = y0; y < y1; y += 1)
 	{
-		for (size_t x = tri->minBP.x; x < tri->maxBP.x; x += 1)
+		// Evaluated directly instead of incrementally, so that the result
+		// does not depend on where the traversal has started
+		float lambdaRow[3];
+		for (uint8_t i = 0; i < 3; i++)
+			lambdaRow[i] = tri->lambda[i] + tri->dldy[i] * (float) (y - minY);
+
+		for (size_t x = x0; x < x1; x += 1)
 		{
+			float lambda[3];
+			for (uint8_t i = 0; i < 3; i++)
+				lambda[i] = rowLambda(tri, lambdaRow, i, x);
+
 			for (uint8_t i = 0; i < 3; i++)  // Top-left rasterization rule
 			{
-				bool inside = (tri->lambda[i] > 0.) || (ROUGHLY_ZERO(tri->lambda[i]) && tri->edgeTL[i]);
-				if (!inside)
+				if (!edgeCovers(tri, lambda[i], i))
 					goto nextPixel;
 			}
 
-			float depth, recIntInvW;
-			triangleInterpolateData(tri, sp, interpolatedBuffer, &depth, &recIntInvW);
-
-			SRPFragmentShaderIn fsIn = {
-				.uniform = sp->uniform,
-				.varyings = interpolatedBuffer,
-				.fragCoord = { x + 0.5, y + 0.5, depth, recIntInvW },
-				.frontFacing = tri->isFrontFacing,
-				.primitiveID = tri->id,
-			};
-			emitFragment(fb, sp, x, y, &fsIn);
+			shadeTrianglePixel(tri, fb, pl, x, y, lambda, interpolatedBuffer);
 
 nextPixel:
-			for (uint8_t i = 0; i < 3; i++)
-				tri->lambda[i] += tri->dldx[i];
+			;
 		}
+	}
+}
+
+static void rasterizeTriangleSpans(
+	const SRPTriangle* tri, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl, size_t x0, size_t y0, size_t x1, size_t y1,
+	void* interpolatedBuffer
+)
+{
+	const size_t minY = tri->minBP.y;
+	for (size_t y = y0; y < y1; y += 1)
+	{
+		float lambdaRow[3];
 		for (uint8_t i = 0; i < 3; i++)
+			lambdaRow[i] = tri->lambda[i] + tri->dldy[i] * (float) (y - minY);
+
+		// The covered pixels of a row are contiguous: each edge either opens
+		// the span (coordinate grows along X) or closes it
+		size_t start = x0, end = x1;
+		for (uint8_t i = 0; i < 3 && start < end; i++)
 		{
-			tri->lambda_row[i] += tri->dldy[i];
-			tri->lambda[i] = tri->lambda_row[i];
+			if (tri->dldx[i] > 0)
+				start = edgeSpanBound(tri, lambdaRow, i, start, end);
+			else if (tri->dldx[i] < 0)
+				end = edgeSpanBound(tri, lambdaRow, i, start, end);
+			else if (!edgeCovers(tri, rowLambda(tri, lambdaRow, i, start), i))
+				end = start;
+		}
+
+		for (size_t x = start; x < end; x += 1)
+		{
+			float lambda[3];
+			for (uint8_t i = 0; i < 3; i++)
+				lambda[i] = rowLambda(tri, lambdaRow, i, x);
+			shadeTrianglePixel(tri, fb, pl, x, y, lambda, interpolatedBuffer);
 		}
 	}
 }
 
-bool setupTriangle(SRPTriangle* tri, const SRPFramebuffer* fb)
+static size_t edgeSpanBound(
+	const SRPTriangle* tri, const float* lambdaRow, uint8_t i, size_t lo, size_t hi
+)
+{
+	// Searching for the first pixel on which the coverage equals `opens`
+	const bool opens = tri->dldx[i] > 0;
+	const double cross = tri->minBP.x - (double) lambdaRow[i] / tri->dldx[i];
+	size_t x = (cross <= lo) ? lo : (cross >= hi) ? hi : (size_t) ceil(cross);
+
+	while (x > lo && edgeCovers(tri, rowLambda(tri, lambdaRow, i, x - 1), i) == opens)
+		x--;
+	while (x < hi && edgeCovers(tri, rowLambda(tri, lambdaRow, i, x), i) != opens)
+		x++;
+	return x;
+}
+
+static inline float rowLambda(
+	const SRPTriangle* tri, const float* lambdaRow, uint8_t i, size_t x
+)
+{
+	return lambdaRow[i] + tri->dldx[i] * (float) (x - (size_t) tri->minBP.x);
+}
+
+static inline bool edgeCovers(const SRPTriangle* tri, float lambda, uint8_t i)
+{
+	return (lambda > 0.) || (ROUGHLY_ZERO(lambda) && tri->edgeTL[i]);
+}
+
+static inline void shadeTrianglePixel(
+	const SRPTriangle* tri, const SRPFramebuffer* fb, const SRPPipeline* restrict pl,
+	size_t x, size_t y, const float* lambda, void* interpolatedBuffer
+)
+{
+	float depth, recIntInvW;
+	triangleInterpolateData(tri, lambda, pl, interpolatedBuffer, &depth, &recIntInvW);
+
+	SRPFragmentShaderIn fsIn = {
+		.uniform = pl->sp->uniform,
+		.varyings = interpolatedBuffer,
+		.fragCoord = { x + 0.5, y + 0.5, depth, recIntInvW },
+		.frontFacing = tri->isFrontFacing,
+		.primitiveID = tri->id,
+	};
+	emitFragment(fb, pl, x, y, &fsIn);
+}
+
+bool setupTriangle(SRPTriangle* tri, const SRPFramebuffer* fb, const SRPPipeline* pl)
 {
 	for (uint8_t i = 0; i < 3; i++)
 		applyPerspectiveDivide(&tri->v[i], &tri->invW[i]);
@@ -120,7 +317,7 @@ bool setupTriangle(SRPTriangle* tri, const SRPFramebuffer* fb)
 		tri->p_ndc[i] = (vec3*) tri->v[i].clipPosition;
 
 	bool isCCW;
-	if (shouldCullTriangle(tri, &isCCW, &tri->isFrontFacing))
+	if (shouldCullTriangle(tri, pl, &isCCW, &tri->isFrontFacing))
 		return false;
 
 	if (!isCCW)
@@ -138,44 +335,58 @@ bool setupTriangle(SRPTriangle* tri, const SRPFramebuffer* fb)
 		return false;
 
 	// FP errors may lead to one of these being -1 => triangle not drawn
-	// Hence assuring it's at least 0 OR at most width/height of the framebuffer
+	// Hence assuring it's at least 0 OR at most width/height of the framebuffer.
+	// Also clamping to the scissor box, so the scissored-out pixels are not visited
+	const float minX = pl->scissorMinX;
+	const float minY = pl->scissorMinY;
+	const float maxX = MIN(pl->scissorMaxX, fb->width);
+	const float maxY = MIN(pl->scissorMaxY, fb->height);
 	tri->minBP = VEC2(
-		MAX(floor(MIN(tri->ss[0].x, MIN(tri->ss[1].x, tri->ss[2].x))), 0),
-		MAX(floor(MIN(tri->ss[0].y, MIN(tri->ss[1].y, tri->ss[2].y))), 0)
+		MAX(floor(MIN(tri->ss[0].x, MIN(tri->ss[1].x, tri->ss[2].x))), minX),
+		MAX(floor(MIN(tri->ss[0].y, MIN(tri->ss[1].y, tri->ss[2].y))), minY)
 	);
 	tri->maxBP = VEC2(
-		MIN(ceil(MAX(tri->ss[0].x, MAX(tri->ss[1].x, tri->ss[2].x))), fb->width),
-		MIN(ceil(MAX(tri->ss[0].y, MAX(tri->ss[1].y, tri->ss[2].y))), fb->height)
+		MIN(ceil(MAX(tri->ss[0].x, MAX(tri->ss[1].x, tri->ss[2].x))), maxX),
+		MIN(ceil(MAX(tri->ss[0].y, MAX(tri->ss[1].y, tri->ss[2].y))), maxY)
 	);
 
-	calculateBarycentrics(tri, areaX2, VEC2(tri->minBP.x + 0.5, tri->minBP.y + 0.5));
-
 	for (uint8_t i = 0; i < 3; i++)
-	{
-		tri->lambda_row[i] = tri->lambda[i];
 		tri->edgeTL[i] = isEdgeFlatTopOrLeft(&tri->edge[i]);
+
+	// Triangles of dense meshes cover a few pixel centers, if any. Those are
+	// resolved right away instead of the barycentric setup. Triangles that
+	// cover none are kept (they still take a primitive ID), but with an
+	// empty bounding box
+	const float width = tri->maxBP.x - tri->minBP.x;
+	const float height = tri->maxBP.y - tri->minBP.y;
+	tri->isSmall = width <= SMALL_TRIANGLE_SIZE && height <= SMALL_TRIANGLE_SIZE;
+	if (tri->isSmall && width > 0 && height > 0)
+		setupSmallTriangle(tri, areaX2);
+	if (width <= 0 || height <= 0 || (tri->isSmall && tri->smallCoverage == 0))
+	{
+		tri->maxBP = tri->minBP;
+		return true;
 	}
 
+	if (!tri->isSmall)
+		calculateBarycentrics(tri, areaX2, VEC2(tri->minBP.x + 0.5, tri->minBP.y + 0.5));
+
 	return true;
 }
 
-static bool shouldCullTriangle(const SRPTriangle* tri, bool* isCCW, bool* isFrontFacing)
+static bool shouldCullTriangle(
+	const SRPTriangle* tri, const SRPPipeline* pl, bool* isCCW, bool* isFrontFacing
+)
 {
 	vec3 edge0 = vec3Subtract(*tri->p_ndc[1], *tri->p_ndc[0]);
 	vec3 edge1 = vec3Subtract(*tri->p_ndc[2], *tri->p_ndc[0]);
 	float signedArea = signedAreaParallelogram(&edge0, &edge1);
 	*isCCW = signedArea > 0;
 
-	// Should have already been handled, but just in case
-	if (srpContext.raster.cullFace == SRP_FACE_FRONT_AND_BACK)
-		return true;
-
 	bool frontFacing = \
-		(signedArea > 0) & (srpContext.raster.frontFace == SRP_WINDING_CCW) ||
-		(signedArea < 0) & (srpContext.raster.frontFace == SRP_WINDING_CW);
-	bool cull = \
-		( frontFacing && srpContext.raster.cullFace == SRP_FACE_FRONT) ||
-		(!frontFacing && srpContext.raster.cullFace == SRP_FACE_BACK);
+		(signedArea > 0) & pl->frontFaceCCW ||
+		(signedArea < 0) & !pl->frontFaceCCW;
+	bool cull = (frontFacing) ? pl->cullFront : pl->cullBack;
 
 	*isFrontFacing = frontFacing;
 	return cull;
@@ -225,6 +436,48 @@ static void calculateBarycentrics(SRPTriangle* tri, float areaX2, vec2 point)
 	tri->dldy[2] = -tri->edge[0].x / areaX2;
 }
 
+static void setupSmallTriangle(SRPTriangle* tri, float areaX2)
+{
+	// lambda[i] is the edge function of the (i+1)-th edge divided by areaX2,
+	// see calculateBarycentrics(). Scale the slack to edge function units
+	float slack[3];
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		const vec3* edge = &tri->edge[(i + 1) % 3];
+		slack[i] = SMALL_TRIANGLE_SLACK * (areaX2 + fabs(edge->x) + fabs(edge->y));
+	}
+
+	tri->smallCoverage = 0;
+	for (uint8_t b = 0; b < 4; b++)
+	{
+		const float x = tri->minBP.x + (b & 1) + 0.5;
+		const float y = tri->minBP.y + (b >> 1) + 0.5;
+		if (x >= tri->maxBP.x || y >= tri->maxBP.y)
+			continue;
+
+		float e[3];
+		bool outside = false;
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			const vec3* from = &tri->ss[(i + 1) % 3];
+			vec3 toPoint = VEC3(x - from->x, y - from->y, 0);
+			e[i] = signedAreaParallelogram(&toPoint, &tri->edge[(i + 1) % 3]);
+			outside |= e[i] < -slack[i];
+		}
+		if (outside)
+			continue;
+
+		bool covered = true;
+		for (uint8_t i = 0; i < 3; i++)  // Top-left rasterization rule
+		{
+			tri->smallLambda[b][i] = e[i] / areaX2;
+			covered &= edgeCovers(tri, tri->smallLambda[b][i], i);
+		}
+		if (covered)
+			tri->smallCoverage |= 1 << b;
+	}
+}
+
 static float signedAreaParallelogram(
 	const vec3* restrict a, const vec3* restrict b
 )
@@ -238,12 +491,12 @@ static bool isEdgeFlatTopOrLeft(const vec3* restrict edge)
 }
 
 static void triangleInterpolateData(
-	SRPTriangle* tri, const SRPShaderProgram* restrict sp,
+	const SRPTriangle* tri, const float* lambda, const SRPPipeline* restrict pl,
 	SRPInterpolated* pInterpolatedBuffer, float* depth, float* recIntInvW
 )
 {
-	interpolateDepthAndWTriangle(tri->v, tri->lambda, tri->invW, sp, depth, recIntInvW);
-	interpolateAttributes(tri->v, 3, tri->lambda, tri->invW, *recIntInvW, sp, pInterpolatedBuffer);
+	interpolateDepthAndWTriangle(tri->v, lambda, tri->invW, pl, depth, recIntInvW);
+	interpolateAttributes(tri->v, 3, lambda, tri->invW, *recIntInvW, pl, pInterpolatedBuffer);
 }
 
 /** @} */  // ingroup Rasterization
@@ -10,6 +10,7 @@
 #include "srp/framebuffer.h"
 #include "srp/shaders.h"
 #include "srp/vec.h"
+#include "core/pipeline_p.h"
 
 /** @ingroup Rasterization
  *  @{ */
@@ -24,32 +25,71 @@ typedef struct SRPTriangle {
 							       (0th edge: 0th vertex -> 1st vertex, etc.) */
 	vec2 minBP;               /**< Minimum bounding point (screen-space) */
 	vec2 maxBP;               /**< Maximum bounding point (screen-space) */
-	float lambda[3];          /**< Barycentric coordinates at the current pixel */
-	float lambda_row[3];      /**< Barycentric coordinates at the beginning of the row */
-	float dldx[3];            /**< Barycentric coordinates' delta values for +X movement */
-	float dldy[3];            /**< Barycentric coordinates' delta values for +Y movement */
+	bool isSmall;             /**< Whether or not the bounding box is at most
+							       2x2 pixels and the triangle is rasterized
+							       from `smallCoverage` and `smallLambda` */
+	uint8_t smallCoverage;    /**< Covered pixel centers of a small triangle's
+							       bounding box, bit `2 * dy + dx` is set if the
+							       pixel `minBP + (dx, dy)` is covered */
+	union {
+		struct {
+			float lambda[3];  /**< Barycentric coordinates at the center of the `minBP` pixel */
+			float dldx[3];    /**< Barycentric coordinates' delta values for +X movement */
+			float dldy[3];    /**< Barycentric coordinates' delta values for +Y movement */
+		};
+		float smallLambda[4][3];  /**< Barycentric coordinates at the covered
+								       pixel centers of a small triangle,
+								       indexed as `smallCoverage` bits */
+	};
 	float invW[3];            /**< 1 / clip-space W. Needed for perspective-correct interpolation */
 	bool isFrontFacing;       /**< Whether or not the triangle is front-facing */
 	size_t id;                /**< ID of the primitive, starting from 0 */
 } SRPTriangle;
 
 /** Setup triangle for rasterization, performing perspective divide and
- *  calculating internal variables
+ *  calculating internal variables. A triangle that covers no pixel centers is
+ *  not culled, but is left with an empty bounding box (see triangleIsEmpty())
+ *  and without the barycentric setup. Small triangles get their covered pixel
+ *  centers resolved here instead of the barycentric setup
  *  @param[in] tri The triangle to set up. Its `v` field is required to be filled
  *  @param[in] fb The framebuffer to use for NDC to screen-space conversion
+ *  @param[in] pl The pipeline to use
  *  @return `false` if it is culled and should not be rasterized, `true` otherwise */
-bool setupTriangle(SRPTriangle* tri, const SRPFramebuffer* fb);
+bool setupTriangle(SRPTriangle* tri, const SRPFramebuffer* fb, const SRPPipeline* pl);
+
+/** Check if a set up triangle produces no fragments
+ *  @param[in] tri The triangle, as set up by setupTriangle()
+ *  @return Whether or not its bounding box is empty */
+static inline bool triangleIsEmpty(const SRPTriangle* tri)
+{
+	return tri->maxBP.x <= tri->minBP.x || tri->maxBP.y <= tri->minBP.y;
+}
 
 /** Rasterize a triangle
  *  @param[in] triangle Pointer to the triangle to draw
  *  @param[in] fb The framebuffer to draw to
- *  @param[in] sp The shader program to use
+ *  @param[in] pl The pipeline to use
  *  @param[in] interpolatedBuffer Pointer to a temporary buffer where varyings 
  * 			   for each fragment will be stored. Must be big enough to hold all
  * 			   interpolated attributes for ONE vertex. */
 void rasterizeTriangle(
-	SRPTriangle* triangle, const SRPFramebuffer* fb,
-	const SRPShaderProgram* restrict sp, void* interpolatedBuffer
+	const SRPTriangle* triangle, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl, void* interpolatedBuffer
+);
+
+/** Rasterize the part of a triangle inside a screen-space rectangle. The
+ *  produced fragments do not depend on the rectangle, so a triangle may be
+ *  rasterized as several non-overlapping rectangles concurrently
+ *  @param[in] triangle Pointer to the triangle to draw
+ *  @param[in] fb The framebuffer to draw to
+ *  @param[in] pl The pipeline to use
+ *  @param[in] x0,y0 Upper left corner of the rectangle, inclusive
+ *  @param[in] x1,y1 Lower right corner of the rectangle, exclusive
+ *  @param[in] interpolatedBuffer @see rasterizeTriangle() */
+void rasterizeTriangleRect(
+	const SRPTriangle* triangle, const SRPFramebuffer* fb,
+	const SRPPipeline* restrict pl, size_t x0, size_t y0, size_t x1, size_t y1,
+	void* interpolatedBuffer
 );
 
 /** @} */  // ingroup Rasterization
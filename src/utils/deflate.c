@@ -0,0 +1,343 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Various_internal
+ *  Deflate compressor and checksums implementation */
+
+#include <string.h>
+#include <stdbool.h>
+#include <threads.h>
+#include "utils/deflate.h"
+#include "utils/defines.h"
+#include "math/utils.h"
+
+/** @ingroup Various_internal
+ *  @{ */
+
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define WINDOW_SIZE 32768
+#define WINDOW_MASK (WINDOW_SIZE - 1)
+#define HASH_BITS 15
+#define MAX_STORED_BLOCK 65535
+/** Largest prime smaller than 65536 */
+#define ADLER_BASE 65521
+/** Most bytes summed before the Adler-32 sums may overflow 32 bits */
+#define ADLER_NMAX 5552
+
+/** Writes bits least significant first, as deflate packs them */
+typedef struct BitWriter
+{
+	uint8_t* out;     /**< Where the next complete byte goes */
+	uint64_t bits;    /**< Pending bits */
+	unsigned count;   /**< Amount of pending bits, less than 8 between calls */
+} BitWriter;
+
+const uint8_t deflateFinalBlock[DEFLATE_FINAL_BLOCK_SIZE] = {0x03, 0x00};
+
+/** Hash chain lengths searched at every compression level */
+static const unsigned maxChainLengths[10] = {0, 4, 8, 16, 32, 64, 128, 256, 1024, 4096};
+
+static const uint16_t lengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t lengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t distanceBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t distanceExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/** Fixed Huffman codes of literal/length symbols, bit-reversed for BitWriter */
+static uint16_t fixedCodes[288];
+/** Lengths of `fixedCodes` */
+static uint8_t fixedCodeLengths[288];
+/** Length symbol minus 257 of every match length */
+static uint8_t lengthCodes[MAX_MATCH + 1];
+/** Distance code of distances 1 to 256 (index `distance - 1`), and of the
+ *  larger ones by `(distance - 1) >> 7` starting from index 256 */
+static uint8_t distanceCodes[512];
+/** CRC-32 tables for slicing by 8: `crcTables[k][b]` is the CRC of byte `b`
+ *  followed by `k` zero bytes */
+static uint32_t crcTables[8][256];
+static once_flag tablesOnce = ONCE_FLAG_INIT;
+
+/** Fill the tables above. Called through `call_once()` */
+static void fillTables(void);
+
+/** Reverse the lowest `n` bits of `code` */
+static uint16_t reverseBits(uint16_t code, unsigned n);
+
+/** Write `n` (at most 32) bits to a BitWriter */
+static inline void bitsPut(BitWriter* w, uint32_t value, unsigned n);
+
+/** Pad the BitWriter's pending bits with zeros to a byte boundary */
+static inline void bitsAlign(BitWriter* w);
+
+/** Store data in stored blocks. @see deflateCompress() */
+static size_t deflateStore(const uint8_t* data, size_t size, uint8_t* out);
+
+/** Get the distance code of a match distance, in [1, WINDOW_SIZE] */
+static inline unsigned distanceCode(size_t distance);
+
+/** Hash the 3 bytes starting at `p` */
+static inline uint32_t hash3(const uint8_t* p);
+
+size_t deflateBound(size_t size)
+{
+	// Fixed codes take at most 9 bits per byte; stored blocks add 5 bytes
+	// per block; plus the block header, end of block and a sync flush
+	return size + size / 8 + 5 * (size / MAX_STORED_BLOCK + 1) + 16;
+}
+
+size_t deflateCompress(const uint8_t* data, size_t size, int level, uint8_t* out)
+{
+	if (level <= 0)
+		return deflateStore(data, size, out);
+	if (size == 0)
+		return 0;
+	call_once(&tablesOnce, fillTables);
+
+	const unsigned maxChain = maxChainLengths[MIN(level, 9)];
+	// Fast levels do not index the bytes inside matches, as zlib's do
+	const bool insertAll = level >= 4;
+	int32_t* head = SRP_MALLOC(sizeof(int32_t) << HASH_BITS);
+	int32_t* prev = SRP_MALLOC(sizeof(int32_t) * WINDOW_SIZE);
+	memset(head, 0xFF, sizeof(int32_t) << HASH_BITS);
+
+	BitWriter w = {.out = out};
+	bitsPut(&w, 1 << 1, 3);  // Not final, fixed Huffman codes
+
+	size_t i = 0;
+	while (i < size)
+	{
+		size_t bestLength = 0, bestDistance = 0;
+		if (i + MIN_MATCH <= size)
+		{
+			const uint32_t h = hash3(data + i);
+			const size_t maxLength = MIN(MAX_MATCH, size - i);
+			int32_t candidate = head[h];
+			for (unsigned chain = maxChain; candidate >= 0 && chain > 0; chain--)
+			{
+				const size_t distance = i - candidate;
+				if (distance > WINDOW_SIZE)
+					break;
+				// The byte that would make the match longer decides quickly
+				if (data[candidate + bestLength] == data[i + bestLength])
+				{
+					size_t length = 0;
+					while (length < maxLength && data[candidate + length] == data[i + length])
+						length++;
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestDistance = distance;
+						if (length == maxLength)
+							break;
+					}
+				}
+				candidate = prev[candidate & WINDOW_MASK];
+			}
+			prev[i & WINDOW_MASK] = head[h];
+			head[h] = i;
+		}
+
+		if (bestLength >= MIN_MATCH)
+		{
+			const unsigned lc = lengthCodes[bestLength];
+			bitsPut(&w, fixedCodes[257 + lc], fixedCodeLengths[257 + lc]);
+			bitsPut(&w, bestLength - lengthBase[lc], lengthExtra[lc]);
+			const unsigned dc = distanceCode(bestDistance);
+			bitsPut(&w, reverseBits(dc, 5), 5);
+			bitsPut(&w, bestDistance - distanceBase[dc], distanceExtra[dc]);
+
+			if (insertAll)
+			{
+				for (size_t j = i + 1; j < i + bestLength && j + MIN_MATCH <= size; j++)
+				{
+					const uint32_t h = hash3(data + j);
+					prev[j & WINDOW_MASK] = head[h];
+					head[h] = j;
+				}
+			}
+			i += bestLength;
+		}
+		else
+		{
+			bitsPut(&w, fixedCodes[data[i]], fixedCodeLengths[data[i]]);
+			i++;
+		}
+	}
+	bitsPut(&w, fixedCodes[256], fixedCodeLengths[256]);  // End of block
+
+	// Sync flush: an empty stored block aligns the output to a byte
+	bitsPut(&w, 0, 3);
+	bitsAlign(&w);
+	memcpy(w.out, (uint8_t[]) {0x00, 0x00, 0xFF, 0xFF}, 4);
+	w.out += 4;
+
+	SRP_FREE(head);
+	SRP_FREE(prev);
+	return w.out - out;
+}
+
+uint32_t adler32Update(uint32_t adler, const uint8_t* data, size_t size)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	while (size > 0)
+	{
+		const size_t n = MIN(size, ADLER_NMAX);
+		for (size_t i = 0; i < n; i++)
+		{
+			a += data[i];
+			b += a;
+		}
+		a %= ADLER_BASE;
+		b %= ADLER_BASE;
+		data += n;
+		size -= n;
+	}
+	return (b << 16) | a;
+}
+
+uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t size2)
+{
+	// The bytes of the first piece are summed `size2` more times into `b`
+	const uint32_t rem = size2 % ADLER_BASE;
+	const uint32_t a1 = adler1 & 0xFFFF, b1 = adler1 >> 16;
+	const uint32_t a2 = adler2 & 0xFFFF, b2 = adler2 >> 16;
+	const uint32_t a = (a1 + a2 + ADLER_BASE - 1) % ADLER_BASE;
+	const uint32_t b = ((uint64_t) rem * a1 + b1 + b2 + ADLER_BASE - rem) % ADLER_BASE;
+	return (b << 16) | a;
+}
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size)
+{
+	call_once(&tablesOnce, fillTables);
+	crc = ~crc;
+	// 8 bytes at once, each through its own table, then the tail bytewise
+	for (; size >= 8; size -= 8, data += 8)
+	{
+		const uint32_t lo = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | (uint32_t) data[3] << 24);
+		crc = crcTables[7][lo & 0xFF] ^ crcTables[6][(lo >> 8) & 0xFF] ^
+		      crcTables[5][(lo >> 16) & 0xFF] ^ crcTables[4][lo >> 24] ^
+		      crcTables[3][data[4]] ^ crcTables[2][data[5]] ^
+		      crcTables[1][data[6]] ^ crcTables[0][data[7]];
+	}
+	for (size_t i = 0; i < size; i++)
+		crc = crcTables[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void fillTables(void)
+{
+	for (unsigned s = 0; s < 288; s++)
+	{
+		unsigned code, length;
+		if (s < 144)
+			code = 0x30 + s, length = 8;
+		else if (s < 256)
+			code = 0x190 + (s - 144), length = 9;
+		else if (s < 280)
+			code = s - 256, length = 7;
+		else
+			code = 0xC0 + (s - 280), length = 8;
+		fixedCodes[s] = reverseBits(code, length);
+		fixedCodeLengths[s] = length;
+	}
+
+	for (unsigned lc = 0; lc < 29; lc++)
+	{
+		const unsigned end = (lc == 28) ? MAX_MATCH + 1 : lengthBase[lc + 1];
+		for (unsigned length = lengthBase[lc]; length < end; length++)
+			lengthCodes[length] = lc;
+	}
+
+	for (unsigned dc = 0; dc < 30; dc++)
+	{
+		const unsigned end = distanceBase[dc] + (1u << distanceExtra[dc]);
+		for (unsigned distance = distanceBase[dc]; distance < end; distance++)
+		{
+			if (distance <= 256)
+				distanceCodes[distance - 1] = dc;
+			else
+				distanceCodes[256 + ((distance - 1) >> 7)] = dc;
+		}
+	}
+
+	for (uint32_t n = 0; n < 256; n++)
+	{
+		uint32_t c = n;
+		for (int k = 0; k < 8; k++)
+			c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+		crcTables[0][n] = c;
+	}
+	for (uint32_t n = 0; n < 256; n++)
+		for (int k = 1; k < 8; k++)
+			crcTables[k][n] = crcTables[0][crcTables[k - 1][n] & 0xFF] ^ (crcTables[k - 1][n] >> 8);
+}
+
+static uint16_t reverseBits(uint16_t code, unsigned n)
+{
+	uint16_t reversed = 0;
+	for (unsigned i = 0; i < n; i++)
+		reversed |= ((code >> i) & 1) << (n - 1 - i);
+	return reversed;
+}
+
+static inline void bitsPut(BitWriter* w, uint32_t value, unsigned n)
+{
+	w->bits |= (uint64_t) value << w->count;
+	w->count += n;
+	while (w->count >= 8)
+	{
+		*w->out++ = (uint8_t) w->bits;
+		w->bits >>= 8;
+		w->count -= 8;
+	}
+}
+
+static inline void bitsAlign(BitWriter* w)
+{
+	if (w->count > 0)
+		bitsPut(w, 0, 8 - w->count);
+}
+
+static size_t deflateStore(const uint8_t* data, size_t size, uint8_t* out)
+{
+	uint8_t* p = out;
+	for (size_t offset = 0; offset < size; offset += MAX_STORED_BLOCK)
+	{
+		const uint16_t length = MIN(MAX_STORED_BLOCK, size - offset);
+		// Not final, stored; the header is padded to a byte
+		*p++ = 0x00;
+		*p++ = length & 0xFF;
+		*p++ = length >> 8;
+		*p++ = ~length & 0xFF;
+		*p++ = (uint16_t) ~length >> 8;
+		memcpy(p, data + offset, length);
+		p += length;
+	}
+	return p - out;
+}
+
+static inline unsigned distanceCode(size_t distance)
+{
+	return (distance <= 256) ? distanceCodes[distance - 1] : distanceCodes[256 + ((distance - 1) >> 7)];
+}
+
+static inline uint32_t hash3(const uint8_t* p)
+{
+	const uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/** @} */  // ingroup Various_internal
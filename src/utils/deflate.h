@@ -0,0 +1,57 @@
+// Software Rendering Pipeline (SRP) library
+// Licensed under GNU GPLv3
+
+/** @file
+ *  @ingroup Various_internal
+ *  Minimal deflate compressor and the checksums of zlib and PNG streams */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @ingroup Various_internal
+ *  @{ */
+
+/** Size of the block terminating a stream made of deflateCompress() outputs */
+#define DEFLATE_FINAL_BLOCK_SIZE 2
+
+/** Bytes of an empty final block with fixed Huffman codes, terminating a
+ *  stream made of deflateCompress() outputs */
+extern const uint8_t deflateFinalBlock[DEFLATE_FINAL_BLOCK_SIZE];
+
+/** Get the maximum size of the output of deflateCompress()
+ *  @param[in] size Size of the data to compress
+ *  @return Upper bound of the compressed size, in bytes */
+size_t deflateBound(size_t size);
+
+/** Compress data into non-final deflate blocks. The output always ends on a
+ *  byte boundary (with an empty stored block if needed, as a zlib sync flush
+ *  does), so the outputs of independent calls can be concatenated into one
+ *  stream, which is then terminated with `deflateFinalBlock`. Matches are only
+ *  searched for within `data`
+ *  @param[in] data The data to compress
+ *  @param[in] size Size of `data`, less than 2 GiB
+ *  @param[in] level 0 stores the data as is; 1 to 9 use LZ77 with fixed
+ *                   Huffman codes, searching longer hash chains for higher
+ *                   levels
+ *  @param[out] out Where to write the blocks to, at least
+ *                  `deflateBound(size)` bytes
+ *  @return Amount of bytes written */
+size_t deflateCompress(const uint8_t* data, size_t size, int level, uint8_t* out);
+
+/** Update an Adler-32 checksum (1 initially) with more data */
+uint32_t adler32Update(uint32_t adler, const uint8_t* data, size_t size);
+
+/** Get the Adler-32 checksum of two consecutive pieces of data
+ *  @param[in] adler1 Checksum of the first piece
+ *  @param[in] adler2 Checksum of the second piece
+ *  @param[in] size2 Size of the second piece
+ *  @return Checksum of the concatenation */
+uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t size2);
+
+/** Update a CRC-32 checksum (0 initially), as used by PNG and zip, with
+ *  more data */
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size);
+
+/** @} */  // ingroup Various_internal
@@ -7,7 +7,6 @@
 
 #include <stdio.h>
 #include <stdarg.h>
-#include "srp/context.h"
 #include "srp/message_callback.h"
 
 /** @ingroup Context_internal
@@ -15,21 +14,32 @@
 
 #define MAX_CHARS_IN_MESSAGE 1024
 
+/** Message callback shared by all contexts */
+static SRPMessageCallback messageCallback = {
+	.func = NULL,
+	.userParameter = NULL
+};
+
+void srpSetMessageCallback(SRPMessageCallback callback)
+{
+	messageCallback = callback;
+}
+
 void srpMessageCallbackHelper(
 	SRPMessageType type, SRPMessageSeverity severity,
 	const char* sourceFunction, const char* format, ...
 )
 {
-	if (srpContext.messageCallback.func != NULL)
+	if (messageCallback.func != NULL)
 	{
 		char string[MAX_CHARS_IN_MESSAGE];
 		va_list variadic;
 		va_start(variadic, format);
 		vsnprintf(string, MAX_CHARS_IN_MESSAGE, format, variadic);
 
-		srpContext.messageCallback.func(
+		messageCallback.func(
 			type, severity, sourceFunction, string,
-			srpContext.messageCallback.userParameter
+			messageCallback.userParameter
 		);
 	}
 }
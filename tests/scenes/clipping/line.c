@@ -23,8 +23,6 @@ typedef struct Uniform
 	mat4 projection;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -78,8 +76,8 @@ int main(int argc, char** argv)
         }
     };
 
-    srpNewContext(&srpContext);
-	srpDepthTest(true);
+    SRPContext* ctx = srpNewContext();
+	srpDepthTest(ctx, true);
     SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 
     SRPVertexBuffer* vb = srpNewVertexBuffer();
@@ -88,12 +86,13 @@ int main(int argc, char** argv)
     srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
 
     srpFramebufferClear(fb);
-    srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_LINES, 0, 24);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_LINES, 0, 24);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
     srpFreeVertexBuffer(vb);
     srpFreeFramebuffer(fb);
+    srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
@@ -16,8 +16,6 @@ typedef struct Uniform
 	mat4 projection;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fsPrimitive(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 void fsWhite(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
@@ -65,10 +63,10 @@ int main(int argc, char** argv)
 		.mayOverwriteDepth = false
 	};
 
-	srpNewContext(&srpContext);
-	srpRasterPolygonMode(SRP_POLYGON_MODE_LINE);
-	srpRasterPointSize(3.);
-	srpDepthTest(true);
+	SRPContext* ctx = srpNewContext();
+	srpRasterPolygonMode(ctx, SRP_POLYGON_MODE_LINE);
+	srpRasterPointSize(ctx, 3.);
+	srpDepthTest(ctx, true);
 
 	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 	SRPVertexBuffer* vb = srpNewVertexBuffer();
@@ -77,14 +75,15 @@ int main(int argc, char** argv)
 	srpIndexBufferCopyData(ib, SRP_UINT32, mesh.indexCount * sizeof(uint32_t), mesh.indices);
 
     srpFramebufferClear(fb);
-    srpDrawIndexBuffer(ib, vb, fb, &sp1, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
-    srpDrawIndexBuffer(ib, vb, fb, &sp2, SRP_PRIM_POINTS, 0, mesh.indexCount);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &sp1, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &sp2, SRP_PRIM_POINTS, 0, mesh.indexCount);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
 	srpFreeVertexBuffer(vb);
 	srpFreeIndexBuffer(ib);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 	freeOBJMesh(&mesh);
 
     return ok ? 0 : 1;
@@ -26,8 +26,6 @@ typedef struct Uniform
 	SRPTexture* texture;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -103,10 +101,10 @@ int main(int argc, char** argv)
 		}
 	};
 
-	srpNewContext(&srpContext);
-	srpRasterFrontFace(SRP_WINDING_CCW);
-	srpRasterCullFace(SRP_FACE_BACK);
-    srpDepthTest(true);
+	SRPContext* ctx = srpNewContext();
+	srpRasterFrontFace(ctx, SRP_WINDING_CCW);
+	srpRasterCullFace(ctx, SRP_FACE_BACK);
+    srpDepthTest(ctx, true);
 
 	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 	SRPVertexBuffer* vb = srpNewVertexBuffer();
@@ -115,7 +113,7 @@ int main(int argc, char** argv)
 	srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
 
     srpFramebufferClear(fb);
-    srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
@@ -123,6 +121,7 @@ int main(int argc, char** argv)
 	srpFreeVertexBuffer(vb);
 	srpFreeIndexBuffer(ib);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
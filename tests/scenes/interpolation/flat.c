@@ -21,8 +21,6 @@ typedef struct Uniform
 	mat4 model;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -56,7 +54,7 @@ int main(int argc, char** argv)
         }
     };
 
-    srpNewContext(&srpContext);
+    SRPContext* ctx = srpNewContext();
     SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
     srpFramebufferClear(fb);
 
@@ -64,19 +62,20 @@ int main(int argc, char** argv)
     srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
 
     // Expected: left, red
-    srpProvokingVertexMode(SRP_PROVOKING_VERTEX_FIRST);
+    srpProvokingVertexMode(ctx, SRP_PROVOKING_VERTEX_FIRST);
     uniform.model = mat4ConstructTRS(-0.5, 0, 0,   0, 0, 0,   0.5, 0.5, 0.5);
-    srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+    srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
 
     // Expected: right, blue
-    srpProvokingVertexMode(SRP_PROVOKING_VERTEX_LAST);
+    srpProvokingVertexMode(ctx, SRP_PROVOKING_VERTEX_LAST);
     uniform.model = mat4ConstructTRS( 0.5, 0, 0,   0, 0, 0,   0.5, 0.5, 0.5);
-    srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+    srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
     srpFreeVertexBuffer(vb);
     srpFreeFramebuffer(fb);
+    srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
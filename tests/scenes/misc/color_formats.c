@@ -0,0 +1,133 @@
+#define SRP_INCLUDE_VEC
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	vec3 position;
+	vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec3 color;
+} VSOutput;
+
+typedef struct Uniform
+{
+	float exposure;
+} Uniform;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+static const SRPColorFormat formats[] = {
+	SRP_COLOR_FORMAT_RGBA8, SRP_COLOR_FORMAT_BGRA8,
+	SRP_COLOR_FORMAT_RGB565, SRP_COLOR_FORMAT_RGBA16F
+};
+#define N_FORMATS (sizeof(formats) / sizeof(formats[0]))
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	Vertex data[] = {
+		{ .position = VEC3(-0.8, -0.8, 0.), .color = VEC3(1., 0., 0.) },
+		{ .position = VEC3( 0.8, -0.8, 0.), .color = VEC3(0., 1., 0.) },
+		{ .position = VEC3(-0.8,  0.8, 0.), .color = VEC3(0., 0., 1.) },
+		{ .position = VEC3( 0.8,  0.8, 0.), .color = VEC3(1., 1., 1.) },
+	};
+
+	// Over 1 in a corner, which only the half float format keeps
+	Uniform uniform = {.exposure = 1.5};
+	SRPShaderProgram shaderProgram = {
+		.uniform = (SRPUniform*) &uniform,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+
+	SRPFramebuffer* fbs[N_FORMATS];
+	for (size_t i = 0; i < N_FORMATS; i++)
+	{
+		fbs[i] = srpNewFramebufferFormat(256, 256, formats[i]);
+		assert(srpColorFormatSize(formats[i]) > 0);
+		srpFramebufferClear(fbs[i]);
+		srpDrawVertexBuffer(ctx, vb, fbs[i], &shaderProgram, SRP_PRIM_TRIANGLE_STRIP, 0, 4);
+	}
+
+	// Every format has to hold the same image, up to its precision
+	bool ok = true, hdr = false;
+	const SRPFramebuffer* reference = fbs[0];
+	for (size_t p = 0; p < reference->size; p++)
+	{
+		const uint32_t rgba = ((uint32_t*) reference->color)[p];
+		const uint8_t bytes[4] = {rgba >> 24, rgba >> 16, rgba >> 8, rgba};
+		const uint8_t bgra[4] = {bytes[2], bytes[1], bytes[0], bytes[3]};
+		ok &= memcmp((uint32_t*) fbs[1]->color + p, bgra, 4) == 0;
+
+		float rgb565[4], half[4];
+		srpFramebufferReadPixel(fbs[2], p % reference->width, p / reference->width, rgb565);
+		srpFramebufferReadPixel(fbs[3], p % reference->width, p / reference->width, half);
+		// RGBA8 truncates, the other formats round
+		for (int c = 0; c < 3; c++)
+		{
+			ok &= fabsf(rgb565[c] - bytes[c] / 255.f) <= 1 / 31.f;
+			ok &= fabsf(fminf(half[c], 1) - bytes[c] / 255.f) <= 2 / 255.f;
+			hdr |= half[c] > 1.25;
+		}
+	}
+	if (!ok || !hdr)
+		fprintf(stderr, "Color formats do not match (hdr: %i)\n", hdr);
+
+	int saved = saveFramebufferToImage(fbs[2], outputPath);
+
+	for (size_t i = 0; i < N_FORMATS; i++)
+		srpFreeFramebuffer(fbs[i]);
+	srpFreeVertexBuffer(vb);
+	srpFreeContext(ctx);
+
+	return (saved && ok && hdr) ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* v = (Vertex*) in->vertex;
+	VSOutput* o = (VSOutput*) out->varyings;
+
+	vec4* outPos = (vec4*) out->clipPosition;
+	*outPos = VEC4_FROM_VEC3(v->position, 1.);
+	o->color = v->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* i = (VSOutput*) in->varyings;
+	Uniform* u = (Uniform*) in->uniform;
+
+	out->color[0] = i->color.x * u->exposure;
+	out->color[1] = i->color.y * u->exposure;
+	out->color[2] = i->color.z * u->exposure;
+	out->color[3] = 1.;
+}
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include <stb_image.h>
+
+typedef struct Vertex
+{
+	float position[2];
+	float color[4];
+} Vertex;
+
+typedef struct Uniform
+{
+	float offset[2];
+} Uniform;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Draw the widgets that move every frame: a triangle, a wide line and points */
+static void drawWidgets(
+	SRPContext* ctx, SRPFramebuffer* fb, SRPVertexBuffer* vb,
+	SRPShaderProgram* sp, Uniform* uniform, float offset
+);
+/** Whether every pixel that differs between the color buffers is in `rect` */
+static bool changesInside(const SRPFramebuffer* fb, const uint32_t* before, const SRPRect* rect);
+
+#define WIDTH 320
+#define HEIGHT 240
+#define N_FRAMES 8
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	Vertex data[] = {
+		// Static, drawn once
+		{{-0.9,  0.9}, {1, 1, 0, 1}},
+		{{-0.5,  0.9}, {1, 0, 1, 1}},
+		{{-0.9,  0.4}, {0, 1, 1, 1}},
+		// Moving triangle
+		{{-0.9, -0.9}, {1, 0, 0, 1}},
+		{{-0.7, -0.9}, {0, 1, 0, 1}},
+		{{-0.8, -0.6}, {0, 0, 1, 1}},
+		// Moving line and points
+		{{-0.9, -0.3}, {1, 1, 1, 1}},
+		{{-0.6, -0.2}, {1, 1, 1, 1}},
+		{{-0.75, -0.05}, {1, 0.5, 0, 1}}
+	};
+
+	Uniform uniform = {0};
+	SRPShaderProgram shaderProgram = {
+		.uniform = (SRPUniform*) &uniform,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 4,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(float) * 4
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpThreadCount(ctx, 4);
+	srpRasterLineWidth(ctx, 3);
+	srpRasterPointSize(ctx, 5);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+	SRPFramebuffer* fb = srpNewFramebuffer(WIDTH, HEIGHT);
+	SRPFramebuffer* reference = srpNewFramebuffer(WIDTH, HEIGHT);
+	uint32_t* before = malloc(sizeof(uint32_t) * WIDTH * HEIGHT);
+
+	// Clears are not damage
+	srpFramebufferClear(fb);
+	SRPRect damage = srpFramebufferDamage(fb);
+	bool ok = damage.x1 == 0 && damage.y1 == 0;
+
+	// Neither is the static content for the frames that follow
+	srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+	srpFinish(ctx);
+	damage = srpFramebufferDamage(fb);
+	ok &= damage.x0 < damage.x1 && damage.y0 < damage.y1;
+	srpFramebufferResetDamage(fb);
+	drawWidgets(ctx, fb, vb, &shaderProgram, &uniform, 0);
+	srpFinish(ctx);
+
+	for (size_t frame = 1; frame <= N_FRAMES; frame++)
+	{
+		// Clear and redraw only what the previous frame touched
+		const SRPRect previous = srpFramebufferDamage(fb);
+		srpFramebufferResetDamage(fb);
+		memcpy(before, fb->color, sizeof(uint32_t) * WIDTH * HEIGHT);
+		srpFramebufferClearRect(fb, &previous);
+		drawWidgets(ctx, fb, vb, &shaderProgram, &uniform, frame * 0.2);
+		srpFinish(ctx);
+
+		// Along with the previous one, the damage covers everything that
+		// changed, and little else
+		damage = srpFramebufferDamage(fb);
+		const SRPRect present = srpRectUnion(previous, damage);
+		ok &= changesInside(fb, before, &present);
+		ok &= (damage.x1 - damage.x0) * (damage.y1 - damage.y0) < WIDTH * HEIGHT / 8;
+		ok &= (present.x1 - present.x0) * (present.y1 - present.y0) < WIDTH * HEIGHT / 4;
+
+		// Same as redrawing everything
+		srpFramebufferClear(reference);
+		srpDrawVertexBuffer(ctx, vb, reference, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+		drawWidgets(ctx, reference, vb, &shaderProgram, &uniform, frame * 0.2);
+		srpFinish(ctx);
+		ok &= memcmp(fb->color, reference->color, sizeof(uint32_t) * WIDTH * HEIGHT) == 0;
+	}
+
+	// Only the damage is exported
+	damage = srpFramebufferDamage(fb);
+	const size_t width = damage.x1 - damage.x0, height = damage.y1 - damage.y0;
+	size_t size;
+	uint32_t* raw = srpFramebufferEncode(ctx, fb, &(SRPExportOptions) {
+		.format = SRP_IMAGE_FORMAT_RAW, .rect = &damage
+	}, &size);
+	uint8_t* png = srpFramebufferEncode(ctx, fb, &(SRPExportOptions) {
+		.format = SRP_IMAGE_FORMAT_PNG, .alpha = true, .compressionLevel = 6, .rect = &damage
+	}, &size);
+	int decodedWidth, decodedHeight, channels;
+	uint32_t* decoded = (uint32_t*) stbi_load_from_memory(png, size, &decodedWidth, &decodedHeight, &channels, 4);
+	ok &= decoded != NULL && (size_t) decodedWidth == width && (size_t) decodedHeight == height;
+	for (size_t y = 0; ok && y < height; y++)
+	{
+		for (size_t x = 0; x < width; x++)
+		{
+			const uint32_t c = ((uint32_t*) fb->color)[(damage.y0 + y) * WIDTH + damage.x0 + x];
+			const uint8_t* d = (const uint8_t*) &decoded[y * width + x];
+			ok &= raw[y * width + x] == c;
+			ok &= d[0] == (uint8_t) (c >> 24) && d[1] == (uint8_t) (c >> 16) && \
+				d[2] == (uint8_t) (c >> 8) && d[3] == (uint8_t) c;
+		}
+	}
+
+	if (!ok)
+		fprintf(stderr, "Damage does not match the drawn pixels\n");
+	ok &= srpFramebufferExport(ctx, fb, &(SRPExportOptions) {
+		.format = SRP_IMAGE_FORMAT_PNG, .compressionLevel = 6
+	}, outputPath);
+
+	free(before);
+	free(decoded);
+	srpFreeEncodedImage(raw);
+	srpFreeEncodedImage(png);
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(reference);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+static void drawWidgets(
+	SRPContext* ctx, SRPFramebuffer* fb, SRPVertexBuffer* vb,
+	SRPShaderProgram* sp, Uniform* uniform, float offset
+)
+{
+	uniform->offset[0] = offset;
+	srpDrawVertexBuffer(ctx, vb, fb, sp, SRP_PRIM_TRIANGLES, 3, 3);
+	srpDrawVertexBuffer(ctx, vb, fb, sp, SRP_PRIM_LINES, 6, 2);
+	srpDrawVertexBuffer(ctx, vb, fb, sp, SRP_PRIM_POINTS, 6, 3);
+	uniform->offset[0] = 0;
+}
+
+static bool changesInside(const SRPFramebuffer* fb, const uint32_t* before, const SRPRect* rect)
+{
+	const uint32_t* color = fb->color;
+	for (size_t y = 0; y < fb->height; y++)
+	{
+		for (size_t x = 0; x < fb->width; x++)
+		{
+			const bool inside = x >= rect->x0 && x < rect->x1 && y >= rect->y0 && y < rect->y1;
+			if (!inside && color[y * fb->width + x] != before[y * fb->width + x])
+				return false;
+		}
+	}
+	return true;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	Uniform* uniform = (Uniform*) in->uniform;
+	float* varyings = (float*) out->varyings;
+
+	// The static triangle does not move
+	const float offset = (in->vertexID < 3) ? 0 : uniform->offset[0];
+	out->clipPosition[0] = pVertex->position[0] + offset;
+	out->clipPosition[1] = pVertex->position[1];
+	out->clipPosition[2] = 0;
+	out->clipPosition[3] = 1;
+	for (int i = 0; i < 4; i++)
+		varyings[i] = pVertex->color[i];
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	float* varyings = (float*) in->varyings;
+	for (int i = 0; i < 4; i++)
+		out->color[i] = varyings[i];
+}
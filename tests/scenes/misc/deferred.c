@@ -0,0 +1,207 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+#include "objparser.h"
+#include "rad.h"
+
+typedef struct Uniform
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+	vec3 lightDirection;
+} Uniform;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void gBufferFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+void forwardFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Checkerboard albedo of the surface */
+static void albedo(const float uv[2], float out[4]);
+/** Lambertian lighting with an ambient term */
+static void shade(const float albedo[4], const float normal[3], const vec3* light, float out[4]);
+
+#define SIZE 512
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	OBJMesh mesh;
+	if (!loadOBJMesh("res/objects/utah_teapot.obj", &mesh))
+	{
+		fprintf(stderr, "Failed to load mesh!\n");
+		return -1;
+	}
+
+	Uniform uniform = {
+		.model = mat4ConstructRotate(RAD(-90), 0.3, 0),
+		.view = mat4ConstructView(
+			0, 1.75, -6,
+			0, 0, 0,
+			1, 1, 1
+		),
+		.projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 1, 10),
+		.lightDirection = vec3Normalize((vec3) {.x = 0.5, .y = 1, .z = -0.75})
+	};
+
+	SRPFragmentShader gBufferShader = {
+		.shader = gBufferFragmentShader,
+		.mayOverwriteDepth = false
+	};
+	SRPFragmentShader forwardShader = {
+		.shader = forwardFragmentShader,
+		.mayOverwriteDepth = false
+	};
+	SRPShaderProgram shaderProgram = {
+		.uniform = (SRPUniform*) &uniform,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 2,
+			.varyingsInfo = (SRPVaryingInfo[]) {
+				{
+					.nItems = 2,
+					.type = SRP_FLOAT,
+					.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+				},
+				{
+					.nItems = 3,
+					.type = SRP_FLOAT,
+					.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+				}
+			},
+			.varyingsSize = sizeof(float) * 5
+		},
+		.fs = &gBufferShader
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpDepthTest(ctx, true);
+
+	// Albedo and normals, one pass
+	const SRPColorFormat formats[] = {SRP_COLOR_FORMAT_RGBA8, SRP_COLOR_FORMAT_RGBA16F};
+	SRPFramebuffer* gBuffer = srpNewFramebufferAttachments(SIZE, SIZE, 2, formats);
+	SRPFramebuffer* forward = srpNewFramebuffer(SIZE, SIZE);
+	SRPFramebuffer* deferred = srpNewFramebuffer(SIZE, SIZE);
+	assert(gBuffer->nColorAttachments == 2);
+
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(OBJVertex), mesh.vertexCount * sizeof(OBJVertex), mesh.vertices);
+	srpIndexBufferCopyData(ib, SRP_UINT32, mesh.indexCount * sizeof(uint32_t), mesh.indices);
+
+	srpFramebufferClear(gBuffer);
+	srpDrawIndexBuffer(ctx, ib, vb, gBuffer, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
+
+	shaderProgram.fs = &forwardShader;
+	srpFramebufferClear(forward);
+	srpDrawIndexBuffer(ctx, ib, vb, forward, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
+	srpFinish(ctx);
+
+	// Lighting pass over the G-buffer: it has to match forward shading up
+	// to the precision of the G-buffer formats
+	bool ok = true;
+	uint32_t* out = deferred->color;
+	for (size_t y = 0; y < SIZE; y++)
+	{
+		for (size_t x = 0; x < SIZE; x++)
+		{
+			float color[4], normal[4], lit[4] = {0};
+			srpFramebufferReadAttachmentPixel(gBuffer, 0, x, y, color);
+			srpFramebufferReadAttachmentPixel(gBuffer, 1, x, y, normal);
+			if (color[3] > 0)
+				shade(color, normal, &uniform.lightDirection, lit);
+
+			out[y * SIZE + x] = 0;
+			for (int c = 0; c < 4; c++)
+				out[y * SIZE + x] |= (uint32_t) roundf(lit[c] * 255) << (24 - 8 * c);
+
+			float expected[4];
+			srpFramebufferReadPixel(forward, x, y, expected);
+			for (int c = 0; c < 4; c++)
+				ok &= fabsf(lit[c] - expected[c]) <= 2 / 255.f;
+		}
+	}
+
+	// Compositing is only defined for a single color buffer
+	srpFramebufferComposite(ctx, forward, (const SRPFramebuffer*[]) {gBuffer}, 1);
+
+	if (!ok)
+		fprintf(stderr, "Deferred shading does not match forward shading\n");
+	ok &= saveFramebufferToImage(deferred, outputPath);
+
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	srpFreeFramebuffer(deferred);
+	srpFreeFramebuffer(forward);
+	srpFreeFramebuffer(gBuffer);
+	srpFreeContext(ctx);
+	freeOBJMesh(&mesh);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	OBJVertex* pVertex = (OBJVertex*) in->vertex;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	float* varyings = (float*) out->varyings;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4_FROM_VEC3(pVertex->position, 1.);
+	*outPosition = mat4MultiplyVec4(&pUniform->model, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->view, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->projection, *outPosition);
+
+	const vec4 normal = mat4MultiplyVec4(&pUniform->model, VEC4_FROM_VEC3(pVertex->normal, 0.));
+	varyings[0] = pVertex->uv.x;
+	varyings[1] = pVertex->uv.y;
+	varyings[2] = normal.x;
+	varyings[3] = normal.y;
+	varyings[4] = normal.z;
+}
+
+void gBufferFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	float* varyings = (float*) in->varyings;
+	const vec3 normal = vec3Normalize((vec3) {.x = varyings[2], .y = varyings[3], .z = varyings[4]});
+
+	albedo(varyings, out->color);
+	out->extraColors[0][0] = normal.x;
+	out->extraColors[0][1] = normal.y;
+	out->extraColors[0][2] = normal.z;
+	out->extraColors[0][3] = 1;
+}
+
+void forwardFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	float* varyings = (float*) in->varyings;
+	const vec3 normal = vec3Normalize((vec3) {.x = varyings[2], .y = varyings[3], .z = varyings[4]});
+
+	float color[4];
+	albedo(varyings, color);
+	shade(color, (float[]) {normal.x, normal.y, normal.z}, &((Uniform*) in->uniform)->lightDirection, out->color);
+}
+
+static void albedo(const float uv[2], float out[4])
+{
+	const bool odd = ((int) floorf(uv[0] * 16) + (int) floorf(uv[1] * 16)) & 1;
+	out[0] = (odd) ? 1.f : 0.2f;
+	out[1] = (odd) ? 0.6f : 0.4f;
+	out[2] = (odd) ? 0.2f : 1.f;
+	out[3] = 1;
+}
+
+static void shade(const float albedo[4], const float normal[3], const vec3* light, float out[4])
+{
+	const float diffuse = fmaxf(0, normal[0] * light->x + normal[1] * light->y + normal[2] * light->z);
+	for (int c = 0; c < 3; c++)
+		out[c] = fminf(1, albedo[c] * (0.15f + 0.85f * diffuse));
+	out[3] = 1;
+}
@@ -23,8 +23,6 @@ typedef struct Uniform
 	mat4 projection;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -86,8 +84,8 @@ int main(int argc, char** argv)
         }
     };
 
-    srpNewContext(&srpContext);
-    srpDepthTest(true);
+    SRPContext* ctx = srpNewContext();
+    srpDepthTest(ctx, true);
     SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 
     SRPVertexBuffer* vb = srpNewVertexBuffer();
@@ -96,13 +94,14 @@ int main(int argc, char** argv)
     srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
 
     srpFramebufferClear(fb);
-    srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_LINES, 0, 24);
-    srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 8, 6);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_LINES, 0, 24);
+    srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 8, 6);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
     srpFreeVertexBuffer(vb);
     srpFreeFramebuffer(fb);
+    srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
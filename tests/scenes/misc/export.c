@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include <stb_image.h>
+
+typedef struct Vertex
+{
+	float position[2];
+	float color[4];
+} Vertex;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Expected 8-bit RGBA of every pixel, as read back from the framebuffer */
+static uint8_t* expectedPixels(const SRPFramebuffer* fb);
+/** Whether decoded pixels match the expected ones */
+static bool pixelsMatch(const uint8_t* decoded, const uint8_t* expected, size_t nPixels, int channels);
+/** Decode a QOI image, written here so that it is independent of the encoder */
+static uint8_t* decodeQoi(const uint8_t* data, size_t size, int* width, int* height, int* channels);
+/** Check that an image decodes to the expected pixels and does not depend
+ *  on the amount of threads */
+static bool checkExport(
+	SRPContext* ctx, SRPContext* serial, const SRPFramebuffer* fb,
+	const SRPExportOptions* options, const uint8_t* expected, size_t* outSize
+);
+
+// Several bands of rows, the last one partial
+#define WIDTH 320
+#define HEIGHT 480
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	// Translucent overlapping triangles over a flat background: runs, small
+	// differences and arbitrary colors
+	Vertex data[] = {
+		{{-0.9, -0.9}, {1, 0, 0, 1}},
+		{{ 0.9, -0.6}, {0, 1, 0, 1}},
+		{{-0.2,  0.9}, {0, 0, 1, 1}},
+		{{-0.5,  0.8}, {1, 1, 0, 0.5}},
+		{{ 0.8,  0.9}, {0, 1, 1, 0.25}},
+		{{ 0.6, -0.9}, {1, 0, 1, 0.75}}
+	};
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 4,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(float) * 4
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPContext* serial = srpNewContext();
+	srpThreadCount(ctx, 4);
+	srpThreadCount(serial, 1);
+	SRPFramebuffer* fb = srpNewFramebuffer(WIDTH, HEIGHT);
+	SRPFramebuffer* fb565 = srpNewFramebufferFormat(WIDTH, HEIGHT, SRP_COLOR_FORMAT_RGB565);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+
+	srpFramebufferClear(fb);
+	srpFramebufferClear(fb565);
+	srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 6);
+	srpDrawVertexBuffer(ctx, vb, fb565, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 6);
+	srpFinish(ctx);
+
+	uint8_t* expected = expectedPixels(fb);
+	uint8_t* expected565 = expectedPixels(fb565);
+	bool ok = true;
+	size_t size;
+
+	// Raw is the color buffer itself
+	void* raw = srpFramebufferEncode(ctx, fb, &(SRPExportOptions) {.format = SRP_IMAGE_FORMAT_RAW}, &size);
+	ok &= size == WIDTH * HEIGHT * 4 && memcmp(raw, fb->color, size) == 0;
+	srpFreeEncodedImage(raw);
+
+	for (int alpha = 0; alpha <= 1; alpha++)
+	{
+		ok &= checkExport(ctx, serial, fb, &(SRPExportOptions) {
+			.format = SRP_IMAGE_FORMAT_PPM, .alpha = alpha
+		}, expected, &size);
+		ok &= checkExport(ctx, serial, fb, &(SRPExportOptions) {
+			.format = SRP_IMAGE_FORMAT_QOI, .alpha = alpha
+		}, expected, &size);
+		ok &= checkExport(ctx, serial, fb565, &(SRPExportOptions) {
+			.format = SRP_IMAGE_FORMAT_QOI, .alpha = alpha
+		}, expected565, &size);
+
+		size_t storedSize = 0;
+		for (int level = 0; level <= 9; level++)
+		{
+			ok &= checkExport(ctx, serial, fb, &(SRPExportOptions) {
+				.format = SRP_IMAGE_FORMAT_PNG, .alpha = alpha, .compressionLevel = level
+			}, expected, &size);
+			if (level == 0)
+				storedSize = size;
+			ok &= size < storedSize || level == 0;
+		}
+		ok &= checkExport(ctx, serial, fb565, &(SRPExportOptions) {
+			.format = SRP_IMAGE_FORMAT_PNG, .alpha = alpha, .compressionLevel = 6
+		}, expected565, &size);
+	}
+
+	// Invalid options are rejected
+	ok &= srpFramebufferEncode(ctx, fb, &(SRPExportOptions) {
+		.format = SRP_IMAGE_FORMAT_PNG, .compressionLevel = 10
+	}, &size) == NULL;
+	ok &= srpFramebufferEncode(ctx, fb, &(SRPExportOptions) {
+		.format = SRP_IMAGE_FORMAT_QOI, .attachment = 1
+	}, &size) == NULL;
+
+	if (!ok)
+		fprintf(stderr, "Exported images do not match the framebuffer\n");
+	ok &= srpFramebufferExport(ctx, fb, &(SRPExportOptions) {
+		.format = SRP_IMAGE_FORMAT_PNG, .compressionLevel = 6
+	}, outputPath);
+
+	free(expected);
+	free(expected565);
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fb565);
+	srpFreeContext(ctx);
+	srpFreeContext(serial);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	float* varyings = (float*) out->varyings;
+
+	out->clipPosition[0] = pVertex->position[0];
+	out->clipPosition[1] = pVertex->position[1];
+	out->clipPosition[2] = 0;
+	out->clipPosition[3] = 1;
+	for (int i = 0; i < 4; i++)
+		varyings[i] = pVertex->color[i];
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	float* varyings = (float*) in->varyings;
+	for (int i = 0; i < 4; i++)
+		out->color[i] = varyings[i];
+}
+
+static uint8_t* expectedPixels(const SRPFramebuffer* fb)
+{
+	uint8_t* pixels = malloc(fb->size * 4);
+	for (size_t y = 0; y < fb->height; y++)
+	{
+		for (size_t x = 0; x < fb->width; x++)
+		{
+			uint8_t* p = pixels + (y * fb->width + x) * 4;
+			if (fb->colorFormat == SRP_COLOR_FORMAT_RGBA8)
+			{
+				const uint32_t c = ((uint32_t*) fb->color)[y * fb->width + x];
+				p[0] = c >> 24; p[1] = c >> 16; p[2] = c >> 8; p[3] = c;
+				continue;
+			}
+			float color[4];
+			srpFramebufferReadPixel(fb, x, y, color);
+			for (int i = 0; i < 4; i++)
+				p[i] = roundf(fminf(fmaxf(color[i], 0), 1) * 255);
+		}
+	}
+	return pixels;
+}
+
+static bool pixelsMatch(const uint8_t* decoded, const uint8_t* expected, size_t nPixels, int channels)
+{
+	for (size_t i = 0; i < nPixels; i++)
+	{
+		for (int c = 0; c < channels; c++)
+			if (decoded[i * channels + c] != expected[i * 4 + c])
+				return false;
+	}
+	return true;
+}
+
+static bool checkExport(
+	SRPContext* ctx, SRPContext* serial, const SRPFramebuffer* fb,
+	const SRPExportOptions* options, const uint8_t* expected, size_t* outSize
+)
+{
+	size_t size, serialSize;
+	uint8_t* data = srpFramebufferEncode(ctx, fb, options, &size);
+	uint8_t* serialData = srpFramebufferEncode(serial, fb, options, &serialSize);
+	bool ok = data != NULL && size == serialSize && memcmp(data, serialData, size) == 0;
+
+	const int channels = (options->format != SRP_IMAGE_FORMAT_PPM && options->alpha) ? 4 : 3;
+	int width = 0, height = 0, decodedChannels = 0;
+	uint8_t* decoded = NULL;
+	if (options->format == SRP_IMAGE_FORMAT_QOI)
+		decoded = decodeQoi(data, size, &width, &height, &decodedChannels);
+	else
+		decoded = stbi_load_from_memory(data, size, &width, &height, &decodedChannels, channels);
+
+	// stb_image reports the channels of the file, not of the output
+	ok &= decoded != NULL && width == WIDTH && height == HEIGHT && decodedChannels == channels;
+	ok &= decoded != NULL && pixelsMatch(decoded, expected, fb->size, channels);
+	if (!ok)
+		fprintf(stderr, "Format %i, alpha %i, level %i failed\n", options->format, options->alpha, options->compressionLevel);
+
+	free(decoded);
+	srpFreeEncodedImage(data);
+	srpFreeEncodedImage(serialData);
+	*outSize = size;
+	return ok;
+}
+
+static uint8_t* decodeQoi(const uint8_t* data, size_t size, int* width, int* height, int* channels)
+{
+	if (size < 22 || memcmp(data, "qoif", 4) != 0)
+		return NULL;
+	*width = data[4] << 24 | data[5] << 16 | data[6] << 8 | data[7];
+	*height = data[8] << 24 | data[9] << 16 | data[10] << 8 | data[11];
+	*channels = data[12];
+
+	const size_t nPixels = (size_t) *width * *height;
+	uint8_t* pixels = malloc(nPixels * *channels);
+	uint8_t index[64][4] = {0}, px[4] = {0, 0, 0, 255};
+	size_t p = 14, run = 0;
+	for (size_t i = 0; i < nPixels; i++)
+	{
+		if (run > 0)
+			run--;
+		else if (p < size - 8)
+		{
+			const uint8_t b = data[p++];
+			if (b == 0xFE)
+			{
+				px[0] = data[p++]; px[1] = data[p++]; px[2] = data[p++];
+			}
+			else if (b == 0xFF)
+			{
+				px[0] = data[p++]; px[1] = data[p++]; px[2] = data[p++]; px[3] = data[p++];
+			}
+			else if ((b & 0xC0) == 0x00)
+				memcpy(px, index[b], 4);
+			else if ((b & 0xC0) == 0x40)
+			{
+				px[0] += ((b >> 4) & 3) - 2;
+				px[1] += ((b >> 2) & 3) - 2;
+				px[2] += (b & 3) - 2;
+			}
+			else if ((b & 0xC0) == 0x80)
+			{
+				const uint8_t b2 = data[p++];
+				const int dg = (b & 0x3F) - 32;
+				px[0] += dg - 8 + ((b2 >> 4) & 0xF);
+				px[1] += dg;
+				px[2] += dg - 8 + (b2 & 0xF);
+			}
+			else
+				run = b & 0x3F;
+			memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+		}
+		memcpy(pixels + i * *channels, px, *channels);
+	}
+
+	// Everything is consumed and the end marker follows
+	const uint8_t end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+	if (p != size - 8 || run != 0 || memcmp(data + p, end, 8) != 0)
+	{
+		free(pixels);
+		return NULL;
+	}
+	return pixels;
+}
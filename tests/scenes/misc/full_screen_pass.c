@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	float position[2];
+	float color[3];
+} Vertex;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Invert the color and count the visits in the stencil. A SRPPixelKernel */
+static void invertKernel(const SRPFramebufferPixel* pixel, void* userData);
+/** Box blur of the framebuffer passed as `userData`. A SRPTileKernel */
+static void blurKernel(const SRPFramebufferTile* tile, void* userData);
+/** Box blur of one pixel of a RGBA8 framebuffer */
+static uint32_t blurPixel(const SRPFramebuffer* src, size_t x, size_t y);
+
+// Not a multiple of the tile size, so that border tiles are partial
+#define WIDTH 300
+#define HEIGHT 200
+#define BLUR_RADIUS 3
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	Vertex data[] = {
+		{{-0.9, -0.9}, {1, 0, 0}},
+		{{ 0.9, -0.6}, {0, 1, 0}},
+		{{-0.2,  0.9}, {0, 0, 1}}
+	};
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(float) * 3
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpThreadCount(ctx, 4);
+	SRPFramebuffer* scene = srpNewFramebuffer(WIDTH, HEIGHT);
+	SRPFramebuffer* blurred = srpNewFramebuffer(WIDTH, HEIGHT);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+
+	srpFramebufferClear(scene);
+	memset(scene->stencil, 0, scene->size);
+	srpDrawVertexBuffer(ctx, vb, scene, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+	srpFinish(ctx);
+
+	uint32_t* original = malloc(sizeof(uint32_t) * scene->size);
+	memcpy(original, scene->color, sizeof(uint32_t) * scene->size);
+
+	// Per-pixel pass, in place: every pixel is visited exactly once
+	srpFramebufferDispatchPixels(ctx, scene, invertKernel, NULL);
+	bool ok = true;
+	for (size_t i = 0; i < scene->size; i++)
+	{
+		ok &= ((uint32_t*) scene->color)[i] == (original[i] ^ 0xFFFFFF00);
+		ok &= scene->stencil[i] == 1;
+	}
+
+	// Per-tile pass reading a different framebuffer
+	srpFramebufferDispatchTiles(ctx, blurred, blurKernel, scene);
+	for (size_t y = 0; y < HEIGHT; y++)
+		for (size_t x = 0; x < WIDTH; x++)
+			ok &= ((uint32_t*) blurred->color)[y * WIDTH + x] == blurPixel(scene, x, y);
+
+	if (!ok)
+		fprintf(stderr, "Full-screen passes do not match the reference\n");
+	ok &= saveFramebufferToImage(blurred, outputPath);
+
+	free(original);
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(blurred);
+	srpFreeFramebuffer(scene);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	float* varyings = (float*) out->varyings;
+
+	out->clipPosition[0] = pVertex->position[0];
+	out->clipPosition[1] = pVertex->position[1];
+	out->clipPosition[2] = 0;
+	out->clipPosition[3] = 1;
+	for (int i = 0; i < 3; i++)
+		varyings[i] = pVertex->color[i];
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	float* varyings = (float*) in->varyings;
+	for (int i = 0; i < 3; i++)
+		out->color[i] = varyings[i];
+	out->color[3] = 1;
+}
+
+static void invertKernel(const SRPFramebufferPixel* pixel, void* userData)
+{
+	*(uint32_t*) pixel->color[0] ^= 0xFFFFFF00;
+	(*pixel->stencil)++;
+}
+
+static void blurKernel(const SRPFramebufferTile* tile, void* userData)
+{
+	const SRPFramebuffer* src = (const SRPFramebuffer*) userData;
+	uint32_t* dst = tile->color[0];
+	for (size_t y = tile->y0; y < tile->y1; y++)
+		for (size_t x = tile->x0; x < tile->x1; x++)
+			dst[(y - tile->y0) * tile->stride + (x - tile->x0)] = blurPixel(src, x, y);
+}
+
+static uint32_t blurPixel(const SRPFramebuffer* src, size_t x, size_t y)
+{
+	const uint32_t* color = src->color;
+	uint32_t sums[4] = {0}, count = 0;
+	for (int dy = -BLUR_RADIUS; dy <= BLUR_RADIUS; dy++)
+	{
+		for (int dx = -BLUR_RADIUS; dx <= BLUR_RADIUS; dx++)
+		{
+			const int sx = (int) x + dx, sy = (int) y + dy;
+			if (sx < 0 || sy < 0 || sx >= (int) src->width || sy >= (int) src->height)
+				continue;
+			const uint32_t c = color[sy * src->width + sx];
+			for (int i = 0; i < 4; i++)
+				sums[i] += (c >> (24 - 8 * i)) & 0xFF;
+			count++;
+		}
+	}
+
+	uint32_t result = 0;
+	for (int i = 0; i < 4; i++)
+		result |= ((sums[i] + count / 2) / count) << (24 - 8 * i);
+	return result;
+}
@@ -0,0 +1,117 @@
+#define SRP_INCLUDE_VEC
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <srp/srp.h>
+#include "save.h"
+
+// A closed polygon with vertices in pixel centers, drawn as a line loop.
+// Under the diamond-exit rule every line produces its start pixel but not
+// its end pixel, so the stencil buffer counts exactly one hit per pixel
+#define SIZE 128
+#define N_VERTICES 12
+
+#ifndef M_PI
+	#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct Vertex
+{
+	vec2 position;
+	vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec3 color;
+} VSOutput;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	Vertex data[N_VERTICES];
+	int pixels[N_VERTICES][2];
+	for (size_t i = 0; i < N_VERTICES; i++)
+	{
+		const float angle = 2 * M_PI * i / N_VERTICES + 0.3;
+		pixels[i][0] = SIZE / 2 + (int) roundf(50 * cosf(angle));
+		pixels[i][1] = SIZE / 2 + (int) roundf(50 * sinf(angle));
+		data[i] = (Vertex) {
+			.position = VEC2(
+				(pixels[i][0] + 0.5) / SIZE * 2 - 1,
+				1 - (pixels[i][1] + 0.5) / SIZE * 2
+			),
+			.color = VEC3((float) i / N_VERTICES, 1, 1 - (float) i / N_VERTICES)
+		};
+	}
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpStencilTest(ctx, true);
+	srpStencilFunc(ctx, SRP_COMPARE_ALWAYS, 0, 0xFF);
+	srpStencilOp(ctx, SRP_STENCIL_KEEP, SRP_STENCIL_KEEP, SRP_STENCIL_INCR);
+	srpStencilWriteMask(ctx, 0xFF);
+
+	SRPFramebuffer* fb = srpNewFramebuffer(SIZE, SIZE);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+
+	srpFramebufferClear(fb);
+	memset(fb->stencil, 0, fb->size);
+	srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_LINE_LOOP, 0, N_VERTICES);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+	for (size_t i = 0; i < fb->size; i++)
+		if (fb->stencil[i] > 1)
+			ok = 0;
+	for (size_t i = 0; i < N_VERTICES; i++)
+		if (fb->stencil[pixels[i][1] * SIZE + pixels[i][0]] != 1)
+			ok = 0;
+
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4(pVertex->position.x, pVertex->position.y, 0, 1);
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+
+	vec4* color = (vec4*) out->color;
+	*color = VEC4(interpolated->color.x, interpolated->color.y, interpolated->color.z, 1);
+}
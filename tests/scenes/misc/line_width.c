@@ -0,0 +1,126 @@
+#define SRP_INCLUDE_VEC
+
+#include <assert.h>
+#include <math.h>
+#include <srp/srp.h>
+#include "save.h"
+
+// Two bursts of spokes going in all directions: wide aliased lines on the
+// left, wide antialiased ones on the right, and thin antialiased ones in
+// the bottom
+#define N_SPOKES 16
+
+#ifndef M_PI
+	#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct Vertex
+{
+	vec2 position;
+	vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec3 color;
+} VSOutput;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Fill `data` with the spokes of a burst centered at (cx, cy) */
+static void makeBurst(Vertex* data, float cx, float cy, float radius)
+{
+	for (size_t i = 0; i < N_SPOKES; i++)
+	{
+		const float angle = 2 * M_PI * i / N_SPOKES + 0.1;
+		const vec3 color = VEC3(
+			0.5 + 0.5 * cosf(angle), 0.5 + 0.5 * sinf(angle), 1 - (float) i / N_SPOKES
+		);
+		data[2 * i] = (Vertex) {
+			.position = VEC2(cx + 0.2 * radius * cosf(angle), cy + 0.2 * radius * sinf(angle)),
+			.color = VEC3(1, 1, 1)
+		};
+		data[2 * i + 1] = (Vertex) {
+			.position = VEC2(cx + radius * cosf(angle), cy + radius * sinf(angle)),
+			.color = color
+		};
+	}
+}
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	static Vertex data[3][2 * N_SPOKES];
+	makeBurst(data[0], -0.5, 0.3, 0.45);
+	makeBurst(data[1], 0.5, 0.3, 0.45);
+	makeBurst(data[2], 0, -0.55, 0.4);
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_AFFINE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb[3];
+	for (size_t i = 0; i < 3; i++)
+	{
+		vb[i] = srpNewVertexBuffer();
+		srpVertexBufferCopyData(vb[i], sizeof(Vertex), sizeof(data[i]), data[i]);
+	}
+
+	srpFramebufferClear(fb);
+
+	srpRasterLineWidth(ctx, 4);
+	srpDrawVertexBuffer(ctx, vb[0], fb, &shaderProgram, SRP_PRIM_LINES, 0, 2 * N_SPOKES);
+
+	srpRasterLineSmooth(ctx, true);
+	srpRasterLineWidth(ctx, 3.5);
+	srpDrawVertexBuffer(ctx, vb[1], fb, &shaderProgram, SRP_PRIM_LINES, 0, 2 * N_SPOKES);
+
+	srpRasterLineWidth(ctx, 1);
+	srpDrawVertexBuffer(ctx, vb[2], fb, &shaderProgram, SRP_PRIM_LINES, 0, 2 * N_SPOKES);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+
+	for (size_t i = 0; i < 3; i++)
+		srpFreeVertexBuffer(vb[i]);
+	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4(pVertex->position.x, pVertex->position.y, 0, 1);
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+
+	vec4* color = (vec4*) out->color;
+	*color = VEC4(interpolated->color.x, interpolated->color.y, interpolated->color.z, 1);
+}
@@ -0,0 +1,173 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+#include "objparser.h"
+#include "meshfile.h"
+#include "rad.h"
+
+typedef struct Uniform
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} Uniform;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Whether the header, the clusters and the indices describe the mesh */
+static bool meshFileConsistent(const MeshFile* file, const OBJMesh* mesh);
+/** Whether `position` is inside of `bounds` */
+static bool boundsContain(const MeshBounds* bounds, vec3 position);
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	OBJMesh mesh;
+	if (!loadOBJMesh("res/objects/utah_teapot.obj", &mesh))
+	{
+		fprintf(stderr, "Failed to load mesh!\n");
+		return -1;
+	}
+
+	// Written next to the output, as the working directory may be read-only
+	char meshPath[1024];
+	snprintf(meshPath, sizeof(meshPath), "%s.srpm", outputPath);
+	MeshFile file;
+	if (!writeMeshFile(meshPath, &mesh) || !openMeshFile(meshPath, &file))
+	{
+		fprintf(stderr, "Failed to write or open the mesh file!\n");
+		freeOBJMesh(&mesh);
+		return -1;
+	}
+	bool ok = meshFileConsistent(&file, &mesh);
+
+	Uniform uniform = {
+		.model = mat4ConstructRotate(0, RAD(30), 0),
+		.view = mat4ConstructView(
+			0, 1.75, -7,
+			0, 0, 0,
+			1, 1, 1
+		),
+		.projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 1, 50)
+	};
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = (SRPUniform*) &uniform,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 0,
+			.varyingsInfo = NULL,
+			.varyingsSize = 0
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpRasterFrontFace(ctx, SRP_WINDING_CW);
+	srpRasterCullFace(ctx, SRP_FACE_BACK);
+	srpDepthTest(ctx, true);
+
+	// The mapped file, used in place
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	meshFileWrapBuffers(&file, vb, ib);
+	srpFramebufferClear(fb);
+	srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, file.header->indexCount);
+
+	// Must be the same as the copied OBJ mesh
+	SRPFramebuffer* reference = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* objVB = srpNewVertexBuffer();
+	SRPIndexBuffer* objIB = srpNewIndexBuffer();
+	srpVertexBufferCopyData(objVB, sizeof(OBJVertex), mesh.vertexCount * sizeof(OBJVertex), mesh.vertices);
+	srpIndexBufferCopyData(objIB, SRP_UINT32, mesh.indexCount * sizeof(uint32_t), mesh.indices);
+	srpFramebufferClear(reference);
+	srpDrawIndexBuffer(ctx, objIB, objVB, reference, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
+
+	ok &= memcmp(fb->color, reference->color, sizeof(uint32_t) * 512 * 512) == 0;
+	if (!ok)
+		fprintf(stderr, "The mesh file does not match the OBJ mesh\n");
+	ok &= saveFramebufferToImage(fb, outputPath);
+
+	// The buffers do not own the mapping, so they must go before it
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	closeMeshFile(&file);
+	remove(meshPath);
+
+	srpFreeVertexBuffer(objVB);
+	srpFreeIndexBuffer(objIB);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(reference);
+	srpFreeContext(ctx);
+	freeOBJMesh(&mesh);
+
+	return ok ? 0 : 1;
+}
+
+static bool meshFileConsistent(const MeshFile* file, const OBJMesh* mesh)
+{
+	const MeshFileHeader* header = file->header;
+	// Identical corners are merged into one vertex
+	bool ok = header->indexCount == mesh->indexCount && header->indexSize == 2 && \
+		header->vertexCount > 0 && header->vertexCount < mesh->vertexCount;
+
+	const uint16_t* indices = file->indices;
+	uint64_t next = 0;
+	for (uint64_t c = 0; ok && c < header->clusterCount; c++)
+	{
+		const MeshCluster* cluster = &file->clusters[c];
+		ok &= cluster->firstIndex == next;
+		next += cluster->indexCount;
+		for (uint64_t i = cluster->firstIndex; ok && i < next; i++)
+		{
+			ok &= indices[i] < header->vertexCount;
+			const OBJVertex* v = &file->vertices[indices[i]];
+			ok &= memcmp(v, &mesh->vertices[mesh->indices[i]], sizeof(OBJVertex)) == 0;
+			ok &= boundsContain(&cluster->bounds, v->position);
+			ok &= boundsContain(&header->bounds, v->position);
+		}
+	}
+	return ok && next == header->indexCount;
+}
+
+static bool boundsContain(const MeshBounds* bounds, vec3 position)
+{
+	for (int i = 0; i < 3; i++)
+		if (position.v[i] < bounds->min.v[i] || position.v[i] > bounds->max.v[i])
+			return false;
+	return true;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	OBJVertex* pVertex = (OBJVertex*) in->vertex;
+	Uniform* pUniform = (Uniform*) in->uniform;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4_FROM_VEC3(pVertex->position, 1.);
+	*outPosition = mat4MultiplyVec4(&pUniform->model, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->view, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->projection, *outPosition);
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	// Colored by primitive, so that any reordered triangle would show
+	int id = in->primitiveID;
+	out->color[0] = ((id * 97) % 255) / 255.;
+	out->color[1] = ((id * 57) % 255) / 255.;
+	out->color[2] = ((id * 23) % 255) / 255.;
+	out->color[3] = 1.;
+}
@@ -0,0 +1,176 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <assert.h>
+#include <string.h>
+#include <threads.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+    vec3 position;
+    vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+    vec3 color;
+} VSOutput;
+
+typedef struct Uniform
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} Uniform;
+
+/** Everything a render job needs. Buffers and shader program are only read,
+ *  so they are shared between the jobs */
+typedef struct Job
+{
+    const SRPVertexBuffer* vb;
+    const SRPIndexBuffer* ib;
+    const SRPShaderProgram* sp;
+    SRPFramebuffer* fb;
+} Job;
+
+#define N_JOBS 4
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+int renderJob(void* arg);
+
+int main(int argc, char** argv)
+{
+    assert(argc >= 2);
+    const char* outputPath = argv[1];
+
+    Vertex data[] = {
+        // Cube
+        // Bottom face (y = -1)
+        { .position = VEC3(-1, -1, -1), .color = VEC3(1, 1, 1) }, // 0: Front-Left-Bottom
+        { .position = VEC3( 1, -1, -1), .color = VEC3(1, 1, 1) }, // 1: Front-Right-Bottom
+        { .position = VEC3( 1, -1,  1), .color = VEC3(1, 1, 1) }, // 2: Back-Right-Bottom
+        { .position = VEC3(-1, -1,  1), .color = VEC3(1, 1, 1) }, // 3: Back-Left-Bottom
+
+        // Top face (y = 1)
+        { .position = VEC3(-1,  1, -1), .color = VEC3(1, 1, 1) }, // 4: Front-Left-Top
+        { .position = VEC3( 1,  1, -1), .color = VEC3(1, 1, 1) }, // 5: Front-Right-Top
+        { .position = VEC3( 1,  1,  1), .color = VEC3(1, 1, 1) }, // 6: Back-Right-Top
+        { .position = VEC3(-1,  1,  1), .color = VEC3(1, 1, 1) }, // 7: Back-Left-Top
+
+        // Two triangle sections of a cube (not minding the winding order here)
+        { .position = VEC3(-1, -1, -1), .color = VEC3(1, 0, 0) },
+        { .position = VEC3(-1,  1,  1), .color = VEC3(0, 1, 0) },
+        { .position = VEC3( 1,  1, -1), .color = VEC3(0, 0, 1) },
+
+        { .position = VEC3(-1,  1, -1), .color = VEC3(1, 1, 0) },
+        { .position = VEC3(-1, -1,  1), .color = VEC3(0, 1, 1) },
+        { .position = VEC3( 1, -1, -1), .color = VEC3(1, 0, 1) }
+    };
+    uint8_t indices[] = {
+        0, 1,  1, 2,  2, 3,  3, 0,  // Bottom square
+        4, 5,  5, 6,  6, 7,  7, 4,  // Top square
+        0, 4,  1, 5,  2, 6,  3, 7   // Vertical pillars connecting them
+    };
+
+    Uniform uniform = {
+        .model = mat4ConstructTRS(0, 0,  0,   0, 0.3, 0,   0.5, 0.5, 0.5),
+		.view = mat4ConstructView(0, 0, -2,   0, 0,   0,   1,   1,   1),
+		.projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 1, 10)
+    };
+
+    SRPShaderProgram shaderProgram = {
+        .uniform = (SRPUniform*) &uniform,
+        .vs = &(SRPVertexShader) {
+            .shader = vertexShader,
+            .nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+            .varyingsSize = sizeof(VSOutput)
+        },
+        .fs = &(SRPFragmentShader) {
+            .shader = fragmentShader,
+            .mayOverwriteDepth = false
+        }
+    };
+
+    SRPVertexBuffer* vb = srpNewVertexBuffer();
+    srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+    SRPIndexBuffer* ib = srpNewIndexBuffer();
+    srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
+
+    // Same scene as misc/depth_test, rendered concurrently by independent contexts
+    Job jobs[N_JOBS];
+    thrd_t threads[N_JOBS];
+    for (size_t i = 0; i < N_JOBS; i++)
+    {
+        jobs[i] = (Job) {
+            .vb = vb, .ib = ib, .sp = &shaderProgram,
+            .fb = srpNewFramebuffer(512, 512)
+        };
+        if (thrd_create(&threads[i], renderJob, &jobs[i]) != thrd_success)
+            return 1;
+    }
+    for (size_t i = 0; i < N_JOBS; i++)
+        thrd_join(threads[i], NULL);
+
+    const size_t colorSize = jobs[0].fb->size * sizeof(uint32_t);
+    int ok = saveFramebufferToImage(jobs[0].fb, outputPath);
+    for (size_t i = 1; i < N_JOBS; i++)
+        if (memcmp(jobs[0].fb->color, jobs[i].fb->color, colorSize) != 0)
+            ok = 0;
+
+    for (size_t i = 0; i < N_JOBS; i++)
+        srpFreeFramebuffer(jobs[i].fb);
+    srpFreeVertexBuffer(vb);
+    srpFreeIndexBuffer(ib);
+
+    return ok ? 0 : 1;
+}
+
+int renderJob(void* arg)
+{
+    Job* job = (Job*) arg;
+
+    SRPContext* ctx = srpNewContext();
+    srpDepthTest(ctx, true);
+
+    srpFramebufferClear(job->fb);
+    srpDrawIndexBuffer(ctx, job->ib, job->vb, job->fb, job->sp, SRP_PRIM_LINES, 0, 24);
+    srpDrawVertexBuffer(ctx, job->vb, job->fb, job->sp, SRP_PRIM_TRIANGLES, 8, 6);
+
+    srpFreeContext(ctx);
+    return 0;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec3* inPosition = &pVertex->position;
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4_FROM_VEC3(*inPosition, 1.);
+	*outPosition = mat4MultiplyVec4(&pUniform->model, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->view, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->projection, *outPosition);
+
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+    VSOutput* i = (VSOutput*) in->varyings;
+
+    vec4* color = (vec4*) out->color;
+    color->x = i->color.x;
+    color->y = i->color.y;
+    color->z = i->color.z;
+    color->w = 1.;
+}
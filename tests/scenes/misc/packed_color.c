@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	float position[2];
+} Vertex;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void packedFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+void floatFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Color of a primitive, as bytes */
+static void primitiveColor(size_t id, uint8_t color[4]);
+
+#define GRID 8
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	// A grid of quads, every triangle of its own color
+	Vertex vertices[GRID * GRID * 6];
+	size_t n = 0;
+	for (size_t y = 0; y < GRID; y++)
+		for (size_t x = 0; x < GRID; x++)
+		{
+			const float x0 = -0.9 + 1.8 * x / GRID, x1 = -0.9 + 1.8 * (x + 0.9) / GRID;
+			const float y0 = -0.9 + 1.8 * y / GRID, y1 = -0.9 + 1.8 * (y + 0.9) / GRID;
+			const Vertex quad[6] = {
+				{{x0, y0}}, {{x1, y0}}, {{x1, y1}},
+				{{x0, y0}}, {{x1, y1}}, {{x0, y1}}
+			};
+			memcpy(&vertices[n], quad, sizeof(quad));
+			n += 6;
+		}
+
+	SRPVertexShader vs = {
+		.shader = vertexShader,
+		.nVaryings = 0,
+		.varyingsInfo = NULL,
+		.varyingsSize = 0
+	};
+	SRPFragmentShader packedFs = {
+		.shader = packedFragmentShader,
+		.mayOverwriteDepth = false,
+		.writesPackedColor = true
+	};
+	SRPFragmentShader floatFs = {
+		.shader = floatFragmentShader,
+		.mayOverwriteDepth = false,
+		.writesPackedColor = false
+	};
+	SRPShaderProgram packedProgram = {.uniform = NULL, .vs = &vs, .fs = &packedFs};
+	SRPShaderProgram floatProgram = {.uniform = NULL, .vs = &vs, .fs = &floatFs};
+
+	SRPContext* ctx = srpNewContext();
+	SRPFramebuffer* fb = srpNewFramebuffer(256, 256);
+	SRPFramebuffer* fbFloat = srpNewFramebuffer(256, 256);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(vertices), vertices);
+
+	srpFramebufferClear(fb);
+	srpDrawVertexBuffer(ctx, vb, fb, &packedProgram, SRP_PRIM_TRIANGLES, 0, n);
+	srpFramebufferClear(fbFloat);
+	srpDrawVertexBuffer(ctx, vb, fbFloat, &floatProgram, SRP_PRIM_TRIANGLES, 0, n);
+
+	// Both outputs have to end up as the same bytes
+	bool same = memcmp(fb->color, fbFloat->color, sizeof(uint32_t) * fb->size) == 0;
+	if (!same)
+		fprintf(stderr, "Packed and float fragment outputs differ\n");
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fbFloat);
+	srpFreeContext(ctx);
+
+	return (ok && same) ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	out->clipPosition[0] = pVertex->position[0];
+	out->clipPosition[1] = pVertex->position[1];
+	out->clipPosition[2] = 0;
+	out->clipPosition[3] = 1;
+}
+
+void packedFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	uint8_t c[4];
+	primitiveColor(in->primitiveID, c);
+	out->packedColor = ((uint32_t) c[0] << 24) | ((uint32_t) c[1] << 16) | ((uint32_t) c[2] << 8) | c[3];
+}
+
+void floatFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	uint8_t c[4];
+	primitiveColor(in->primitiveID, c);
+	// Mid-step values, so that the truncation lands on the same bytes
+	for (int i = 0; i < 4; i++)
+		out->color[i] = (c[i] + 0.5) / 255.;
+}
+
+static void primitiveColor(size_t id, uint8_t color[4])
+{
+	color[0] = (id * 97) % 255;
+	color[1] = (id * 57) % 255;
+	color[2] = (id * 23) % 255;
+	color[3] = 255;
+}
@@ -0,0 +1,115 @@
+#define SRP_INCLUDE_VEC
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <srp/srp.h>
+#include "save.h"
+
+// A triangle strip spiraling three times around the center, each turn
+// overlapping the previous one. Drawn without the depth test, so the result
+// depends on the submission order
+#define N_SEGMENTS 4096
+#define N_VERTICES ((N_SEGMENTS + 1) * 2)
+
+#ifndef M_PI
+	#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct Vertex
+{
+	vec2 position;
+	vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec3 color;
+} VSOutput;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	static Vertex data[N_VERTICES];
+	for (size_t s = 0; s <= N_SEGMENTS; s++)
+	{
+		const float t = (float) s / N_SEGMENTS;
+		const float angle = t * 6 * M_PI;
+		for (size_t side = 0; side < 2; side++)
+		{
+			const float radius = 0.15 + 0.25 * t + 0.25 * side;
+			data[s * 2 + side] = (Vertex) {
+				.position = VEC2(radius * cos(angle), radius * sin(angle)),
+				.color = VEC3(t, side, 1 - t)
+			};
+		}
+	}
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_AFFINE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPFramebuffer* fbSingle = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+
+	// Reference: the same draw on a single thread
+	srpFramebufferClear(fbSingle);
+	srpDrawVertexBuffer(ctx, vb, fbSingle, &shaderProgram, SRP_PRIM_TRIANGLE_STRIP, 0, N_VERTICES);
+
+	srpThreadCount(ctx, 4);
+	srpFramebufferClear(fb);
+	srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLE_STRIP, 0, N_VERTICES);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+	if (memcmp(fb->color, fbSingle->color, fb->size * sizeof(uint32_t)) != 0)
+		ok = 0;
+
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fbSingle);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4(pVertex->position.x, pVertex->position.y, 0, 1);
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+
+	vec4* color = (vec4*) out->color;
+	// Primitive IDs must not depend on how the draw was split between threads
+	const float id = (float) (in->primitiveID % 64) / 63;
+	*color = VEC4(interpolated->color.x, interpolated->color.y, id, 1);
+}
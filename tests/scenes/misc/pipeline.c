@@ -0,0 +1,213 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <assert.h>
+#include <stdio.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	vec3 position;
+	vec2 uv;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec2 uv;
+} VSOutput;
+
+typedef struct Uniform
+{
+	size_t frameCount;
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+	SRPTexture* texture;
+} Uniform;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+void singleColor(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+int main(int argc, char** argv)
+{
+    assert(argc >= 2);
+    const char* outputPath = argv[1];
+
+	Vertex data[] = {
+		{.position = VEC3(-1, -1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1, -1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1,  1, -1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1,  1, -1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3(-1,  1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1,  1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1,  1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1,  1,  1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3( 1, -1,  1), .uv = VEC2(0, 0)},
+		{.position = VEC3(-1, -1,  1), .uv = VEC2(1, 0)},
+		{.position = VEC3(-1,  1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3( 1,  1,  1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3( 1, -1,  1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1, -1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1,  1, -1), .uv = VEC2(1, 1)},
+		{.position = VEC3( 1,  1,  1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3(-1, -1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3(-1, -1,  1), .uv = VEC2(1, 0)},
+		{.position = VEC3(-1,  1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1,  1, -1), .uv = VEC2(0, 1)},
+		
+		{.position = VEC3(-1, -1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1, -1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1, -1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1, -1,  1), .uv = VEC2(0, 1)}
+	};
+
+	uint8_t indices[] = {
+		 0,  1,  2,   0,  2,  3,
+		 4,  5,  6,   4,  6,  7,
+		 8,  9, 10,   8, 10, 11,
+		12, 15, 14,  12, 14, 13,
+		16, 18, 17,  16, 19, 18,
+		20, 23, 22,  20, 22, 21
+	};
+
+	Uniform uniform = {
+		.model = mat4ConstructRotate(0.7, 0.7, 0.7),
+		.view = mat4ConstructView(0, 0, -3,   0, 0, 0,   1, 1, 1),
+		.projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 1, 50),
+		.texture = srpNewTexture("./res/textures/stoneWall.png", TW_REPEAT, TW_REPEAT),
+		.frameCount = 0
+	};
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = (SRPUniform*) &uniform,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 2,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+
+	// Same scene as misc/stencil_test, but drawn with pipeline state objects
+	SRPStencilFaceState outlineStencil = {
+		.func = SRP_COMPARE_ALWAYS, .ref = 1, .mask = 0xFF, .writeMask = 0xFF,
+		.sfailOp = SRP_STENCIL_KEEP, .dfailOp = SRP_STENCIL_KEEP, .passOp = SRP_STENCIL_REPLACE
+	};
+	SRPPipelineState state = {
+		.shaderProgram = &shaderProgram,
+		.provokingVertexMode = SRP_PROVOKING_VERTEX_LAST,
+		.raster = {
+			.frontFace = SRP_WINDING_CCW,
+			.cullFace = SRP_FACE_BACK,
+			.polygonMode = SRP_POLYGON_MODE_FILL,
+			.pointSize = 1,
+			.lineWidth = 1,
+			.lineSmooth = false
+		},
+		.scissor = { .enabled = false },
+		.stencil = { .enabled = true, .front = outlineStencil, .back = outlineStencil },
+		.depth = { .testEnable = true, .writeEnable = true, .compareOp = SRP_COMPARE_GREATER }
+	};
+	SRPPipeline* objectPipeline = srpNewPipeline(&state);
+
+	SRPShaderProgram outlineProgram = shaderProgram;
+	outlineProgram.fs = &(SRPFragmentShader) {
+		.shader = singleColor,
+		.mayOverwriteDepth = false
+	};
+	state.shaderProgram = &outlineProgram;
+	state.stencil.front.func = state.stencil.back.func = SRP_COMPARE_NOTEQUAL;
+	state.stencil.front.writeMask = state.stencil.back.writeMask = 0x00;
+	state.depth.testEnable = false;
+	SRPPipeline* outlinePipeline = srpNewPipeline(&state);
+	if (objectPipeline == NULL || outlinePipeline == NULL)
+		return 1;
+
+	// Invalid state must be rejected
+	state.raster.pointSize = 0;
+	if (srpNewPipeline(&state) != NULL)
+		return 1;
+	state.raster.pointSize = 1;
+	state.raster.lineWidth = 0;
+	if (srpNewPipeline(&state) != NULL)
+		return 1;
+
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+	srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
+
+    srpFramebufferClear(fb);
+
+    srpBindPipeline(ctx, objectPipeline);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, NULL, SRP_PRIM_TRIANGLES, 0, 36);
+
+    mat4 scale = mat4ConstructScale(1.05, 1.05, 1.05);
+    uniform.model = mat4MultiplyMat4(&scale, &uniform.model);
+    srpBindPipeline(ctx, outlinePipeline);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, NULL, SRP_PRIM_TRIANGLES, 0, 36);
+    srpBindPipeline(ctx, NULL);
+
+    int ok = saveFramebufferToImage(fb, outputPath);
+
+	srpFreeTexture(uniform.texture);
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
+	srpFreePipeline(objectPipeline);
+	srpFreePipeline(outlinePipeline);
+
+    return ok ? 0 : 1;
+}
+
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec3* inPosition = &pVertex->position;
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4_FROM_VEC3(*inPosition, 1.);
+	*outPosition = mat4MultiplyVec4(&pUniform->model, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->view, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->projection, *outPosition);
+
+	pOutVars->uv.x = pVertex->uv.x;
+	pOutVars->uv.y = pVertex->uv.y;
+}
+
+void singleColor(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	vec4* outColor = (vec4*) out->color;
+    *outColor = VEC4(1, 0, 0, 1);
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	vec4* outColor = (vec4*) out->color;
+
+	vec2 uv = interpolated->uv;
+	srpTextureGetFilteredColor(pUniform->texture, uv.x, uv.y, (float*) outColor);
+}
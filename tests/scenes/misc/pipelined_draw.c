@@ -0,0 +1,129 @@
+#define SRP_INCLUDE_VEC
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <srp/srp.h>
+#include "save.h"
+
+// A band spiraling twice around the center, overlapping itself. Drawn
+// without the depth test, so the result depends on the submission order
+#define N_SEGMENTS 512
+#define N_RINGS 4
+#define N_VERTICES ((N_SEGMENTS + 1) * (N_RINGS + 1))
+#define N_INDICES (N_SEGMENTS * N_RINGS * 6)
+
+#ifndef M_PI
+	#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct Vertex
+{
+	vec2 position;
+	vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec3 color;
+} VSOutput;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	static Vertex data[N_VERTICES];
+	static uint32_t indices[N_INDICES];
+	for (size_t s = 0; s <= N_SEGMENTS; s++)
+	{
+		const float t = (float) s / N_SEGMENTS;
+		const float angle = t * 4 * M_PI;
+		for (size_t r = 0; r <= N_RINGS; r++)
+		{
+			const float radius = 0.25 + 0.5 * r / N_RINGS + 0.15 * t;
+			data[s * (N_RINGS + 1) + r] = (Vertex) {
+				.position = VEC2(radius * cos(angle), radius * sin(angle)),
+				.color = VEC3(t, (float) r / N_RINGS, 1 - t)
+			};
+		}
+	}
+	size_t nIndices = 0;
+	for (size_t s = 0; s < N_SEGMENTS; s++)
+	{
+		for (size_t r = 0; r < N_RINGS; r++)
+		{
+			const uint32_t a = s * (N_RINGS + 1) + r, b = a + N_RINGS + 1;
+			const uint32_t quad[] = {a, b, b + 1,  a, b + 1, a + 1};
+			memcpy(&indices[nIndices], quad, sizeof(quad));
+			nIndices += 6;
+		}
+	}
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_AFFINE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPFramebuffer* fbSingle = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+	srpIndexBufferCopyData(ib, SRP_UINT32, sizeof(indices), indices);
+
+	// Reference: the same draw on a single thread
+	srpFramebufferClear(fbSingle);
+	srpDrawIndexBuffer(ctx, ib, vb, fbSingle, &shaderProgram, SRP_PRIM_TRIANGLES, 0, N_INDICES);
+
+	srpThreadCount(ctx, 3);
+	srpFramebufferClear(fb);
+	srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, N_INDICES);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+	if (memcmp(fb->color, fbSingle->color, fb->size * sizeof(uint32_t)) != 0)
+		ok = 0;
+
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fbSingle);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4(pVertex->position.x, pVertex->position.y, 0, 1);
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+
+	vec4* color = (vec4*) out->color;
+	*color = VEC4(interpolated->color.x, interpolated->color.y, interpolated->color.z, 1);
+}
@@ -0,0 +1,116 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+#include "rad.h"
+
+#define N_POINTS 400000
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	// Two intersecting Fibonacci spheres; the second copy of the cloud is
+	// reversed to check that the order of the points does not matter
+	SRPCloudPoint* points = malloc(sizeof(SRPCloudPoint) * N_POINTS);
+	SRPCloudPoint* reversed = malloc(sizeof(SRPCloudPoint) * N_POINTS);
+	const size_t half = N_POINTS / 2;
+	for (size_t i = 0; i < N_POINTS; i++)
+	{
+		const size_t k = i % half;
+		const float y = 1 - 2 * (k + 0.5) / half;
+		const float r = sqrtf(1 - y * y);
+		const float phi = k * 2.39996323;
+		const float x = r * cosf(phi), z = r * sinf(phi);
+		const float offset = (i < half) ? -0.45 : 0.45;
+
+		const uint8_t red = (x * 0.5 + 0.5) * 255;
+		const uint8_t green = (y * 0.5 + 0.5) * 255;
+		const uint8_t blue = (i < half) ? 255 : 64;
+		points[i] = (SRPCloudPoint) {
+			.position = {x + offset, y, z},
+			.color = ((uint32_t) red << 24) | ((uint32_t) green << 16) | ((uint32_t) blue << 8) | 0xFF
+		};
+		reversed[N_POINTS - 1 - i] = points[i];
+	}
+
+	const mat4 model = mat4ConstructRotate(RAD(20), RAD(30), 0);
+	const mat4 view = mat4ConstructView(
+		0, 0, -4,
+		0, 0, 0,
+		1, 1, 1
+	);
+	const mat4 projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 2, 10);
+	const mat4 modelView = mat4MultiplyMat4(&view, &model);
+	const mat4 transform = mat4MultiplyMat4(&projection, &modelView);
+
+	SRPContext* ctx = srpNewContext();
+	srpDepthTest(ctx, true);
+
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPFramebuffer* fbThreaded = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPVertexBuffer* vbReversed = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(SRPCloudPoint), sizeof(SRPCloudPoint) * N_POINTS, points);
+	srpVertexBufferCopyData(vbReversed, sizeof(SRPCloudPoint), sizeof(SRPCloudPoint) * N_POINTS, reversed);
+
+	// Single-threaded, one call
+	srpFramebufferClear(fb);
+	srpDrawPointCloud(ctx, vb, fb, transform.data, 0, N_POINTS);
+
+	// Multithreaded, reversed, split into two calls tested against each other
+	srpThreadCount(ctx, 4);
+	srpFramebufferClear(fbThreaded);
+	srpDrawPointCloud(ctx, vbReversed, fbThreaded, transform.data, 0, half);
+	srpDrawPointCloud(ctx, vbReversed, fbThreaded, transform.data, half, N_POINTS - half);
+
+	bool same = memcmp(fb->color, fbThreaded->color, sizeof(uint32_t) * fb->size) == 0 &&
+	            memcmp(fb->depth, fbThreaded->depth, sizeof(float) * fb->size) == 0;
+	if (!same)
+		fprintf(stderr, "Point cloud differs between orders or thread counts\n");
+
+	// Points outside of the scissor box are dropped
+	SRPFramebuffer* fbScissor = srpNewFramebuffer(512, 512);
+	srpFramebufferClear(fbScissor);
+	const uint32_t clearColor = ((uint32_t*) fbScissor->color)[0];
+	const float clearDepth = fbScissor->depth[0];
+	srpScissorTest(ctx, true);
+	srpScissorOptions(ctx, 128, 192, 256, 128);
+	srpDrawPointCloud(ctx, vb, fbScissor, transform.data, 0, N_POINTS);
+	srpFinish(ctx);
+	for (size_t y = 0; y < fb->height; y++)
+	{
+		for (size_t x = 0; x < fb->width; x++)
+		{
+			const size_t i = y * fb->width + x;
+			const bool inside = x >= 128 && x < 384 && y >= 192 && y < 320;
+			const uint32_t color = ((uint32_t*) fbScissor->color)[i];
+			if (inside)
+				same &= color == ((uint32_t*) fb->color)[i] && fbScissor->depth[i] == fb->depth[i];
+			else
+				same &= color == clearColor && fbScissor->depth[i] == clearDepth;
+		}
+	}
+	if (!same)
+		fprintf(stderr, "Point cloud ignores the scissor box\n");
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+
+	srpFreeVertexBuffer(vb);
+	srpFreeVertexBuffer(vbReversed);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fbThreaded);
+	srpFreeFramebuffer(fbScissor);
+	srpFreeContext(ctx);
+	free(points);
+	free(reversed);
+
+	return (ok && same) ? 0 : 1;
+}
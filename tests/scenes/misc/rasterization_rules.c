@@ -21,8 +21,6 @@ typedef struct Uniform
 	mat4 rotation;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -64,19 +62,20 @@ int main(int argc, char** argv)
         }
     };
 
-    srpNewContext(&srpContext);
+    SRPContext* ctx = srpNewContext();
     SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 
     SRPVertexBuffer* vb = srpNewVertexBuffer();
     srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
 
     srpFramebufferClear(fb);
-    srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 6);
+    srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 6);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
     srpFreeVertexBuffer(vb);
     srpFreeFramebuffer(fb);
+    srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
@@ -16,8 +16,6 @@ typedef struct VSOutput
     vec3 color;
 } VSOutput;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -50,22 +48,23 @@ int main(int argc, char** argv)
         }
     };
 
-    srpNewContext(&srpContext);
+    SRPContext* ctx = srpNewContext();
     SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 
-    srpScissorTest(true);
-    srpScissorOptions(140, 220, 200, 150);
+    srpScissorTest(ctx, true);
+    srpScissorOptions(ctx, 140, 220, 200, 150);
 
     SRPVertexBuffer* vb = srpNewVertexBuffer();
     srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
 
     srpFramebufferClear(fb);
-    srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
+    srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 3);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
     srpFreeVertexBuffer(vb);
     srpFreeFramebuffer(fb);
+    srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
@@ -0,0 +1,118 @@
+#define SRP_INCLUDE_VEC
+
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+
+// A jittered grid of quads about a pixel in size, so that most of the
+// triangles cover one or no pixel centers at all. Colored by primitive ID,
+// which also must not change when the empty triangles are skipped
+#define GRID_SIZE 200
+#define N_VERTICES ((GRID_SIZE + 1) * (GRID_SIZE + 1))
+#define N_INDICES (GRID_SIZE * GRID_SIZE * 6)
+
+typedef struct Vertex
+{
+	vec2 position;
+} Vertex;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Deterministic pseudo-random number in [-0.5, 0.5) */
+static float jitter(uint32_t seed)
+{
+	seed ^= seed >> 16;
+	seed *= 0x7feb352d;
+	seed ^= seed >> 15;
+	seed *= 0x846ca68b;
+	seed ^= seed >> 16;
+	return (float) (seed & 0xFFFF) / 0x10000 - 0.5;
+}
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	static Vertex data[N_VERTICES];
+	static uint32_t indices[N_INDICES];
+	const float step = 1.8 / GRID_SIZE;
+	for (uint32_t y = 0; y <= GRID_SIZE; y++)
+	{
+		for (uint32_t x = 0; x <= GRID_SIZE; x++)
+		{
+			const uint32_t i = y * (GRID_SIZE + 1) + x;
+			data[i].position = VEC2(
+				-0.9 + step * (x + 0.6 * jitter(2 * i)),
+				-0.9 + step * (y + 0.6 * jitter(2 * i + 1))
+			);
+		}
+	}
+	size_t nIndices = 0;
+	for (uint32_t y = 0; y < GRID_SIZE; y++)
+	{
+		for (uint32_t x = 0; x < GRID_SIZE; x++)
+		{
+			const uint32_t a = y * (GRID_SIZE + 1) + x, b = a + GRID_SIZE + 1;
+			indices[nIndices++] = a;
+			indices[nIndices++] = a + 1;
+			indices[nIndices++] = b + 1;
+			indices[nIndices++] = a;
+			indices[nIndices++] = b + 1;
+			indices[nIndices++] = b;
+		}
+	}
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 0,
+			.varyingsInfo = NULL,
+			.varyingsSize = 0
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPFramebuffer* fb = srpNewFramebuffer(256, 256);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+	srpIndexBufferCopyData(ib, SRP_UINT32, sizeof(indices), indices);
+
+	srpFramebufferClear(fb);
+	srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, N_INDICES);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4(pVertex->position.x, pVertex->position.y, 0, 1);
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	const size_t id = in->primitiveID;
+	vec4* color = (vec4*) out->color;
+	*color = VEC4(
+		(id * 37 % 256) / 255.,
+		(id * 101 % 256) / 255.,
+		(id * 173 % 256) / 255.,
+		1
+	);
+}
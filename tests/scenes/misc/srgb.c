@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	float position[2];
+} Vertex;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+void nanFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Exact sRGB encoding of a linear value, as a byte */
+static int encodeExact(float c);
+/** Exact sRGB decoding of a byte */
+static float decodeExact(int c);
+
+#define WIDTH 256
+#define HEIGHT 64
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	// A full-screen quad with a linear gradient along X
+	Vertex data[] = {
+		{{-1, -1}}, {{1, -1}}, {{-1, 1}}, {{1, 1}}
+	};
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 0,
+			.varyingsInfo = NULL,
+			.varyingsSize = 0
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	SRPFramebuffer* fb = srpNewFramebufferFormat(WIDTH, HEIGHT, SRP_COLOR_FORMAT_SRGBA8);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+
+	srpFramebufferClear(fb);
+	srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLE_STRIP, 0, 4);
+
+	// The table-driven encoding is within one step of the exact one, and
+	// reading the framebuffer back decodes it
+	bool ok = true;
+	for (size_t x = 0; x < WIDTH; x++)
+	{
+		const float linear = (x + 0.5) / WIDTH;
+		const int stored = ((uint32_t*) fb->color)[x] >> 24;
+		ok &= abs(stored - encodeExact(linear)) <= 1;
+
+		float color[4];
+		srpFramebufferReadPixel(fb, x, 0, color);
+		ok &= fabsf(color[0] - decodeExact(stored)) < 1e-6;
+	}
+
+	// Texels of sRGB textures are decoded exactly
+	SRPTexture* texture = srpNewTexture("./res/textures/stoneWall.png", TW_REPEAT, TW_REPEAT);
+	for (float u = 0.05; u < 1; u += 0.1)
+	{
+		float raw[4], decoded[4];
+		srpTextureSet(texture, SRP_TEXTURE_SRGB, 0);
+		srpTextureGetFilteredColor(texture, u, 1 - u, raw);
+		srpTextureSet(texture, SRP_TEXTURE_SRGB, 1);
+		srpTextureGetFilteredColor(texture, u, 1 - u, decoded);
+		for (int c = 0; c < 3; c++)
+			ok &= fabsf(decoded[c] - decodeExact(roundf(raw[c] * 255))) < 1e-6;
+	}
+	ok &= srpTextureGet(texture, SRP_TEXTURE_SRGB) == 1;
+
+	// NaN colors, e.g. from normalizing a zero vector, are stored as 0
+	SRPFramebuffer* nanFb = srpNewFramebufferFormat(4, 4, SRP_COLOR_FORMAT_SRGBA8);
+	shaderProgram.fs->shader = nanFragmentShader;
+	srpFramebufferClear(nanFb);
+	srpDrawVertexBuffer(ctx, vb, nanFb, &shaderProgram, SRP_PRIM_TRIANGLE_STRIP, 0, 4);
+	ok &= ((uint32_t*) nanFb->color)[0] == 0x000000FF;
+	srpFreeFramebuffer(nanFb);
+	if (!ok)
+		fprintf(stderr, "sRGB conversions are off\n");
+
+	int saved = saveFramebufferToImage(fb, outputPath);
+
+	srpFreeTexture(texture);
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
+
+	return (saved && ok) ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* v = (Vertex*) in->vertex;
+	out->clipPosition[0] = v->position[0];
+	out->clipPosition[1] = v->position[1];
+	out->clipPosition[2] = 0;
+	out->clipPosition[3] = 1;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	const float linear = in->fragCoord[0] / WIDTH;
+	out->color[0] = linear;
+	out->color[1] = linear;
+	out->color[2] = linear;
+	out->color[3] = 1;
+}
+
+void nanFragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	(void) in;
+	out->color[0] = NAN;
+	out->color[1] = NAN;
+	out->color[2] = NAN;
+	out->color[3] = 1;
+}
+
+static int encodeExact(float c)
+{
+	const double e = (c <= 0.0031308) ? c * 12.92 : 1.055 * pow(c, 1 / 2.4) - 0.055;
+	return (int) (e * 255 + 0.5);
+}
+
+static float decodeExact(int c)
+{
+	const float f = c / 255.f;
+	return (f <= 0.04045f) ? f / 12.92f : powf((f + 0.055f) / 1.055f, 2.4f);
+}
@@ -26,8 +26,6 @@ typedef struct Uniform
 	SRPTexture* texture;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 void singleColor(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
@@ -104,11 +102,11 @@ int main(int argc, char** argv)
 		}
 	};
 
-	srpNewContext(&srpContext);
-	srpRasterFrontFace(SRP_WINDING_CCW);
-	srpRasterCullFace(SRP_FACE_BACK);
-    srpDepthTest(true);
-    srpStencilTest(true);
+	SRPContext* ctx = srpNewContext();
+	srpRasterFrontFace(ctx, SRP_WINDING_CCW);
+	srpRasterCullFace(ctx, SRP_FACE_BACK);
+    srpDepthTest(ctx, true);
+    srpStencilTest(ctx, true);
 
 	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 	SRPVertexBuffer* vb = srpNewVertexBuffer();
@@ -118,10 +116,10 @@ int main(int argc, char** argv)
 
     srpFramebufferClear(fb);
 
-    srpStencilOp(SRP_STENCIL_KEEP, SRP_STENCIL_KEEP, SRP_STENCIL_REPLACE);
-    srpStencilFunc(SRP_COMPARE_ALWAYS, 1, 0xFF);
-    srpStencilWriteMask(0xFF);
-    srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
+    srpStencilOp(ctx, SRP_STENCIL_KEEP, SRP_STENCIL_KEEP, SRP_STENCIL_REPLACE);
+    srpStencilFunc(ctx, SRP_COMPARE_ALWAYS, 1, 0xFF);
+    srpStencilWriteMask(ctx, 0xFF);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
 
     mat4 scale = mat4ConstructScale(1.05, 1.05, 1.05);
     uniform.model = mat4MultiplyMat4(&scale, &uniform.model);
@@ -129,10 +127,10 @@ int main(int argc, char** argv)
         .shader = singleColor,
         .mayOverwriteDepth = false
     };
-    srpStencilFunc(SRP_COMPARE_NOTEQUAL, 1, 0xFF);
-    srpStencilWriteMask(0x00);
-    srpDepthTest(false);
-    srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
+    srpStencilFunc(ctx, SRP_COMPARE_NOTEQUAL, 1, 0xFF);
+    srpStencilWriteMask(ctx, 0x00);
+    srpDepthTest(ctx, false);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
@@ -140,6 +138,7 @@ int main(int argc, char** argv)
 	srpFreeVertexBuffer(vb);
 	srpFreeIndexBuffer(ib);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
@@ -0,0 +1,213 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+#include "rad.h"
+
+typedef struct Vertex
+{
+    vec3 position;
+    vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+    vec3 color;
+} VSOutput;
+
+typedef struct Uniform
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} Uniform;
+
+/** What the presentation thread records about the frames */
+typedef struct Presented
+{
+	size_t count;                /**< Amount of presented frames */
+	bool inOrder;                /**< Whether the frames came in order */
+	uint64_t hashes[16];         /**< Hash of every frame */
+	SRPFramebuffer* last;        /**< Copy of the last frame */
+} Presented;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+/** Record a frame. A SRPPresentFunc */
+static void present(const SRPFramebuffer* fb, size_t frame, void* userData);
+/** FNV-1a hash of the color buffer */
+static uint64_t hashColor(const SRPFramebuffer* fb);
+/** Draw one frame of the rotating cube */
+static void drawFrame(
+	SRPContext* ctx, SRPFramebuffer* fb, SRPShaderProgram* sp, Uniform* uniform,
+	SRPVertexBuffer* vb, SRPIndexBuffer* ib, size_t frame
+);
+
+#define N_FRAMES 12
+
+int main(int argc, char** argv)
+{
+    assert(argc >= 2);
+    const char* outputPath = argv[1];
+
+    Vertex data[] = {
+        // Cube
+        // Bottom face (y = -1)
+        { .position = VEC3(-1, -1, -1), .color = VEC3(1, 1, 1) }, // 0: Front-Left-Bottom
+        { .position = VEC3( 1, -1, -1), .color = VEC3(1, 1, 1) }, // 1: Front-Right-Bottom
+        { .position = VEC3( 1, -1,  1), .color = VEC3(1, 1, 1) }, // 2: Back-Right-Bottom
+        { .position = VEC3(-1, -1,  1), .color = VEC3(1, 1, 1) }, // 3: Back-Left-Bottom
+
+        // Top face (y = 1)
+        { .position = VEC3(-1,  1, -1), .color = VEC3(1, 1, 1) }, // 4: Front-Left-Top
+        { .position = VEC3( 1,  1, -1), .color = VEC3(1, 1, 1) }, // 5: Front-Right-Top
+        { .position = VEC3( 1,  1,  1), .color = VEC3(1, 1, 1) }, // 6: Back-Right-Top
+        { .position = VEC3(-1,  1,  1), .color = VEC3(1, 1, 1) }, // 7: Back-Left-Top
+
+        // Two triangle sections of a cube (not minding the winding order here)
+        { .position = VEC3(-1, -1, -1), .color = VEC3(1, 0, 0) },
+        { .position = VEC3(-1,  1,  1), .color = VEC3(0, 1, 0) },
+        { .position = VEC3( 1,  1, -1), .color = VEC3(0, 0, 1) },
+
+        { .position = VEC3(-1,  1, -1), .color = VEC3(1, 1, 0) },
+        { .position = VEC3(-1, -1,  1), .color = VEC3(0, 1, 1) },
+        { .position = VEC3( 1, -1, -1), .color = VEC3(1, 0, 1) }
+    };
+    uint8_t indices[] = {
+        0, 1,  1, 2,  2, 3,  3, 0,  // Bottom square
+        4, 5,  5, 6,  6, 7,  7, 4,  // Top square
+        0, 4,  1, 5,  2, 6,  3, 7   // Vertical pillars connecting them
+    };
+
+    Uniform uniform = {
+		.view = mat4ConstructView(0, 0, -2,   0, 0,   0,   1,   1,   1),
+		.projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 1, 10)
+    };
+
+    // The uniform changes every frame while earlier frames are still queued
+    SRPShaderProgram shaderProgram = {
+        .uniform = (SRPUniform*) &uniform,
+        .uniformSize = sizeof(Uniform),
+        .vs = &(SRPVertexShader) {
+            .shader = vertexShader,
+            .nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+            .varyingsSize = sizeof(VSOutput)
+        },
+        .fs = &(SRPFragmentShader) {
+            .shader = fragmentShader,
+            .mayOverwriteDepth = false
+        }
+    };
+
+    SRPVertexBuffer* vb = srpNewVertexBuffer();
+    srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+    SRPIndexBuffer* ib = srpNewIndexBuffer();
+    srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
+
+    // Render on a background thread while the previous frames are presented
+    SRPContext* ctx = srpNewContext();
+    srpAsyncDraw(ctx, true);
+    srpDepthTest(ctx, true);
+    Presented presented = {.inOrder = true, .last = srpNewFramebuffer(512, 512)};
+    SRPSwapchain* swapchain = srpNewSwapchain(512, 512, SRP_COLOR_FORMAT_RGBA8, 3, present, &presented);
+
+    for (size_t frame = 0; frame < N_FRAMES; frame++)
+    {
+        SRPFramebuffer* fb = srpSwapchainAcquire(swapchain);
+        drawFrame(ctx, fb, &shaderProgram, &uniform, vb, ib, frame);
+        srpSwapchainPresent(swapchain, ctx, fb);
+    }
+    srpSwapchainWaitIdle(swapchain);
+    bool ok = presented.count == N_FRAMES && presented.inOrder;
+    srpFreeSwapchain(swapchain);
+
+    // The same frames rendered one by one
+    SRPContext* reference = srpNewContext();
+    srpDepthTest(reference, true);
+    SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+    for (size_t frame = 0; frame < N_FRAMES; frame++)
+    {
+        drawFrame(reference, fb, &shaderProgram, &uniform, vb, ib, frame);
+        ok &= hashColor(fb) == presented.hashes[frame];
+    }
+
+    if (!ok)
+        fprintf(stderr, "Presented frames do not match the rendered ones\n");
+    ok &= saveFramebufferToImage(presented.last, outputPath);
+
+    srpFreeVertexBuffer(vb);
+    srpFreeIndexBuffer(ib);
+    srpFreeFramebuffer(fb);
+    srpFreeFramebuffer(presented.last);
+    srpFreeContext(ctx);
+    srpFreeContext(reference);
+
+    return ok ? 0 : 1;
+}
+
+static void present(const SRPFramebuffer* fb, size_t frame, void* userData)
+{
+	Presented* presented = (Presented*) userData;
+	presented->inOrder &= frame == presented->count;
+	presented->hashes[frame] = hashColor(fb);
+	presented->count++;
+	if (frame == N_FRAMES - 1)
+		memcpy(presented->last->color, fb->color, sizeof(uint32_t) * fb->size);
+}
+
+static uint64_t hashColor(const SRPFramebuffer* fb)
+{
+	uint64_t hash = 0xCBF29CE484222325;
+	const uint8_t* bytes = fb->color;
+	for (size_t i = 0; i < sizeof(uint32_t) * fb->size; i++)
+		hash = (hash ^ bytes[i]) * 0x100000001B3;
+	return hash;
+}
+
+static void drawFrame(
+	SRPContext* ctx, SRPFramebuffer* fb, SRPShaderProgram* sp, Uniform* uniform,
+	SRPVertexBuffer* vb, SRPIndexBuffer* ib, size_t frame
+)
+{
+	uniform->model = mat4ConstructTRS(0, 0, 0,   0, RAD(15) * frame, 0,   0.5, 0.5, 0.5);
+	srpFramebufferClear(fb);
+	srpDrawIndexBuffer(ctx, ib, vb, fb, sp, SRP_PRIM_LINES, 0, 24);
+	srpDrawVertexBuffer(ctx, vb, fb, sp, SRP_PRIM_TRIANGLES, 8, 6);
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec3* inPosition = &pVertex->position;
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4_FROM_VEC3(*inPosition, 1.);
+	*outPosition = mat4MultiplyVec4(&pUniform->model, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->view, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->projection, *outPosition);
+
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+    VSOutput* i = (VSOutput*) in->varyings;
+
+    vec4* color = (vec4*) out->color;
+    color->x = i->color.x;
+    color->y = i->color.y;
+    color->z = i->color.z;
+    color->w = 1.;
+}
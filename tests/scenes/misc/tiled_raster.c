@@ -0,0 +1,165 @@
+#define SRP_INCLUDE_VEC
+#define SRP_INCLUDE_MAT
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	vec3 position;
+	vec2 uv;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec2 uv;
+} VSOutput;
+
+typedef struct Uniform
+{
+	size_t frameCount;
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+	SRPTexture* texture;
+} Uniform;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+int main(int argc, char** argv)
+{
+    assert(argc >= 2);
+    const char* outputPath = argv[1];
+
+	Vertex data[] = {
+		{.position = VEC3(-1, -1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1, -1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1,  1, -1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1,  1, -1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3(-1,  1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1,  1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1,  1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1,  1,  1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3( 1, -1,  1), .uv = VEC2(0, 0)},
+		{.position = VEC3(-1, -1,  1), .uv = VEC2(1, 0)},
+		{.position = VEC3(-1,  1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3( 1,  1,  1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3( 1, -1,  1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1, -1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1,  1, -1), .uv = VEC2(1, 1)},
+		{.position = VEC3( 1,  1,  1), .uv = VEC2(0, 1)},
+
+		{.position = VEC3(-1, -1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3(-1, -1,  1), .uv = VEC2(1, 0)},
+		{.position = VEC3(-1,  1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1,  1, -1), .uv = VEC2(0, 1)},
+		
+		{.position = VEC3(-1, -1, -1), .uv = VEC2(0, 0)},
+		{.position = VEC3( 1, -1, -1), .uv = VEC2(1, 0)},
+		{.position = VEC3( 1, -1,  1), .uv = VEC2(1, 1)},
+		{.position = VEC3(-1, -1,  1), .uv = VEC2(0, 1)}
+	};
+
+	uint8_t indices[] = {
+		 0,  1,  2,   0,  2,  3,
+		 4,  5,  6,   4,  6,  7,
+		 8,  9, 10,   8, 10, 11,
+		12, 15, 14,  12, 14, 13,
+		16, 18, 17,  16, 19, 18,
+		20, 23, 22,  20, 22, 21
+	};
+
+	Uniform uniform = {
+		.model = mat4ConstructRotate(2.5, 0.7, 0.5),
+		.view = mat4ConstructView(0, 0, -3,   0, 0, 0,   1, 1, 1),
+		.projection = mat4ConstructPerspectiveProjection(-1, 1, -1, 1, 1, 50),
+		.texture = srpNewTexture("./res/textures/stoneWall.png", TW_REPEAT, TW_REPEAT),
+		.frameCount = 0
+	};
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = (SRPUniform*) &uniform,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 2,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_PERSPECTIVE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpRasterFrontFace(ctx, SRP_WINDING_CCW);
+	srpRasterCullFace(ctx, SRP_FACE_BACK);
+	srpDepthTest(ctx, true);
+
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPFramebuffer* fbSingle = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+	srpIndexBufferCopyData(ib, SRP_UINT8, sizeof(indices), indices);
+
+	// Reference: the same scene rasterized on a single thread
+	srpFramebufferClear(fbSingle);
+	srpDrawIndexBuffer(ctx, ib, vb, fbSingle, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
+
+	srpThreadCount(ctx, 4);
+	srpFramebufferClear(fb);
+	srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, 36);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+	if (memcmp(fb->color, fbSingle->color, fb->size * sizeof(uint32_t)) != 0 || \
+	    memcmp(fb->depth, fbSingle->depth, fb->size * sizeof(float)) != 0)
+		ok = 0;
+
+	srpFreeTexture(uniform.texture);
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fbSingle);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec3* inPosition = &pVertex->position;
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4_FROM_VEC3(*inPosition, 1.);
+	*outPosition = mat4MultiplyVec4(&pUniform->model, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->view, *outPosition);
+	*outPosition = mat4MultiplyVec4(&pUniform->projection, *outPosition);
+
+	pOutVars->uv = pVertex->uv;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+	Uniform* pUniform = (Uniform*) in->uniform;
+	vec3* outColor = (vec3*) out->color;
+
+	vec2 uv = interpolated->uv;
+	srpTextureGetFilteredColor(pUniform->texture, uv.x, uv.y, (float*) outColor);
+}
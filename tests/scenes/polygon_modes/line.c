@@ -16,8 +16,6 @@ typedef struct Uniform
 	mat4 projection;
 } Uniform;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -58,9 +56,9 @@ int main(int argc, char** argv)
 		}
 	};
 
-	srpNewContext(&srpContext);
-	srpRasterPolygonMode(SRP_POLYGON_MODE_LINE);
-    srpDepthTest(true);
+	SRPContext* ctx = srpNewContext();
+	srpRasterPolygonMode(ctx, SRP_POLYGON_MODE_LINE);
+    srpDepthTest(ctx, true);
 
 	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 	SRPVertexBuffer* vb = srpNewVertexBuffer();
@@ -69,13 +67,14 @@ int main(int argc, char** argv)
 	srpIndexBufferCopyData(ib, SRP_UINT32, mesh.indexCount * sizeof(uint32_t), mesh.indices);
 
     srpFramebufferClear(fb);
-    srpDrawIndexBuffer(ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
+    srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, mesh.indexCount);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
 	srpFreeVertexBuffer(vb);
 	srpFreeIndexBuffer(ib);
 	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
 	freeOBJMesh(&mesh);
 
     return ok ? 0 : 1;
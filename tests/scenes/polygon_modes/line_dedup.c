@@ -0,0 +1,147 @@
+#define SRP_INCLUDE_VEC
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <srp/srp.h>
+#include "save.h"
+
+// An indexed grid drawn as an antialiased wireframe with shared edges
+// deduplicated. Every edge must be blended exactly once, so the result has
+// to match drawing the unique edges as SRP_PRIM_LINES, in the same order
+#define GRID_SIZE 12
+#define N_VERTICES ((GRID_SIZE + 1) * (GRID_SIZE + 1))
+#define N_INDICES (GRID_SIZE * GRID_SIZE * 6)
+
+typedef struct Vertex
+{
+	vec2 position;
+	vec3 color;
+} Vertex;
+
+typedef struct VSOutput
+{
+	vec3 color;
+} VSOutput;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	static Vertex data[N_VERTICES];
+	for (uint32_t y = 0; y <= GRID_SIZE; y++)
+	{
+		for (uint32_t x = 0; x <= GRID_SIZE; x++)
+		{
+			const float u = (float) x / GRID_SIZE, v = (float) y / GRID_SIZE;
+			data[y * (GRID_SIZE + 1) + x] = (Vertex) {
+				.position = VEC2(-0.9 + 1.8 * u + 0.1 * v * v, -0.9 + 1.8 * v - 0.1 * u * u),
+				.color = VEC3(u, v, 1 - u * v)
+			};
+		}
+	}
+
+	static uint32_t indices[N_INDICES];
+	size_t nIndices = 0;
+	for (uint32_t y = 0; y < GRID_SIZE; y++)
+	{
+		for (uint32_t x = 0; x < GRID_SIZE; x++)
+		{
+			const uint32_t a = y * (GRID_SIZE + 1) + x, b = a + GRID_SIZE + 1;
+			const uint32_t quad[] = {a, a + 1, b + 1,  a, b + 1, b};
+			memcpy(&indices[nIndices], quad, sizeof(quad));
+			nIndices += 6;
+		}
+	}
+
+	// The unique edges, in the order the wireframe reaches them first
+	static bool seen[N_VERTICES][N_VERTICES];
+	static uint32_t edges[N_INDICES * 2];
+	size_t nEdges = 0;
+	for (size_t t = 0; t < N_INDICES; t += 3)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			const uint32_t a = indices[t + j], b = indices[t + (j + 1) % 3];
+			if (seen[a][b])
+				continue;
+			seen[a][b] = seen[b][a] = true;
+			edges[nEdges++] = a;
+			edges[nEdges++] = b;
+		}
+	}
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 1,
+			.varyingsInfo = (SRPVaryingInfo[]) {{
+				.nItems = 3,
+				.type = SRP_FLOAT,
+				.interpolationMode = SRP_INTERPOLATION_MODE_AFFINE
+			}},
+			.varyingsSize = sizeof(VSOutput)
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpRasterLineSmooth(ctx, true);
+	srpRasterLineWidth(ctx, 2);
+
+	SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
+	SRPFramebuffer* fbLines = srpNewFramebuffer(512, 512);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	SRPIndexBuffer* ib = srpNewIndexBuffer();
+	SRPIndexBuffer* ibLines = srpNewIndexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
+	srpIndexBufferCopyData(ib, SRP_UINT32, sizeof(indices), indices);
+	srpIndexBufferCopyData(ibLines, SRP_UINT32, nEdges * sizeof(uint32_t), edges);
+
+	srpFramebufferClear(fbLines);
+	srpDrawIndexBuffer(ctx, ibLines, vb, fbLines, &shaderProgram, SRP_PRIM_LINES, 0, nEdges);
+
+	srpRasterPolygonMode(ctx, SRP_POLYGON_MODE_LINE);
+	srpRasterDedupEdges(ctx, true);
+	srpFramebufferClear(fb);
+	srpDrawIndexBuffer(ctx, ib, vb, fb, &shaderProgram, SRP_PRIM_TRIANGLES, 0, N_INDICES);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+	if (memcmp(fb->color, fbLines->color, fb->size * sizeof(uint32_t)) != 0)
+		ok = 0;
+
+	srpFreeVertexBuffer(vb);
+	srpFreeIndexBuffer(ib);
+	srpFreeIndexBuffer(ibLines);
+	srpFreeFramebuffer(fb);
+	srpFreeFramebuffer(fbLines);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	VSOutput* pOutVars = (VSOutput*) out->varyings;
+
+	vec4* outPosition = (vec4*) out->clipPosition;
+	*outPosition = VEC4(pVertex->position.x, pVertex->position.y, 0, 1);
+	pOutVars->color = pVertex->color;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	VSOutput* interpolated = (VSOutput*) in->varyings;
+
+	vec4* color = (vec4*) out->color;
+	*color = VEC4(interpolated->color.x, interpolated->color.y, interpolated->color.z, 1);
+}
@@ -11,8 +11,6 @@ typedef struct Vertex
     vec3 color;
 } Vertex;
 
-SRPContext srpContext;
-
 void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
 void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
 
@@ -42,19 +40,20 @@ int main(int argc, char** argv)
         }
     };
 
-    srpNewContext(&srpContext);
+    SRPContext* ctx = srpNewContext();
     SRPFramebuffer* fb = srpNewFramebuffer(512, 512);
 
     SRPVertexBuffer* vb = srpNewVertexBuffer();
     srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(data), data);
 
     srpFramebufferClear(fb);
-    srpDrawVertexBuffer(vb, fb, &shaderProgram, SRP_PRIM_LINE_STRIP, 0, 4);
+    srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_LINE_STRIP, 0, 4);
 
     int ok = saveFramebufferToImage(fb, outputPath);
 
     srpFreeVertexBuffer(vb);
     srpFreeFramebuffer(fb);
+    srpFreeContext(ctx);
 
     return ok ? 0 : 1;
 }
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <assert.h>
+#include <srp/srp.h>
+#include "save.h"
+
+typedef struct Vertex
+{
+	float position[2];
+	float size;
+} Vertex;
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out);
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out);
+
+#define GRID 6
+
+int main(int argc, char** argv)
+{
+	assert(argc >= 2);
+	const char* outputPath = argv[1];
+
+	// A grid of points growing in size, the last row uses the context's
+	// point size (size left zero in the vertex shader)
+	Vertex vertices[GRID * GRID];
+	for (size_t i = 0; i < GRID * GRID; i++)
+	{
+		const size_t x = i % GRID, y = i / GRID;
+		vertices[i] = (Vertex) {
+			.position = {-1 + (2 * x + 1) / (float) GRID, 1 - (2 * y + 1) / (float) GRID},
+			.size = (y == GRID - 1) ? 0 : 1 + i * 1.25
+		};
+	}
+
+	SRPShaderProgram shaderProgram = {
+		.uniform = NULL,
+		.vs = &(SRPVertexShader) {
+			.shader = vertexShader,
+			.nVaryings = 0,
+			.varyingsInfo = NULL,
+			.varyingsSize = 0
+		},
+		.fs = &(SRPFragmentShader) {
+			.shader = fragmentShader,
+			.mayOverwriteDepth = false
+		}
+	};
+
+	SRPContext* ctx = srpNewContext();
+	srpRasterPointSize(ctx, 12.5);
+
+	SRPFramebuffer* fb = srpNewFramebuffer(256, 256);
+	SRPVertexBuffer* vb = srpNewVertexBuffer();
+	srpVertexBufferCopyData(vb, sizeof(Vertex), sizeof(vertices), vertices);
+
+	srpFramebufferClear(fb);
+	srpDrawVertexBuffer(ctx, vb, fb, &shaderProgram, SRP_PRIM_POINTS, 0, GRID * GRID);
+
+	int ok = saveFramebufferToImage(fb, outputPath);
+
+	srpFreeVertexBuffer(vb);
+	srpFreeFramebuffer(fb);
+	srpFreeContext(ctx);
+
+	return ok ? 0 : 1;
+}
+
+void vertexShader(SRPVertexShaderIn* in, SRPVertexShaderOut* out)
+{
+	Vertex* pVertex = (Vertex*) in->vertex;
+	out->clipPosition[0] = pVertex->position[0];
+	out->clipPosition[1] = pVertex->position[1];
+	out->clipPosition[2] = 0;
+	out->clipPosition[3] = 1;
+	out->pointSize = pVertex->size;
+}
+
+void fragmentShader(SRPFragmentShaderIn* in, SRPFragmentShaderOut* out)
+{
+	assert(in->pointCoord[0] >= 0 && in->pointCoord[0] <= 1);
+	assert(in->pointCoord[1] >= 0 && in->pointCoord[1] <= 1);
+
+	// Round sprite, shaded with its UVs
+	const float dx = in->pointCoord[0] - 0.5, dy = in->pointCoord[1] - 0.5;
+	const bool inside = dx * dx + dy * dy <= 0.25;
+	out->color[0] = inside ? in->pointCoord[0] : 0.1;
+	out->color[1] = inside ? in->pointCoord[1] : 0.1;
+	out->color[2] = inside ? 1 : 0.1;
+	out->color[3] = 1;
+}
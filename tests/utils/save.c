@@ -14,16 +14,23 @@ int saveFramebufferToImage(const SRPFramebuffer* fb, const char* outputPath)
     {
         for (int x = 0; x < width; x++)
         {
-            uint32_t c = fb->color[y * width + x];
-
-            unsigned char r = (c >> 24) & 0xFF;
-            unsigned char g = (c >> 16) & 0xFF;
-            unsigned char b = (c >> 8)  & 0xFF;
-
             int i = (y * width + x) * 4;
-            pixels[i + 0] = r;
-            pixels[i + 1] = g;
-            pixels[i + 2] = b;
+            // sRGB-encoded bytes are stored as is, as PNG expects them
+            if (fb->colorFormat == SRP_COLOR_FORMAT_RGBA8 || fb->colorFormat == SRP_COLOR_FORMAT_SRGBA8)
+            {
+                uint32_t c = ((uint32_t*) fb->color)[y * width + x];
+                pixels[i + 0] = (c >> 24) & 0xFF;
+                pixels[i + 1] = (c >> 16) & 0xFF;
+                pixels[i + 2] = (c >> 8)  & 0xFF;
+            }
+            else
+            {
+                // Any other format, clamped and rounded to 8 bits
+                float c[4];
+                srpFramebufferReadPixel(fb, x, y, c);
+                for (int j = 0; j < 3; j++)
+                    pixels[i + j] = (c[j] <= 0) ? 0 : (c[j] >= 1) ? 0xFF : c[j] * 255 + 0.5;
+            }
             pixels[i + 3] = 0xFF;
         }
     }